@@ -0,0 +1,273 @@
+//===-- flang/benchmarks/Runtime/IOBenchmark.cpp ----------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Statements per second for common shapes of data transfer statements on
+// internal and external units. Each iteration is one complete statement,
+// from its Begin...() call through EndIoStatement().
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "flang/Runtime/io-api.h"
+#include <cstdint>
+#include <cstring>
+
+using namespace Fortran::runtime::io;
+
+namespace {
+
+// OPEN(NEWUNIT=unit,ACCESS=access,ACTION='READWRITE',FORM=form,&
+//   RECL=recl,STATUS='SCRATCH')
+int OpenScratchUnit(const char *access, const char *form, std::size_t recl) {
+  Cookie io{IONAME(BeginOpenNewUnit)(__FILE__, __LINE__)};
+  IONAME(SetAccess)(io, access, std::strlen(access));
+  IONAME(SetAction)(io, "READWRITE", 9);
+  IONAME(SetForm)(io, form, std::strlen(form));
+  if (recl > 0) {
+    IONAME(SetRecl)(io, recl);
+  }
+  IONAME(SetStatus)(io, "SCRATCH", 7);
+  int unit{-1};
+  IONAME(GetNewUnit)(io, unit);
+  IONAME(EndIoStatement)(io);
+  return unit;
+}
+
+// CLOSE(UNIT=unit)
+void CloseUnit(int unit) {
+  IONAME(EndIoStatement)(IONAME(BeginClose)(unit, __FILE__, __LINE__));
+}
+
+// REWIND(UNIT=unit), so that a sequential scratch file stays small
+void Rewind(int unit) {
+  IONAME(EndIoStatement)(IONAME(BeginRewind)(unit, __FILE__, __LINE__));
+}
+
+void Finish(benchmark::State &state, Cookie io) {
+  if (IONAME(EndIoStatement)(io) != IostatOk) {
+    state.SkipWithError("I/O statement failed");
+  }
+}
+
+constexpr int rewindInterval{4096};
+
+} // namespace
+
+// WRITE(buffer,'(I10)') n
+static void BM_InternalFormattedOutputInteger(benchmark::State &state) {
+  char buffer[10];
+  static constexpr const char format[]{"(I10)"};
+  std::int64_t n{0};
+  for (auto _ : state) {
+    auto io{IONAME(BeginInternalFormattedOutput)(
+        buffer, sizeof buffer, format, sizeof format - 1)};
+    IONAME(OutputInteger64)(io, ++n);
+    Finish(state, io);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InternalFormattedOutputInteger);
+
+// WRITE(buffer,'(F16.6)') x
+static void BM_InternalFormattedOutputReal(benchmark::State &state) {
+  char buffer[16];
+  static constexpr const char format[]{"(F16.6)"};
+  double x{0.0};
+  for (auto _ : state) {
+    auto io{IONAME(BeginInternalFormattedOutput)(
+        buffer, sizeof buffer, format, sizeof format - 1)};
+    IONAME(OutputReal64)(io, x += 0.125);
+    Finish(state, io);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InternalFormattedOutputReal);
+
+// WRITE(buffer,*) n, x
+static void BM_InternalListOutput(benchmark::State &state) {
+  char buffer[48];
+  std::int64_t n{0};
+  double x{0.0};
+  for (auto _ : state) {
+    auto io{IONAME(BeginInternalListOutput)(buffer, sizeof buffer)};
+    IONAME(OutputInteger64)(io, ++n);
+    IONAME(OutputReal64)(io, x += 0.125);
+    Finish(state, io);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InternalListOutput);
+
+// READ(buffer,'(I10,F16.6)') n, x
+static void BM_InternalFormattedInput(benchmark::State &state) {
+  static constexpr const char buffer[]{"   1234567     3.141593"};
+  static constexpr const char format[]{"(I10,F16.6)"};
+  std::int64_t n;
+  double x;
+  for (auto _ : state) {
+    auto io{IONAME(BeginInternalFormattedInput)(
+        buffer, sizeof buffer - 1, format, sizeof format - 1)};
+    IONAME(InputInteger)(io, n);
+    IONAME(InputReal64)(io, x);
+    Finish(state, io);
+    benchmark::DoNotOptimize(n);
+    benchmark::DoNotOptimize(x);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InternalFormattedInput);
+
+// READ(buffer,*) n, x
+static void BM_InternalListInput(benchmark::State &state) {
+  static constexpr const char buffer[]{"1234567, 3.141593"};
+  std::int64_t n;
+  double x;
+  for (auto _ : state) {
+    auto io{IONAME(BeginInternalListInput)(buffer, sizeof buffer - 1)};
+    IONAME(InputInteger)(io, n);
+    IONAME(InputReal64)(io, x);
+    Finish(state, io);
+    benchmark::DoNotOptimize(n);
+    benchmark::DoNotOptimize(x);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InternalListInput);
+
+// WRITE(unit,'(5I8)') a(1:5)
+static void BM_ExternalFormattedOutput(benchmark::State &state) {
+  int unit{OpenScratchUnit("SEQUENTIAL", "FORMATTED", 0)};
+  static constexpr const char format[]{"(5I8)"};
+  std::int64_t n{0};
+  int statements{0};
+  for (auto _ : state) {
+    auto io{IONAME(BeginExternalFormattedOutput)(
+        format, sizeof format - 1, unit, __FILE__, __LINE__)};
+    for (int j{0}; j < 5; ++j) {
+      IONAME(OutputInteger64)(io, ++n);
+    }
+    Finish(state, io);
+    if (++statements % rewindInterval == 0) {
+      Rewind(unit);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  CloseUnit(unit);
+}
+BENCHMARK(BM_ExternalFormattedOutput);
+
+// WRITE(unit,*) n, x
+static void BM_ExternalListOutput(benchmark::State &state) {
+  int unit{OpenScratchUnit("SEQUENTIAL", "FORMATTED", 0)};
+  std::int64_t n{0};
+  double x{0.0};
+  int statements{0};
+  for (auto _ : state) {
+    auto io{IONAME(BeginExternalListOutput)(unit, __FILE__, __LINE__)};
+    IONAME(OutputInteger64)(io, ++n);
+    IONAME(OutputReal64)(io, x += 0.125);
+    Finish(state, io);
+    if (++statements % rewindInterval == 0) {
+      Rewind(unit);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  CloseUnit(unit);
+}
+BENCHMARK(BM_ExternalListOutput);
+
+// READ(unit,'(5I8)') a(1:5) and READ(unit,*) a(1:5), cycling through a
+// file of rewindInterval records
+static void ExternalInput(benchmark::State &state, bool listDirected) {
+  int unit{OpenScratchUnit("SEQUENTIAL", "FORMATTED", 0)};
+  static constexpr const char format[]{"(5I8)"};
+  for (int j{0}; j < rewindInterval; ++j) {
+    auto io{IONAME(BeginExternalFormattedOutput)(
+        format, sizeof format - 1, unit, __FILE__, __LINE__)};
+    for (int k{0}; k < 5; ++k) {
+      IONAME(OutputInteger64)(io, 5 * j + k);
+    }
+    IONAME(EndIoStatement)(io);
+  }
+  Rewind(unit);
+  std::int64_t a[5];
+  int statements{0};
+  for (auto _ : state) {
+    auto io{listDirected
+            ? IONAME(BeginExternalListInput)(unit, __FILE__, __LINE__)
+            : IONAME(BeginExternalFormattedInput)(
+                  format, sizeof format - 1, unit, __FILE__, __LINE__)};
+    for (auto &x : a) {
+      IONAME(InputInteger)(io, x);
+    }
+    Finish(state, io);
+    benchmark::DoNotOptimize(a);
+    if (++statements % rewindInterval == 0) {
+      Rewind(unit);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  CloseUnit(unit);
+}
+
+static void BM_ExternalFormattedInput(benchmark::State &state) {
+  ExternalInput(state, /*listDirected=*/false);
+}
+BENCHMARK(BM_ExternalFormattedInput);
+
+static void BM_ExternalListInput(benchmark::State &state) {
+  ExternalInput(state, /*listDirected=*/true);
+}
+BENCHMARK(BM_ExternalListInput);
+
+// WRITE(unit,REC=1) a(1:n) and READ(unit,REC=1) a(1:n) on a direct access
+// unformatted unit, one element at a time
+static void BM_ExternalUnformattedOutput(benchmark::State &state) {
+  std::int64_t elements{state.range(0)};
+  int unit{OpenScratchUnit("DIRECT", "UNFORMATTED", elements * 8)};
+  for (auto _ : state) {
+    auto io{IONAME(BeginUnformattedOutput)(unit, __FILE__, __LINE__)};
+    IONAME(SetRec)(io, 1);
+    for (std::int64_t j{0}; j < elements; ++j) {
+      IONAME(OutputUnformattedBlock)(
+          io, reinterpret_cast<const char *>(&j), 1, sizeof j);
+    }
+    Finish(state, io);
+  }
+  state.SetItemsProcessed(state.iterations());
+  CloseUnit(unit);
+}
+BENCHMARK(BM_ExternalUnformattedOutput)->Arg(1)->Arg(64);
+
+static void BM_ExternalUnformattedInput(benchmark::State &state) {
+  std::int64_t elements{state.range(0)};
+  int unit{OpenScratchUnit("DIRECT", "UNFORMATTED", elements * 8)};
+  auto io{IONAME(BeginUnformattedOutput)(unit, __FILE__, __LINE__)};
+  IONAME(SetRec)(io, 1);
+  for (std::int64_t j{0}; j < elements; ++j) {
+    IONAME(OutputUnformattedBlock)(
+        io, reinterpret_cast<const char *>(&j), 1, sizeof j);
+  }
+  IONAME(EndIoStatement)(io);
+  std::int64_t x;
+  for (auto _ : state) {
+    io = IONAME(BeginUnformattedInput)(unit, __FILE__, __LINE__);
+    IONAME(SetRec)(io, 1);
+    for (std::int64_t j{0}; j < elements; ++j) {
+      IONAME(InputUnformattedBlock)(
+          io, reinterpret_cast<char *>(&x), 1, sizeof x);
+    }
+    Finish(state, io);
+    benchmark::DoNotOptimize(x);
+  }
+  state.SetItemsProcessed(state.iterations());
+  CloseUnit(unit);
+}
+BENCHMARK(BM_ExternalUnformattedInput)->Arg(1)->Arg(64);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,90 @@
+//===-- include/flang/Common/phase-timers.h ---------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Compilation phase timers for -ftime-report.
+//
+// A PhaseTimers instance owns one llvm::TimerGroup for each PhaseGroup
+// and a timer for each distinct phase that has been timed.  A phase is
+// timed by constructing a PhaseTimer in the scope that implements it;
+// a null PhaseTimers pointer disables timing at no cost beyond a test.
+//
+//   common::PhaseTimer timer{timers, common::PhaseGroup::Semantics,
+//       "resolve-names", "Name resolution"};
+//
+// The groups form the hierarchy of the report: the phases of a group
+// nest within a phase of the group above it.  Besides times, each phase
+// accumulates the net growth in heap usage across its executions, and
+// the report ends with the peak resident set size of the process.
+
+#ifndef FORTRAN_COMMON_PHASE_TIMERS_H_
+#define FORTRAN_COMMON_PHASE_TIMERS_H_
+
+#include "idioms.h"
+#include "llvm/Support/Timer.h"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <optional>
+#include <string>
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace Fortran::common {
+
+ENUM_CLASS(PhaseGroup, Frontend, Semantics, ModuleFiles)
+
+class PhaseTimers {
+public:
+  PhaseTimers();
+  PhaseTimers(const PhaseTimers &) = delete;
+  ~PhaseTimers();
+
+  struct Phase {
+    Phase(llvm::StringRef name, llvm::StringRef description,
+        llvm::TimerGroup &group)
+        : timer{name, description, group} {}
+    llvm::Timer timer;
+    std::int64_t heapGrowth{0}; // bytes
+  };
+
+  // Returns the phase, creating it on first use.
+  Phase &Get(PhaseGroup, llvm::StringRef name, llvm::StringRef description);
+
+  // Text report in the usual -ftime-report format; resets the timers.
+  void Print(llvm::raw_ostream &);
+  // A single JSON object with the LLVM timer keys ("time.<group>.<phase>.wall"
+  // &c.) followed by "heap.<group>.<phase>" and "peak-rss" in bytes.
+  void PrintJSON(llvm::raw_ostream &);
+
+  // In bytes, if the host can report it
+  static std::optional<std::int64_t> PeakResidentSetSize();
+
+private:
+  std::list<llvm::TimerGroup> groups_; // indexed by PhaseGroup
+  std::map<std::string, Phase> phases_; // must follow groups_
+};
+
+// Times a phase for the lifetime of the object.  Recursive entries into a
+// phase that is already running (e.g., nested module file reads) are
+// accounted to the outermost one.
+class PhaseTimer {
+public:
+  PhaseTimer(PhaseTimers *, PhaseGroup, llvm::StringRef name,
+      llvm::StringRef description);
+  PhaseTimer(const PhaseTimer &) = delete;
+  ~PhaseTimer();
+
+private:
+  PhaseTimers::Phase *phase_{nullptr};
+  std::int64_t heapAtStart_{0};
+};
+
+} // namespace Fortran::common
+#endif // FORTRAN_COMMON_PHASE_TIMERS_H_
@@ -12,6 +12,7 @@
 #include "formatting.h"
 #include "type.h"
 #include "flang/Common/default-kinds.h"
+#include "flang/Common/reference-counted.h"
 #include "flang/Common/reference.h"
 #include <map>
 #include <vector>
@@ -85,6 +86,43 @@ private:
   ConstantSubscripts lbounds_;
 };
 
+// The element values of an array constant, in Fortran array element order.
+// Copies of a Constant<> share one reference-counted buffer of values, so
+// that passing constants around during folding doesn't duplicate large
+// arrays; a Constant<> gets its own copy of the buffer only when it is
+// about to modify it.  Like CountedReference<>, not thread-safe.
+template <typename A> class SharedConstantValues {
+public:
+  SharedConstantValues() {}
+  explicit SharedConstantValues(const A &x) : buffer_{new Buffer{x}} {}
+  explicit SharedConstantValues(A &&x) : buffer_{new Buffer{std::move(x)}} {}
+
+  const A &get() const { return buffer_ ? buffer_->values : Empty(); }
+  A &GetMutable() {
+    if (!buffer_) {
+      buffer_ = new Buffer{A{}};
+    } else if (buffer_->references() > 1) {
+      buffer_ = new Buffer{buffer_->values};
+    }
+    return buffer_->values;
+  }
+  bool operator==(const SharedConstantValues &that) const {
+    return buffer_.get() == that.buffer_.get() || get() == that.get();
+  }
+
+private:
+  struct Buffer : public common::ReferenceCounted<Buffer> {
+    explicit Buffer(const A &x) : values{x} {}
+    explicit Buffer(A &&x) : values{std::move(x)} {}
+    A values;
+  };
+  static const A &Empty() {
+    static const A empty;
+    return empty;
+  }
+  common::CountedReference<Buffer> buffer_;
+};
+
 // Constant<> is specialized for Character kinds and SomeDerived.
 // The non-Character intrinsic types, and SomeDerived, share enough
 // common behavior that they use this common base class.
@@ -97,9 +135,10 @@ public:
   using Element = ELEMENT;
 
   template <typename A>
-  ConstantBase(const A &x, Result res = Result{}) : result_{res}, values_{x} {}
+  ConstantBase(const A &x, Result res = Result{})
+      : result_{res}, values_{std::vector<Element>{x}} {}
   ConstantBase(ELEMENT &&x, Result res = Result{})
-      : result_{res}, values_{std::move(x)} {}
+      : result_{res}, values_{std::vector<Element>{std::move(x)}} {}
   ConstantBase(
       std::vector<Element> &&, ConstantSubscripts &&, Result = Result{});
 
@@ -107,9 +146,9 @@ public:
   ~ConstantBase();
 
   bool operator==(const ConstantBase &) const;
-  bool empty() const { return values_.empty(); }
-  std::size_t size() const { return values_.size(); }
-  const std::vector<Element> &values() const { return values_; }
+  bool empty() const { return values().empty(); }
+  std::size_t size() const { return values().size(); }
+  const std::vector<Element> &values() const { return values_.get(); }
   constexpr Result result() const { return result_; }
 
   constexpr DynamicType GetType() const { return result_.GetType(); }
@@ -121,7 +160,7 @@ protected:
       ConstantSubscripts &resultSubscripts, const std::vector<int> *dimOrder);
 
   Result result_;
-  std::vector<Element> values_;
+  SharedConstantValues<std::vector<Element>> values_;
 };
 
 template <typename T> class Constant : public ConstantBase<T> {
@@ -135,7 +174,7 @@ public:
 
   std::optional<Scalar<T>> GetScalarValue() const {
     if (ConstantBounds::Rank() == 0) {
-      return Base::values_.at(0);
+      return Base::values().at(0);
     } else {
       return std::nullopt;
     }
@@ -161,6 +200,9 @@ public:
   explicit Constant(Scalar<Result> &&);
   Constant(
       ConstantSubscript length, std::vector<Element> &&, ConstantSubscripts &&);
+  // From the elements' characters already concatenated in array element
+  // order, each padded or truncated to the length.
+  Constant(ConstantSubscript length, Scalar<Result> &&, ConstantSubscripts &&);
   ~Constant();
 
   bool operator==(const Constant &that) const {
@@ -169,12 +211,12 @@ public:
   bool empty() const;
   std::size_t size() const;
 
-  const Scalar<Result> &values() const { return values_; }
+  const Scalar<Result> &values() const { return values_.get(); }
   ConstantSubscript LEN() const { return length_; }
 
   std::optional<Scalar<Result>> GetScalarValue() const {
     if (Rank() == 0) {
-      return values_;
+      return values();
     } else {
       return std::nullopt;
     }
@@ -192,7 +234,7 @@ public:
       ConstantSubscripts &resultSubscripts, const std::vector<int> *dimOrder);
 
 private:
-  Scalar<Result> values_; // one contiguous string
+  SharedConstantValues<Scalar<Result>> values_; // one contiguous string
   ConstantSubscript length_;
 };
 
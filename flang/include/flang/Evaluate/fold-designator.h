@@ -65,6 +65,9 @@ public:
   bool isEmpty() const { return isEmpty_; }
   bool isOutOfRange() const { return isOutOfRange_; }
 
+  // Steps over elements that the caller has processed in bulk.
+  void Skip(ConstantSubscript elements) { elementNumber_ += elements; }
+
   template <typename T>
   std::optional<OffsetSymbol> FoldDesignator(const Expr<T> &expr) {
     return std::visit(
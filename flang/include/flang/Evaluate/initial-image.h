@@ -66,6 +66,11 @@ public:
       auto elementBytes{bytes > 0 ? bytes / elements : 0};
       if (elements * elementBytes != bytes) {
         return SizeMismatch;
+      } else if (bytes > 0 &&
+          static_cast<std::size_t>(x.LEN()) * KIND == elementBytes) {
+        // The concatenated elements are already the image
+        std::memcpy(&data_[offset], x.values().data(), bytes);
+        return Ok;
       } else {
         for (auto at{x.lbounds()}; elements-- > 0; x.IncrementSubscripts(at)) {
           auto scalar{x.At(at)}; // this is a std string; size() in chars
@@ -97,6 +102,12 @@ public:
   void Incorporate(ConstantSubscript toOffset, const InitialImage &from,
       ConstantSubscript fromOffset, ConstantSubscript bytes);
 
+  // Copies the "bytes" already at "offset", and the pointers initialized
+  // within them, into the "copies" consecutive slots that immediately
+  // follow them.
+  Result Replicate(
+      ConstantSubscript offset, std::size_t bytes, ConstantSubscript copies);
+
   // Conversions to constant initializers
   std::optional<Expr<SomeType>> AsConstant(FoldingContext &,
       const DynamicType &, const ConstantSubscripts &,
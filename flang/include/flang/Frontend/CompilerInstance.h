@@ -8,6 +8,7 @@
 #ifndef LLVM_FLANG_FRONTEND_COMPILERINSTANCE_H
 #define LLVM_FLANG_FRONTEND_COMPILERINSTANCE_H
 
+#include "flang/Common/phase-timers.h"
 #include "flang/Frontend/CompilerInvocation.h"
 #include "flang/Frontend/FrontendAction.h"
 #include "flang/Frontend/PreprocessorOptions.h"
@@ -53,6 +54,9 @@ class CompilerInstance {
   /// The stream for diagnostics from Semantics if owned, otherwise nullptr.
   std::unique_ptr<llvm::raw_ostream> ownedSemaOutputStream_;
 
+  /// The phase timers for -ftime-report, if requested.
+  std::unique_ptr<Fortran::common::PhaseTimers> phaseTimers_;
+
   /// The diagnostics engine instance.
   llvm::IntrusiveRefCntPtr<clang::DiagnosticsEngine> diagnostics_;
 
@@ -129,6 +133,15 @@ public:
     semantics_ = std::move(semantics);
   }
 
+  /// }
+  /// @name Phase timing
+  /// {
+
+  /// Null unless -ftime-report or -ftime-report-json= was given.
+  Fortran::common::PhaseTimers *phaseTimers() const {
+    return phaseTimers_.get();
+  }
+
   /// }
   /// @name High-Level Operations
   /// {
@@ -203,6 +216,9 @@ public:
       llvm::StringRef extension = "");
 
 private:
+  /// Print the -ftime-report text and/or JSON reports
+  void ReportPhaseTimes();
+
   /// Create a new output file
   ///
   /// \param outputPath   The path to the output file.
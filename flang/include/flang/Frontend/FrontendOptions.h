@@ -201,7 +201,8 @@ public:
 struct FrontendOptions {
   FrontendOptions()
       : showHelp(false), showVersion(false), instrumentedParse(false),
-        needProvenanceRangeToCharBlockMappings(false) {}
+        needProvenanceRangeToCharBlockMappings(false), parallelParse(false),
+        timeReport(false) {}
 
   /// Show the -help text.
   unsigned showHelp : 1;
@@ -217,6 +218,15 @@ struct FrontendOptions {
   /// compilation.
   unsigned needProvenanceRangeToCharBlockMappings : 1;
 
+  /// Parse independent program units concurrently
+  unsigned parallelParse : 1;
+
+  /// Report the time and memory used by each compilation phase
+  unsigned timeReport : 1;
+
+  /// The file for the -ftime-report measurements in JSON, if any
+  std::string timeReportJSONFile;
+
   /// Input values from `-fget-definition`
   struct GetDefinitionVals {
     unsigned line;
@@ -57,6 +57,15 @@ public:
   /// Get the mlir instance of a symbol.
   virtual mlir::Value getSymbolAddress(SymbolRef sym) = 0;
 
+  /// Bind a scalar symbol to the address \p addr until the end of the
+  /// innermost symbol scope.
+  virtual void bindSymbol(SymbolRef sym, mlir::Value addr) = 0;
+  /// Open a symbol scope, in which symbols can be bound to new addresses,
+  /// such as the private copies of the variables of an OpenMP construct.
+  virtual void pushSymbolScope() = 0;
+  /// Close the innermost symbol scope and restore the bindings it replaced.
+  virtual void popSymbolScope() = 0;
+
   //===--------------------------------------------------------------------===//
   // Expressions
   //===--------------------------------------------------------------------===//
@@ -59,6 +59,12 @@ public:
   /// Create lhs // rhs in temp obtained with fir.alloca
   mlir::Value createConcatenate(mlir::Value lhs, mlir::Value rhs);
 
+  /// Create \p pieces(0) // \p pieces(1) // ... in a single temp obtained
+  /// with fir.alloca. The operands of a chain of // operators should be
+  /// gathered and lowered with this rather than one operator at a time, so
+  /// that no intermediate result is built.
+  mlir::Value createConcatenate(llvm::ArrayRef<mlir::Value> pieces);
+
   /// LEN_TRIM intrinsic.
   mlir::Value createLenTrim(mlir::Value str);
 
@@ -137,6 +143,8 @@ private:
   void createAssign(const fir::CharBoxValue &lhs, const fir::CharBoxValue &rhs);
   fir::CharBoxValue createConcatenate(const fir::CharBoxValue &lhs,
                                       const fir::CharBoxValue &rhs);
+  fir::CharBoxValue
+  createConcatenate(llvm::ArrayRef<fir::CharBoxValue> pieces);
   fir::CharBoxValue createSubstring(const fir::CharBoxValue &str,
                                     llvm::ArrayRef<mlir::Value> bounds);
   mlir::Value createLenTrim(const fir::CharBoxValue &str);
@@ -144,6 +152,10 @@ private:
   mlir::Value createBlankConstantCode(fir::CharacterType type);
 
 private:
+  /// Concatenations whose length is known at compile time and does not
+  /// exceed this many characters get a temp of constant size.
+  static constexpr fir::SequenceType::Extent maxConstantLengthTemp = 4096;
+
   FirOpBuilder &builder;
   mlir::Location loc;
 };
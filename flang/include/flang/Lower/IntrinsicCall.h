@@ -31,6 +31,9 @@ namespace Fortran::lower {
 /// Generate the FIR+MLIR operations for the generic intrinsic \p name
 /// with arguments \p args and expected result type \p resultType.
 /// Returned mlir::Value is the returned Fortran intrinsic value.
+/// The intrinsics over arrays (SUM, MATMUL, ...) are expanded inline when
+/// their arguments allow it. Otherwise nothing is generated and a null value
+/// is returned: the caller must then call the runtime library.
 fir::ExtendedValue genIntrinsicCall(FirOpBuilder &, mlir::Location,
                                     llvm::StringRef name, mlir::Type resultType,
                                     llvm::ArrayRef<fir::ExtendedValue> args);
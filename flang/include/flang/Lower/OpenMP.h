@@ -13,9 +13,17 @@
 #ifndef FORTRAN_LOWER_OPENMP_H
 #define FORTRAN_LOWER_OPENMP_H
 
+#include <cstdint>
+
+namespace mlir {
+class Attribute;
+} // namespace mlir
+
 namespace Fortran {
 namespace parser {
 struct OpenMPConstruct;
+struct OpenMPDeclarativeConstruct;
+struct OmpClauseList;
 } // namespace parser
 
 namespace lower {
@@ -29,6 +37,28 @@ struct Evaluation;
 void genOpenMPConstruct(AbstractConverter &, pft::Evaluation &,
                         const parser::OpenMPConstruct &);
 
+void genOpenMPDeclarativeConstruct(AbstractConverter &,
+                                   const parser::OpenMPDeclarativeConstruct &);
+
+/// Number of DO loops associated with a loop construct with clauses
+/// `clauseList`. A worksharing loop construct lowers the control of these
+/// loops, so only the body of the innermost one remains to be lowered.
+std::int64_t getCollapseValue(const parser::OmpClauseList &clauseList);
+
+/// The `llvm.loop` attribute of the DO loop `doEval` when it is the innermost
+/// loop associated with a SIMD construct, or a null attribute otherwise. The
+/// attribute holds the vectorization options of the loop and a new access
+/// group for the memory accesses of its body.
+mlir::Attribute genOpenMPLoopAnnotation(AbstractConverter &,
+                                        pft::Evaluation &doEval);
+
+/// Finish the lowering of a worksharing loop, once the body of its innermost
+/// associated DO loop has been lowered: turn the references to the reduction
+/// variables into contributions to the reductions, and restore the symbol
+/// bindings that the loop replaced with private copies. Does nothing when
+/// the insertion point is not in the body of a worksharing loop.
+void genOpenMPLoopEnd(AbstractConverter &);
+
 } // namespace lower
 } // namespace Fortran
 
@@ -220,6 +220,10 @@ public:
     return std::get_if<UnboxedValue>(&box);
   }
 
+  constexpr const ArrayBoxValue *getArrayBox() const {
+    return std::get_if<ArrayBoxValue>(&box);
+  }
+
   /// LLVM style debugging of extended values
   LLVM_DUMP_METHOD void dump() const { llvm::errs() << *this << '\n'; }
 
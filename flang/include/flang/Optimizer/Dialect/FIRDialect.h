@@ -15,6 +15,12 @@
 
 #include "mlir/IR/Dialect.h"
 
+namespace mlir {
+class BlockAndValueMapping;
+class Operation;
+class Region;
+} // namespace mlir
+
 namespace fir {
 
 /// FIR dialect
@@ -50,6 +56,11 @@ public:
   static llvm::StringRef getDialectNamespace() { return "fircg"; }
 };
 
+/// Support for inlining on FIR.
+/// Is it legal to inline the operation `op` into the region `reg`?
+bool canLegallyInline(mlir::Operation *op, mlir::Region *reg,
+                      mlir::BlockAndValueMapping &map);
+
 } // namespace fir
 
 #endif // FORTRAN_OPTIMIZER_DIALECT_FIRDIALECT_H
@@ -74,6 +74,19 @@ constexpr llvm::StringRef getOptionalAttrName() { return "fir.optional"; }
 ///     previous cases.
 bool valueHasFirAttribute(mlir::Value value, llvm::StringRef attributeName);
 
+/// Return the fir.alloca, fir.allocmem or fir.address_of that allocates the
+/// storage \p memref is derived from, looking through conversions, boxing
+/// and element addressing. Return null when the storage is not known, as for
+/// dummy arguments and for addresses loaded from memory, such as those of
+/// POINTERs, ALLOCATABLEs and Cray pointees.
+mlir::Operation *getAllocationRoot(mlir::Value memref);
+
+/// Tell if \p a and \p b are derived from distinct known allocations, in
+/// which case they cannot address the same storage. The same allocation may
+/// be addressed in different ways, as by EQUIVALENCE, so this is false when
+/// the allocations are the same.
+bool isDistinctAllocation(mlir::Value a, mlir::Value b);
+
 } // namespace fir
 
 #endif // FORTRAN_OPTIMIZER_DIALECT_FIROPSSUPPORT_H
@@ -15,12 +15,23 @@
 
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
 #include "mlir/IR/BuiltinAttributes.h"
+#include "llvm/ADT/Optional.h"
 
 namespace fir {
 /// Return the integer value of a arith::ConstantOp.
 inline std::int64_t toInt(mlir::arith::ConstantOp cop) {
   return cop.value().cast<mlir::IntegerAttr>().getValue().getSExtValue();
 }
+
+/// Return the value of \p value if it is defined by an integer
+/// arith::ConstantOp.
+inline llvm::Optional<std::int64_t> getIntIfConstant(mlir::Value value) {
+  if (value)
+    if (auto cop = value.getDefiningOp<mlir::arith::ConstantOp>())
+      if (auto attr = cop.value().dyn_cast<mlir::IntegerAttr>())
+        return attr.getInt();
+  return llvm::None;
+}
 } // namespace fir
 
 #endif // FORTRAN_OPTIMIZER_SUPPORT_UTILS_H
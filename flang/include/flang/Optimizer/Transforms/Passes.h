@@ -14,10 +14,8 @@
 #include <memory>
 
 namespace mlir {
-class BlockAndValueMapping;
-class Operation;
+class OpPassManager;
 class Pass;
-class Region;
 } // namespace mlir
 
 namespace fir {
@@ -28,14 +26,24 @@ namespace fir {
 
 std::unique_ptr<mlir::Pass> createAbstractResultOptPass();
 std::unique_ptr<mlir::Pass> createAffineDemotionPass();
+std::unique_ptr<mlir::Pass> createAffineLoopNestOptPass();
+std::unique_ptr<mlir::Pass> createArrayValueCopyPass();
+std::unique_ptr<mlir::Pass> createBoxSpecializationPass();
+std::unique_ptr<mlir::Pass> createCallInliningPass();
 std::unique_ptr<mlir::Pass> createFirToCfgPass();
 std::unique_ptr<mlir::Pass> createCharacterConversionPass();
 std::unique_ptr<mlir::Pass> createExternalNameConversionPass();
+std::unique_ptr<mlir::Pass> createLoopFusionPass();
 std::unique_ptr<mlir::Pass> createPromoteToAffinePass();
+std::unique_ptr<mlir::Pass> createStackArraysPass();
 
-/// Support for inlining on FIR.
-bool canLegallyInline(mlir::Operation *op, mlir::Region *reg,
-                      mlir::BlockAndValueMapping &map);
+/// Add the passes that optimize loop nests over arrays in the affine dialect:
+/// promotion to affine, interchange, tiling and unroll-and-jam, demotion of
+/// the memory operations to FIR and lowering of the affine loops.
+void addAffineLoopOptPipeline(mlir::OpPassManager &pm);
+
+/// Register the above as the `fir-affine-loop-opt` pass pipeline.
+void registerAffineLoopOptPipeline();
 
 // declarative passes
 #define GEN_PASS_REGISTRATION
@@ -36,6 +36,8 @@ class ParseState {
 public:
   ParseState(const CookedSource &cooked)
       : p_{cooked.AsCharBlock().begin()}, limit_{cooked.AsCharBlock().end()} {}
+  explicit ParseState(CharBlock range)
+      : p_{range.begin()}, limit_{range.end()} {}
   ParseState(const ParseState &that)
       : p_{that.p_}, limit_{that.limit_}, context_{that.context_},
         userState_{that.userState_}, inFixedForm_{that.inFixedForm_},
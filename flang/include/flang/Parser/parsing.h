@@ -38,6 +38,7 @@ struct Options {
   bool needProvenanceRangeToCharBlockMappings{false};
   Fortran::parser::Encoding encoding{Fortran::parser::Encoding::UTF_8};
   bool prescanAndReformat{false}; // -E
+  bool parallelParse{false}; // parse independent program units concurrently
 };
 
 class Parsing {
@@ -70,6 +71,8 @@ public:
   }
 
 private:
+  bool ParseProgramUnitsConcurrently(llvm::raw_ostream &debugOutput);
+
   Options options_;
   AllCookedSources &allCooked_;
   CookedSource *currentCooked_{nullptr};
@@ -17,6 +17,7 @@
 #include "flang/Common/interval.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstddef>
+#include <cstdint>
 #include <list>
 #include <map>
 #include <memory>
@@ -190,6 +191,15 @@ private:
     std::string text;
   };
 
+  // A source file that has already been read, with the size and
+  // modification time that it had then, so that repeated inclusions
+  // of an unchanged file don't read it again.
+  struct OpenedSourceFile {
+    const SourceFile *source;
+    std::uint64_t size;
+    std::int64_t modified;
+  };
+
   struct Origin {
     Origin(ProvenanceRange, const SourceFile &);
     Origin(ProvenanceRange, const SourceFile &, ProvenanceRange,
@@ -211,6 +221,7 @@ private:
   ProvenanceRange range_;
   std::map<char, Provenance> compilerInsertionProvenance_;
   std::vector<std::unique_ptr<SourceFile>> ownedSourceFiles_;
+  std::map<std::string, OpenedSourceFile> openedSourceFiles_;
   std::list<std::string> searchPath_;
   Encoding encoding_{Encoding::UTF_8};
 };
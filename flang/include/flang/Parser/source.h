@@ -18,6 +18,8 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include <cstddef>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <utility>
@@ -46,10 +48,10 @@ public:
   ~SourceFile();
   std::string path() const { return path_; }
   llvm::ArrayRef<char> content() const {
-    return buf_->getBuffer().slice(bom_end_, buf_end_ - bom_end_);
+    return {buf_->getBufferStart() + bom_end_, buf_end_ - bom_end_};
   }
   std::size_t bytes() const { return content().size(); }
-  std::size_t lines() const { return lineStart_.size(); }
+  std::size_t lines() const { return lineStarts().size(); }
   Encoding encoding() const { return encoding_; }
 
   bool Open(std::string path, llvm::raw_ostream &error);
@@ -57,17 +59,25 @@ public:
   void Close();
   SourcePosition FindOffsetLineAndColumn(std::size_t) const;
   std::size_t GetLineStartOffset(int lineNumber) const {
-    return lineStart_.at(lineNumber - 1);
+    return lineStarts().at(lineNumber - 1);
   }
 
 private:
   void ReadFile();
   void IdentifyPayload();
-  void RecordLineStarts();
+  const std::vector<std::size_t> &lineStarts() const;
 
   std::string path_;
-  std::unique_ptr<llvm::WritableMemoryBuffer> buf_;
-  std::vector<std::size_t> lineStart_;
+  // Files that need no normalization remain mapped rather than copied.
+  std::unique_ptr<llvm::MemoryBuffer> buf_;
+  // Line start offsets are found on the first query for a source position,
+  // which may come from any of the threads parsing program units. The table
+  // and its guard are replaced together whenever the content is reread.
+  struct LineStartTable {
+    std::once_flag found;
+    std::vector<std::size_t> offsets;
+  };
+  std::unique_ptr<LineStartTable> lineStart_;
   std::size_t bom_end_{0};
   std::size_t buf_end_;
   Encoding encoding_;
@@ -16,6 +16,8 @@
 #include "flang/Common/reference.h"
 #include "flang/Parser/message.h"
 #include "flang/Parser/provenance.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
 #include <list>
 #include <map>
 #include <optional>
@@ -131,9 +133,7 @@ public:
   MutableSymbolVector GetSymbols();
 
   iterator find(const SourceName &name);
-  const_iterator find(const SourceName &name) const {
-    return symbols_.find(name);
-  }
+  const_iterator find(const SourceName &name) const;
   size_type erase(const SourceName &);
   bool empty() const { return symbols_.empty(); }
 
@@ -160,7 +160,7 @@ public:
   common::IfNoLvalue<std::pair<iterator, bool>, D> try_emplace(
       const SourceName &name, Attrs attrs, D &&details) {
     Symbol &symbol{MakeSymbol(name, attrs, std::move(details))};
-    return symbols_.emplace(name, symbol);
+    return Insert(name, symbol);
   }
   // Make a copy of a symbol in this scope; nullptr if one is already there
   Symbol *CopySymbol(const Symbol &);
@@ -261,6 +261,8 @@ public:
   }
 
 private:
+  std::pair<iterator, bool> Insert(const SourceName &, Symbol &);
+
   Scope &parent_; // this is enclosing scope, not extended derived type base
   const Kind kind_;
   std::size_t size_{0}; // size in bytes
@@ -269,6 +271,9 @@ private:
   Symbol *const symbol_; // if not null, symbol_->scope() == this
   std::list<Scope> children_;
   mapType symbols_;
+  // Hashed index of symbols_ by name; symbols_ retains name order for
+  // iteration, but lookups don't need to compare names along a tree path.
+  llvm::DenseMap<llvm::StringRef, iterator> symbolIndex_;
   mapType commonBlocks_;
   std::list<EquivalenceSet> equivalenceSets_;
   mapType crayPointers_;
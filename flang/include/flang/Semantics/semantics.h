@@ -12,6 +12,7 @@
 #include "scope.h"
 #include "symbol.h"
 #include "flang/Common/Fortran-features.h"
+#include "flang/Common/phase-timers.h"
 #include "flang/Evaluate/common.h"
 #include "flang/Evaluate/intrinsics.h"
 #include "flang/Parser/message.h"
@@ -86,6 +87,7 @@ public:
   bool warnOnNonstandardUsage() const { return warnOnNonstandardUsage_; }
   bool warningsAreErrors() const { return warningsAreErrors_; }
   bool debugModuleWriter() const { return debugModuleWriter_; }
+  common::PhaseTimers *phaseTimers() const { return phaseTimers_; }
   const evaluate::IntrinsicProcTable &intrinsics() const { return intrinsics_; }
   Scope &globalScope() { return globalScope_; }
   parser::Messages &messages() { return messages_; }
@@ -122,6 +124,10 @@ public:
     debugModuleWriter_ = x;
     return *this;
   }
+  SemanticsContext &set_phaseTimers(common::PhaseTimers *x) {
+    phaseTimers_ = x;
+    return *this;
+  }
 
   const DeclTypeSpec &MakeNumericType(TypeCategory, int kind = 0);
   const DeclTypeSpec &MakeLogicalType(int kind = 0);
@@ -196,6 +202,7 @@ private:
   bool warnOnNonstandardUsage_{false};
   bool warningsAreErrors_{false};
   bool debugModuleWriter_{false};
+  common::PhaseTimers *phaseTimers_{nullptr}; // for -ftime-report
   const evaluate::IntrinsicProcTable intrinsics_;
   Scope globalScope_;
   parser::Messages messages_;
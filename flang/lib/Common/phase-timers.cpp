@@ -0,0 +1,133 @@
+//===-- lib/Common/phase-timers.cpp ---------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "flang/Common/phase-timers.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#if __unix__ || __APPLE__
+#include <sys/resource.h>
+#endif
+
+namespace Fortran::common {
+
+static const char *GroupDescription(PhaseGroup group) {
+  switch (group) {
+    SWITCH_COVERS_ALL_CASES
+  case PhaseGroup::Frontend:
+    return "Flang frontend phases";
+  case PhaseGroup::Semantics:
+    return "Semantic analysis";
+  case PhaseGroup::ModuleFiles:
+    return "Module files";
+  }
+}
+
+static std::int64_t HeapInUse() {
+  return static_cast<std::int64_t>(llvm::sys::Process::GetMallocUsage());
+}
+
+PhaseTimers::PhaseTimers() {
+  for (std::size_t j{0}; j < PhaseGroup_enumSize; ++j) {
+    auto group{static_cast<PhaseGroup>(j)};
+    groups_.emplace_back(EnumToString(group), GroupDescription(group));
+  }
+}
+
+PhaseTimers::~PhaseTimers() {
+  // A triggered llvm::Timer prints itself when destroyed; the report is
+  // only wanted where Print() is called.
+  for (auto &pair : phases_) {
+    pair.second.timer.clear();
+  }
+}
+
+PhaseTimers::Phase &PhaseTimers::Get(
+    PhaseGroup group, llvm::StringRef name, llvm::StringRef description) {
+  auto groupIter{groups_.begin()};
+  std::advance(groupIter, static_cast<int>(group));
+  std::string key{EnumToString(group) + '.' + name.str()};
+  return phases_.try_emplace(key, name, description, *groupIter)
+      .first->second;
+}
+
+void PhaseTimers::Print(llvm::raw_ostream &os) {
+  for (auto &group : groups_) {
+    group.print(os, /*ResetAfterPrint=*/true);
+  }
+  bool any{false};
+  for (auto &pair : phases_) {
+    if (pair.second.heapGrowth != 0) {
+      if (!any) {
+        os << "===" << std::string(73, '-') << "===\n"
+           << "  Net heap growth by phase (bytes)\n"
+           << "===" << std::string(73, '-') << "===\n";
+        any = true;
+      }
+      os << llvm::format("%14lld  ",
+                static_cast<long long>(pair.second.heapGrowth))
+         << pair.first << '\n';
+    }
+  }
+  if (auto rss{PeakResidentSetSize()}) {
+    os << "Peak resident set size: " << *rss << " bytes\n";
+  }
+  os.flush();
+}
+
+void PhaseTimers::PrintJSON(llvm::raw_ostream &os) {
+  os << "{\n";
+  const char *delim{""};
+  for (auto &group : groups_) {
+    delim = group.printJSONValues(os, delim);
+  }
+  for (const auto &pair : phases_) {
+    os << delim << "\t\"heap." << pair.first
+       << "\": " << pair.second.heapGrowth;
+    delim = ",\n";
+  }
+  if (auto rss{PeakResidentSetSize()}) {
+    os << delim << "\t\"peak-rss\": " << *rss;
+  }
+  os << "\n}\n";
+  os.flush();
+}
+
+std::optional<std::int64_t> PhaseTimers::PeakResidentSetSize() {
+#if __unix__ || __APPLE__
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if __APPLE__
+    return static_cast<std::int64_t>(usage.ru_maxrss); // bytes
+#else
+    return static_cast<std::int64_t>(usage.ru_maxrss) * 1024; // KiB
+#endif
+  }
+#endif
+  return std::nullopt;
+}
+
+PhaseTimer::PhaseTimer(PhaseTimers *timers, PhaseGroup group,
+    llvm::StringRef name, llvm::StringRef description) {
+  if (timers) {
+    auto &phase{timers->Get(group, name, description)};
+    if (!phase.timer.isRunning()) {
+      phase_ = &phase;
+      heapAtStart_ = HeapInUse();
+      phase.timer.startTimer();
+    }
+  }
+}
+
+PhaseTimer::~PhaseTimer() {
+  if (phase_) {
+    phase_->timer.stopTimer();
+    phase_->heapGrowth += HeapInUse() - heapAtStart_;
+  }
+}
+} // namespace Fortran::common
@@ -124,6 +124,7 @@ auto ConstantBase<RESULT, ELEMENT>::Reshape(
   std::size_t n{TotalElementCount(dims)};
   CHECK(!empty() || n == 0);
   std::vector<Element> elements;
+  elements.reserve(n);
   auto iter{values().cbegin()};
   while (n-- > 0) {
     elements.push_back(*iter);
@@ -140,9 +141,11 @@ std::size_t ConstantBase<RESULT, ELEMENT>::CopyFrom(
     ConstantSubscripts &resultSubscripts, const std::vector<int> *dimOrder) {
   std::size_t copied{0};
   ConstantSubscripts sourceSubscripts{source.lbounds()};
+  std::vector<Element> &values{values_.GetMutable()};
+  const std::vector<Element> &sourceValues{source.values()};
   while (copied < count) {
-    values_.at(SubscriptsToOffset(resultSubscripts)) =
-        source.values_.at(source.SubscriptsToOffset(sourceSubscripts));
+    values.at(SubscriptsToOffset(resultSubscripts)) =
+        sourceValues.at(source.SubscriptsToOffset(sourceSubscripts));
     copied++;
     source.IncrementSubscripts(sourceSubscripts);
     IncrementSubscripts(resultSubscripts, dimOrder);
@@ -152,11 +155,17 @@ std::size_t ConstantBase<RESULT, ELEMENT>::CopyFrom(
 
 template <typename T>
 auto Constant<T>::At(const ConstantSubscripts &index) const -> Element {
-  return Base::values_.at(Base::SubscriptsToOffset(index));
+  return Base::values().at(Base::SubscriptsToOffset(index));
 }
 
 template <typename T>
 auto Constant<T>::Reshape(ConstantSubscripts &&dims) const -> Constant {
+  if (TotalElementCount(dims) == Base::size()) {
+    // Same elements in the same order; share them.
+    Constant result{*this};
+    static_cast<ConstantBounds &>(result) = ConstantBounds{std::move(dims)};
+    return result;
+  }
   return {Base::Reshape(dims), std::move(dims)};
 }
 
@@ -170,31 +179,39 @@ std::size_t Constant<T>::CopyFrom(const Constant<T> &source, std::size_t count,
 template <int KIND>
 Constant<Type<TypeCategory::Character, KIND>>::Constant(
     const Scalar<Result> &str)
-    : values_{str}, length_{static_cast<ConstantSubscript>(values_.size())} {}
+    : values_{str}, length_{static_cast<ConstantSubscript>(values().size())} {}
 
 template <int KIND>
 Constant<Type<TypeCategory::Character, KIND>>::Constant(Scalar<Result> &&str)
     : values_{std::move(str)}, length_{static_cast<ConstantSubscript>(
-                                   values_.size())} {}
+                                   values().size())} {}
 
 template <int KIND>
 Constant<Type<TypeCategory::Character, KIND>>::Constant(ConstantSubscript len,
     std::vector<Scalar<Result>> &&strings, ConstantSubscripts &&sh)
     : ConstantBounds(std::move(sh)), length_{len} {
   CHECK(strings.size() == TotalElementCount(shape()));
-  values_.assign(strings.size() * length_,
+  Scalar<Result> &values{values_.GetMutable()};
+  values.assign(strings.size() * length_,
       static_cast<typename Scalar<Result>::value_type>(' '));
   ConstantSubscript at{0};
   for (const auto &str : strings) {
     auto strLen{static_cast<ConstantSubscript>(str.size())};
     if (strLen > length_) {
-      values_.replace(at, length_, str.substr(0, length_));
+      values.replace(at, length_, str, 0, length_);
     } else {
-      values_.replace(at, strLen, str);
+      values.replace(at, strLen, str);
     }
     at += length_;
   }
-  CHECK(at == static_cast<ConstantSubscript>(values_.size()));
+  CHECK(at == static_cast<ConstantSubscript>(values.size()));
+}
+
+template <int KIND>
+Constant<Type<TypeCategory::Character, KIND>>::Constant(ConstantSubscript len,
+    Scalar<Result> &&chars, ConstantSubscripts &&sh)
+    : ConstantBounds(std::move(sh)), values_{std::move(chars)}, length_{len} {
+  CHECK(values().size() == TotalElementCount(shape()) * length_);
 }
 
 template <int KIND>
@@ -210,7 +227,7 @@ std::size_t Constant<Type<TypeCategory::Character, KIND>>::size() const {
   if (length_ == 0) {
     return TotalElementCount(shape());
   } else {
-    return static_cast<ConstantSubscript>(values_.size()) / length_;
+    return static_cast<ConstantSubscript>(values().size()) / length_;
   }
 }
 
@@ -218,7 +235,7 @@ template <int KIND>
 auto Constant<Type<TypeCategory::Character, KIND>>::At(
     const ConstantSubscripts &index) const -> Scalar<Result> {
   auto offset{SubscriptsToOffset(index)};
-  return values_.substr(offset * length_, length_);
+  return values().substr(offset * length_, length_);
 }
 
 template <int KIND>
@@ -226,15 +243,20 @@ auto Constant<Type<TypeCategory::Character, KIND>>::Reshape(
     ConstantSubscripts &&dims) const -> Constant<Result> {
   std::size_t n{TotalElementCount(dims)};
   CHECK(!empty() || n == 0);
-  std::vector<Element> elements;
-  ConstantSubscript at{0},
-      limit{static_cast<ConstantSubscript>(values_.size())};
-  while (n-- > 0) {
-    elements.push_back(values_.substr(at, length_));
-    at += length_;
-    if (at == limit) { // subtle: at > limit somehow? substr() will catch it
-      at = 0;
-    }
+  if (n == size()) {
+    // Same elements in the same order; share them.
+    Constant result{*this};
+    static_cast<ConstantBounds &>(result) = ConstantBounds{std::move(dims)};
+    return result;
+  }
+  // Replicate the concatenated elements cyclically without splitting them
+  // into separate strings.
+  const Scalar<Result> &source{values()};
+  Scalar<Result> elements;
+  std::size_t chars{n * length_};
+  elements.reserve(chars);
+  while (elements.size() < chars) {
+    elements.append(source, 0, chars - elements.size());
   }
   return {length_, std::move(elements), std::move(dims)};
 }
@@ -252,11 +274,13 @@ std::size_t Constant<Type<TypeCategory::Character, KIND>>::CopyFrom(
     return count;
   } else {
     std::size_t copied{0};
-    std::size_t elementBytes{length_ * sizeof(decltype(values_[0]))};
+    Scalar<Result> &values{values_.GetMutable()};
+    const Scalar<Result> &sourceValues{source.values()};
+    std::size_t elementBytes{length_ * sizeof(decltype(values[0]))};
     ConstantSubscripts sourceSubscripts{source.lbounds()};
     while (copied < count) {
-      auto *dest{&values_.at(SubscriptsToOffset(resultSubscripts) * length_)};
-      const auto *src{&source.values_.at(
+      auto *dest{&values.at(SubscriptsToOffset(resultSubscripts) * length_)};
+      const auto *src{&sourceValues.at(
           source.SubscriptsToOffset(sourceSubscripts) * length_)};
       std::memcpy(dest, src, elementBytes);
       copied++;
@@ -294,7 +318,7 @@ Constant<SomeDerived>::Constant(const semantics::DerivedTypeSpec &spec,
 std::optional<StructureConstructor>
 Constant<SomeDerived>::GetScalarValue() const {
   if (Rank() == 0) {
-    return StructureConstructor{result().derivedTypeSpec(), values_.at(0)};
+    return StructureConstructor{result().derivedTypeSpec(), values().at(0)};
   } else {
     return std::nullopt;
   }
@@ -302,7 +326,7 @@ Constant<SomeDerived>::GetScalarValue() const {
 
 StructureConstructor Constant<SomeDerived>::At(
     const ConstantSubscripts &index) const {
-  return {result().derivedTypeSpec(), values_.at(SubscriptsToOffset(index))};
+  return {result().derivedTypeSpec(), values().at(SubscriptsToOffset(index))};
 }
 
 auto Constant<SomeDerived>::Reshape(ConstantSubscripts &&dims) const
@@ -473,7 +473,8 @@ Expr<TR> FoldElementalIntrinsicHelper(FoldingContext &context,
 
     // Compute all the scalar values of the results
     std::vector<Scalar<TR>> results;
-    if (TotalElementCount(shape) > 0) {
+    if (auto n{TotalElementCount(shape)}; n > 0) {
+      results.reserve(n);
       ConstantBounds bounds{shape};
       ConstantSubscripts resultIndex(rank, 1);
       ConstantSubscripts argIndex[]{std::get<I>(*args)->lbounds()...};
@@ -1631,6 +1632,28 @@ std::optional<std::pair<Scalar<LEFT>, Scalar<RIGHT>>> OperandsAreConstants(
   return OperandsAreConstants(operation.left(), operation.right());
 }
 
+// Applies a REAL or COMPLEX arithmetic operation to folded operands,
+// using host arithmetic when it is sure to match the emulation in Real<>.
+template <typename T>
+ValueWithRealFlags<Scalar<T>> FoldArithmetic(FoldingContext &context,
+    host::RealOperation op, const Scalar<T> &x, const Scalar<T> &y) {
+  if (auto result{
+          host::FoldWithHostArithmetic<T>(op, context.rounding(), x, y)}) {
+    return std::move(*result);
+  }
+  switch (op) {
+    SWITCH_COVERS_ALL_CASES
+  case host::RealOperation::Add:
+    return x.Add(y, context.rounding());
+  case host::RealOperation::Subtract:
+    return x.Subtract(y, context.rounding());
+  case host::RealOperation::Multiply:
+    return x.Multiply(y, context.rounding());
+  case host::RealOperation::Divide:
+    return x.Divide(y, context.rounding());
+  }
+}
+
 template <typename T>
 Expr<T> FoldOperation(FoldingContext &context, Add<T> &&x) {
   if (auto array{ApplyElementwise(context, x)}) {
@@ -1645,7 +1668,8 @@ Expr<T> FoldOperation(FoldingContext &context, Add<T> &&x) {
       }
       return Expr<T>{Constant<T>{sum.value}};
     } else {
-      auto sum{folded->first.Add(folded->second, context.rounding())};
+      auto sum{FoldArithmetic<T>(context, host::RealOperation::Add,
+          folded->first, folded->second)};
       RealFlagWarnings(context, sum.flags, "addition");
       if (context.flushSubnormalsToZero()) {
         sum.value = sum.value.FlushSubnormalToZero();
@@ -1670,8 +1694,8 @@ Expr<T> FoldOperation(FoldingContext &context, Subtract<T> &&x) {
       }
       return Expr<T>{Constant<T>{difference.value}};
     } else {
-      auto difference{
-          folded->first.Subtract(folded->second, context.rounding())};
+      auto difference{FoldArithmetic<T>(context,
+          host::RealOperation::Subtract, folded->first, folded->second)};
       RealFlagWarnings(context, difference.flags, "subtraction");
       if (context.flushSubnormalsToZero()) {
         difference.value = difference.value.FlushSubnormalToZero();
@@ -1696,7 +1720,8 @@ Expr<T> FoldOperation(FoldingContext &context, Multiply<T> &&x) {
       }
       return Expr<T>{Constant<T>{product.lower}};
     } else {
-      auto product{folded->first.Multiply(folded->second, context.rounding())};
+      auto product{FoldArithmetic<T>(context, host::RealOperation::Multiply,
+          folded->first, folded->second)};
       RealFlagWarnings(context, product.flags, "multiplication");
       if (context.flushSubnormalsToZero()) {
         product.value = product.value.FlushSubnormalToZero();
@@ -1739,7 +1764,8 @@ Expr<T> FoldOperation(FoldingContext &context, Divide<T> &&x) {
       }
       return Expr<T>{Constant<T>{quotAndRem.quotient}};
     } else {
-      auto quotient{folded->first.Divide(folded->second, context.rounding())};
+      auto quotient{FoldArithmetic<T>(context, host::RealOperation::Divide,
+          folded->first, folded->second)};
       RealFlagWarnings(context, quotient.flags, "division");
       if (context.flushSubnormalsToZero()) {
         quotient.value = quotient.value.FlushSubnormalToZero();
@@ -157,4 +157,52 @@ void HostFloatingPointEnvironment::CheckAndRestoreFloatingPointEnvironment(
 
   errno = 0;
 }
+
+template <typename HOST_T>
+HOST_T HostRealArithmetic(
+    RealOperation op, HOST_T x, HOST_T y, RealFlags &flags) {
+#ifdef __clang__
+#pragma STDC FENV_ACCESS ON
+#endif
+  std::fenv_t originalFenv;
+  feholdexcept(&originalFenv);
+  fesetround(FE_TONEAREST);
+  volatile HOST_T result;
+  switch (op) {
+    SWITCH_COVERS_ALL_CASES
+  case RealOperation::Add:
+    result = x + y;
+    break;
+  case RealOperation::Subtract:
+    result = x - y;
+    break;
+  case RealOperation::Multiply:
+    result = x * y;
+    break;
+  case RealOperation::Divide:
+    result = x / y;
+    break;
+  }
+  int exceptions{fetestexcept(FE_ALL_EXCEPT)};
+  fesetenv(&originalFenv);
+  if (exceptions & FE_INVALID) {
+    flags.set(RealFlag::InvalidArgument);
+  }
+  if (exceptions & FE_DIVBYZERO) {
+    flags.set(RealFlag::DivideByZero);
+  }
+  if (exceptions & FE_OVERFLOW) {
+    flags.set(RealFlag::Overflow);
+  }
+  if (exceptions & FE_UNDERFLOW) {
+    flags.set(RealFlag::Underflow);
+  }
+  if (exceptions & FE_INEXACT) {
+    flags.set(RealFlag::Inexact);
+  }
+  return result;
+}
+
+template float HostRealArithmetic(RealOperation, float, float, RealFlags &);
+template double HostRealArithmetic(RealOperation, double, double, RealFlags &);
 } // namespace Fortran::evaluate::host
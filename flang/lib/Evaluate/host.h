@@ -19,9 +19,12 @@
 
 #include "flang/Evaluate/type.h"
 #include <cfenv>
+#include <cfloat>
+#include <cmath>
 #include <complex>
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <string>
 #include <type_traits>
 
@@ -203,6 +206,50 @@ template <typename... HT> constexpr inline bool FortranTypeExists() {
   return (... && (!std::is_same_v<FortranType<HT>, UnknownType>));
 }
 
+// Basic REAL operations evaluated with host hardware arithmetic. Folding
+// uses them in place of the software emulation in Real<> for kinds whose
+// format the host implements exactly. The operation is performed with
+// round-to-nearest-even, and the exceptions that the host raised are
+// returned in the flags. (SQRT is not here: Real<>::SQRT() is not always
+// correctly rounded, so the host would not reproduce it.)
+ENUM_CLASS(RealOperation, Add, Subtract, Multiply, Divide)
+
+template <typename HOST_T>
+HOST_T HostRealArithmetic(RealOperation, HOST_T x, HOST_T y, RealFlags &);
+
+// Returns std::nullopt when the host result might differ in any way from
+// what Real<> would produce, and the caller must emulate the operation.
+// That is the case for directed rounding modes, NaN operands or results
+// (Real<> produces its own canonical NaN), subnormal operands (the host may
+// be flushing them), and Underflow (tininess detection varies by host).
+template <typename T>
+std::optional<ValueWithRealFlags<Scalar<T>>> FoldWithHostArithmetic(
+    RealOperation op, const Rounding &rounding, const Scalar<T> &x,
+    const Scalar<T> &y) {
+  if constexpr (T::category == TypeCategory::Real && HostTypeExists<T>()) {
+    using HostT = HostType<T>;
+    // Excess precision (e.g., x87) would round twice
+    constexpr bool isExact{FLT_EVAL_METHOD == 0 &&
+        (std::is_same_v<HostT, float> || std::is_same_v<HostT, double>)};
+    if constexpr (isExact) {
+      if (rounding.mode != common::RoundingMode::TiesToEven ||
+          x.IsNotANumber() || y.IsNotANumber() || x.IsSubnormal() ||
+          y.IsSubnormal()) {
+        return std::nullopt;
+      }
+      ValueWithRealFlags<Scalar<T>> result;
+      HostT hostResult{HostRealArithmetic(op, CastFortranToHost<T>(x),
+          CastFortranToHost<T>(y), result.flags)};
+      if (std::isnan(hostResult) || result.flags.test(RealFlag::Underflow)) {
+        return std::nullopt;
+      }
+      result.value = CastHostToFortran<T>(hostResult);
+      return result;
+    }
+  }
+  return std::nullopt;
+}
+
 } // namespace host
 } // namespace Fortran::evaluate
 
@@ -64,6 +64,39 @@ void InitialImage::Incorporate(ConstantSubscript toOffset,
   std::memcpy(&data_[toOffset], &from.data_[fromOffset], bytes);
 }
 
+auto InitialImage::Replicate(ConstantSubscript offset, std::size_t bytes,
+    ConstantSubscript copies) -> Result {
+  if (offset < 0 || copies < 0) {
+    return OutOfRange;
+  }
+  std::size_t total{bytes * static_cast<std::size_t>(copies + 1)};
+  if (static_cast<std::size_t>(offset) + total > data_.size()) {
+    return OutOfRange;
+  }
+  // Double the initialized block with each copy so that the number of
+  // memcpy() calls is logarithmic in the number of copies.
+  for (std::size_t done{bytes}; done < total;) {
+    std::size_t chunk{std::min(done, total - done)};
+    std::memcpy(&data_[offset + done], &data_[offset], chunk);
+    done += chunk;
+  }
+  // Pointers initialized in the block are not in its bytes; each copy
+  // gets its own.
+  auto first{pointers_.lower_bound(offset)};
+  auto last{pointers_.lower_bound(offset + bytes)};
+  if (first != last) {
+    std::vector<std::pair<ConstantSubscript, Expr<SomeType>>> blockPointers{
+        first, last};
+    auto stride{static_cast<ConstantSubscript>(bytes)};
+    for (ConstantSubscript j{1}; j <= copies; ++j) {
+      for (const auto &[at, pointer] : blockPointers) {
+        AddPointer(at + j * stride, pointer);
+      }
+    }
+  }
+  return Ok;
+}
+
 // Classes used with common::SearchTypes() to (re)construct Constant<> values
 // of the right type to initialize each symbol from the values that have
 // been placed into its initialization image by DATA statements.
@@ -90,13 +123,13 @@ public:
     using Const = Constant<T>;
     using Scalar = typename Const::Element;
     std::size_t elements{TotalElementCount(extents_)};
-    std::vector<Scalar> typedValue(elements);
     auto elemBytes{
         ToInt64(type_.MeasureSizeInBytes(context_, GetRank(extents_) > 0))};
     CHECK(elemBytes && *elemBytes >= 0);
     std::size_t stride{static_cast<std::size_t>(*elemBytes)};
     CHECK(offset_ + elements * stride <= image_.data_.size());
     if constexpr (T::category == TypeCategory::Derived) {
+      std::vector<Scalar> typedValue(elements);
       const semantics::DerivedTypeSpec &derived{type_.GetDerivedTypeSpec()};
       for (auto iter : DEREF(derived.scope())) {
         const Symbol &component{*iter.second};
@@ -132,21 +165,25 @@ public:
       return AsGenericExpr(
           Const{derived, std::move(typedValue), std::move(extents_)});
     } else if constexpr (T::category == TypeCategory::Character) {
+      // The elements are contiguous in the image, so they become the
+      // constant's concatenated value directly.
       auto length{static_cast<ConstantSubscript>(stride) / T::kind};
-      for (std::size_t j{0}; j < elements; ++j) {
-        using Char = typename Scalar::value_type;
-        const Char *data{reinterpret_cast<const Char *>(
-            &image_.data_[offset_ + j * stride])};
-        typedValue[j].assign(data, length);
-      }
+      using Char = typename Scalar::value_type;
+      Scalar chars(reinterpret_cast<const Char *>(&image_.data_[offset_]),
+          elements * length);
       return AsGenericExpr(
-          Const{length, std::move(typedValue), std::move(extents_)});
+          Const{length, std::move(chars), std::move(extents_)});
     } else {
       // Lengthless intrinsic type
       CHECK(sizeof(Scalar) <= stride);
-      for (std::size_t j{0}; j < elements; ++j) {
-        std::memcpy(&typedValue[j], &image_.data_[offset_ + j * stride],
-            sizeof(Scalar));
+      std::vector<Scalar> typedValue(elements);
+      if (sizeof(Scalar) == stride && elements > 0) {
+        std::memcpy(&typedValue[0], &image_.data_[offset_], elements * stride);
+      } else {
+        for (std::size_t j{0}; j < elements; ++j) {
+          std::memcpy(&typedValue[j], &image_.data_[offset_ + j * stride],
+              sizeof(Scalar));
+        }
       }
       return AsGenericExpr(Const{std::move(typedValue), std::move(extents_)});
     }
@@ -147,6 +147,12 @@ bool CompilerInstance::ExecuteAction(FrontendAction &act) {
   allSources_->set_encoding(invoc.fortranOpts().encoding);
   // Create the semantics context and set semantic options.
   invoc.setSemanticsOpts(*this->allCookedSources_);
+  // Time the compilation phases if requested.
+  if (frontendOpts().timeReport ||
+      !frontendOpts().timeReportJSONFile.empty()) {
+    phaseTimers_ = std::make_unique<Fortran::common::PhaseTimers>();
+    invoc.semanticsContext().set_phaseTimers(phaseTimers_.get());
+  }
 
   // Run the frontend action `act` for every input file.
   for (const FrontendInputFile &fif : frontendOpts().inputs) {
@@ -157,9 +163,32 @@ bool CompilerInstance::ExecuteAction(FrontendAction &act) {
       act.EndSourceFile();
     }
   }
+  if (phaseTimers_) {
+    ReportPhaseTimes();
+  }
   return !diagnostics().getClient()->getNumErrors();
 }
 
+void CompilerInstance::ReportPhaseTimes() {
+  // The JSON goes first, since printing the text report resets the timers.
+  const std::string &jsonFile{frontendOpts().timeReportJSONFile};
+  if (!jsonFile.empty()) {
+    std::error_code error;
+    llvm::raw_fd_ostream os{jsonFile, error, llvm::sys::fs::OF_Text};
+    if (error) {
+      unsigned diagID = diagnostics().getCustomDiagID(
+          clang::DiagnosticsEngine::Error,
+          "unable to open time report file '%0': '%1'");
+      diagnostics().Report(diagID) << jsonFile << error.message();
+    } else {
+      phaseTimers_->PrintJSON(os);
+    }
+  }
+  if (frontendOpts().timeReport) {
+    phaseTimers_->Print(llvm::errs());
+  }
+}
+
 void CompilerInstance::CreateDiagnostics(
     clang::DiagnosticConsumer *client, bool shouldOwnClient) {
   diagnostics_ =
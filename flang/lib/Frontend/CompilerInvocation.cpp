@@ -310,6 +310,18 @@ static bool ParseFrontendArgs(FrontendOptions &opts, llvm::opt::ArgList &args,
       args.hasFlag(clang::driver::options::OPT_fxor_operator,
           clang::driver::options::OPT_fno_xor_operator, false));
 
+  // -fparallel-parse
+  if (args.hasArg(clang::driver::options::OPT_fparallel_parse)) {
+    opts.parallelParse = true;
+  }
+
+  // -ftime-report and -ftime-report-json=<file>
+  if (args.hasArg(clang::driver::options::OPT_ftime_report)) {
+    opts.timeReport = true;
+  }
+  opts.timeReportJSONFile =
+      args.getLastArgValue(clang::driver::options::OPT_ftime_report_json_EQ);
+
   if (args.hasArg(
           clang::driver::options::OPT_falternative_parameter_statement)) {
     opts.features.Enable(Fortran::common::LanguageFeature::OldStyleParameter);
@@ -656,6 +668,9 @@ void CompilerInvocation::setFortranOpts() {
   if (frontendOptions.needProvenanceRangeToCharBlockMappings)
     fortranOptions.needProvenanceRangeToCharBlockMappings = true;
 
+  if (frontendOptions.parallelParse)
+    fortranOptions.parallelParse = true;
+
   if (enableConformanceChecks()) {
     fortranOptions.features.WarnOnAllNonstandard();
   }
@@ -135,7 +135,11 @@ bool FrontendAction::RunPrescan() {
   }
 
   // Prescan. In case of failure, report and return.
-  ci.parsing().Prescan(currentInputPath, parserOptions);
+  {
+    Fortran::common::PhaseTimer timer{ci.phaseTimers(),
+        Fortran::common::PhaseGroup::Frontend, "prescan", "Prescan"};
+    ci.parsing().Prescan(currentInputPath, parserOptions);
+  }
 
   return !reportFatalScanningErrors();
 }
@@ -144,7 +148,11 @@ bool FrontendAction::RunParse() {
   CompilerInstance &ci = this->instance();
 
   // Parse. In case of failure, report and return.
-  ci.parsing().Parse(llvm::outs());
+  {
+    Fortran::common::PhaseTimer timer{ci.phaseTimers(),
+        Fortran::common::PhaseGroup::Frontend, "parse", "Parse"};
+    ci.parsing().Parse(llvm::outs());
+  }
 
   if (reportFatalParsingErrors()) {
     return false;
@@ -168,7 +176,12 @@ bool FrontendAction::RunSemanticChecks() {
   auto &semantics = ci.semantics();
 
   // Run semantic checks
-  semantics.Perform();
+  {
+    Fortran::common::PhaseTimer timer{ci.phaseTimers(),
+        Fortran::common::PhaseGroup::Frontend, "semantics",
+        "Semantic analysis"};
+    semantics.Perform();
+  }
 
   if (reportFatalSemanticErrors()) {
     return false;
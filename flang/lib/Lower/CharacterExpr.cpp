@@ -276,21 +276,61 @@ void Fortran::lower::CharacterExprHelper::createAssign(
 
 fir::CharBoxValue Fortran::lower::CharacterExprHelper::createConcatenate(
     const fir::CharBoxValue &lhs, const fir::CharBoxValue &rhs) {
-  mlir::Value len =
-      builder.create<mlir::arith::AddIOp>(loc, lhs.getLen(), rhs.getLen());
-  auto temp = createTemp(getCharacterType(rhs), len);
-  createCopy(temp, lhs, lhs.getLen());
-  auto one = builder.createIntegerConstant(loc, len.getType(), 1);
-  auto upperBound = builder.create<mlir::arith::SubIOp>(loc, len, one);
-  auto lhsLen =
-      builder.createConvert(loc, builder.getIndexType(), lhs.getLen());
-  Fortran::lower::DoLoopHelper{builder, loc}.createLoop(
-      lhs.getLen(), upperBound, one,
-      [&](Fortran::lower::FirOpBuilder &bldr, mlir::Value index) {
-        auto rhsIndex = bldr.create<mlir::arith::SubIOp>(loc, index, lhsLen);
-        auto charVal = createLoadCharAt(rhs, rhsIndex);
-        createStoreCharAt(temp, index, charVal);
-      });
+  return createConcatenate(llvm::ArrayRef<fir::CharBoxValue>{lhs, rhs});
+}
+
+fir::CharBoxValue Fortran::lower::CharacterExprHelper::createConcatenate(
+    llvm::ArrayRef<fir::CharBoxValue> pieces) {
+  assert(!pieces.empty() && "expected at least one piece to concatenate");
+  // The total length is computed once and a single temp receives all the
+  // pieces, instead of one temp per // operator. When all the lengths are
+  // known at compile time, the temp has a constant size.
+  auto lenType = getLengthType();
+  llvm::SmallVector<fir::CharBoxValue, 4> safePieces;
+  std::optional<fir::SequenceType::Extent> cstLen = 0;
+  for (const auto &piece : pieces) {
+    // Constants need to be materialized to use fir.coordinate_of on them.
+    auto safePiece = piece;
+    if (piece.getBuffer().getType().isa<fir::SequenceType>())
+      safePiece = materializeValue(piece);
+    auto pieceLen = builder.createConvert(loc, lenType, piece.getLen());
+    safePieces.emplace_back(safePiece.getBuffer(), pieceLen);
+    auto pieceCstLen = getCompileTimeLength(piece);
+    if (cstLen && pieceCstLen)
+      *cstLen += *pieceCstLen;
+    else
+      cstLen.reset();
+  }
+  auto type = getCharacterType(pieces.front());
+  // A length known at compile time is returned as a constant rather than as
+  // the sum of the lengths of the pieces.
+  mlir::Value len;
+  if (cstLen) {
+    len = builder.createIntegerConstant(loc, lenType, *cstLen);
+  } else {
+    len = builder.createIntegerConstant(loc, lenType, 0);
+    for (const auto &piece : safePieces)
+      len = builder.create<mlir::arith::AddIOp>(loc, len, piece.getLen());
+  }
+  fir::CharBoxValue temp =
+      cstLen && *cstLen <= maxConstantLengthTemp
+          ? fir::CharBoxValue{createTemp(type, *cstLen), len}
+          : createTemp(type, len);
+  auto one = builder.createIntegerConstant(loc, lenType, 1);
+  mlir::Value offset = builder.createIntegerConstant(loc, lenType, 0);
+  for (const auto &piece : safePieces) {
+    auto end = builder.create<mlir::arith::AddIOp>(loc, offset, piece.getLen());
+    auto upperBound = builder.create<mlir::arith::SubIOp>(loc, end, one);
+    Fortran::lower::DoLoopHelper{builder, loc}.createLoop(
+        offset, upperBound, one,
+        [&](Fortran::lower::FirOpBuilder &bldr, mlir::Value index) {
+          auto pieceIndex =
+              bldr.create<mlir::arith::SubIOp>(loc, index, offset);
+          auto charVal = createLoadCharAt(piece, pieceIndex);
+          createStoreCharAt(temp, index, charVal);
+        });
+    offset = end;
+  }
   return temp;
 }
 
@@ -410,6 +450,14 @@ Fortran::lower::CharacterExprHelper::createConcatenate(mlir::Value lhs,
       createConcatenate(toDataLengthPair(lhs), toDataLengthPair(rhs)));
 }
 
+mlir::Value Fortran::lower::CharacterExprHelper::createConcatenate(
+    llvm::ArrayRef<mlir::Value> pieces) {
+  llvm::SmallVector<fir::CharBoxValue, 4> boxes;
+  for (auto piece : pieces)
+    boxes.push_back(toDataLengthPair(piece));
+  return createEmbox(createConcatenate(boxes));
+}
+
 mlir::Value
 Fortran::lower::CharacterExprHelper::createEmboxChar(mlir::Value addr,
                                                      mlir::Value len) {
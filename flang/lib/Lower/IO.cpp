@@ -8,6 +8,7 @@
 
 #include "flang/Lower/IO.h"
 #include "RTBuilder.h"
+#include "flang/Evaluate/shape.h"
 #include "flang/Lower/Bridge.h"
 #include "flang/Lower/CharacterExpr.h"
 #include "flang/Lower/ComplexExpr.h"
@@ -186,7 +187,224 @@ static void makeNextConditionalOn(Fortran::lower::FirOpBuilder &builder,
 template <typename D>
 static void genIoLoop(Fortran::lower::AbstractConverter &converter,
                       mlir::Value cookie, const D &ioImpliedDo,
-                      bool checkResult, mlir::Value &ok, bool inIterWhileLoop);
+                      bool isFormatted, bool checkResult, mlir::Value &ok,
+                      bool inIterWhileLoop);
+
+namespace {
+/// An io-implied-do `(a(s1, ..., i, ..., sn), i = lo, hi, st)` whose items
+/// are the elements of a section of a contiguous array of intrinsic type.
+struct IoImpliedDoSection {
+  const Fortran::semantics::SomeExpr *item;
+  std::int64_t step;
+  /// Distance in elements between the items of consecutive iterations.
+  std::int64_t stride;
+  std::int64_t elementBytes;
+};
+} // namespace
+
+/// Is `expr` a reference to the variable `symbol`, possibly converted to
+/// another integer kind?
+static bool isVariableReference(
+    const Fortran::evaluate::Expr<Fortran::evaluate::SubscriptInteger> &expr,
+    const Fortran::semantics::Symbol &symbol) {
+  using ConvertToSubscript =
+      Fortran::evaluate::Convert<Fortran::evaluate::SubscriptInteger,
+                                 Fortran::common::TypeCategory::Integer>;
+  if (const auto *convert = std::get_if<ConvertToSubscript>(&expr.u))
+    return Fortran::evaluate::UnwrapWholeSymbolDataRef(convert->left()) ==
+           &symbol;
+  return Fortran::evaluate::UnwrapWholeSymbolDataRef(expr) == &symbol;
+}
+
+/// Recognize an io-implied-do that transfers an array section: its single
+/// item is an array element with the DO variable as one subscript and the
+/// other subscripts independent of it, and the step is a positive constant.
+template <typename D>
+static std::optional<IoImpliedDoSection>
+getIoImpliedDoSection(Fortran::lower::AbstractConverter &converter,
+                      const D &ioImpliedDo) {
+  const auto &itemList = std::get<0>(ioImpliedDo.t);
+  const auto &control = std::get<1>(ioImpliedDo.t);
+  if (itemList.size() != 1)
+    return std::nullopt;
+  const Fortran::semantics::SomeExpr *item = nullptr;
+  if constexpr (std::is_same_v<D, Fortran::parser::InputImpliedDo>) {
+    if (const auto *var =
+            std::get_if<Fortran::parser::Variable>(&itemList.front().u))
+      item = Fortran::semantics::GetExpr(*var);
+  } else {
+    if (const auto *expr =
+            std::get_if<Fortran::parser::Expr>(&itemList.front().u))
+      item = Fortran::semantics::GetExpr(*expr);
+  }
+  if (!item || item->Rank() != 0)
+    return std::nullopt;
+  auto type = item->GetType();
+  if (!type || (type->category() != Fortran::common::TypeCategory::Integer &&
+                type->category() != Fortran::common::TypeCategory::Real &&
+                type->category() != Fortran::common::TypeCategory::Complex &&
+                type->category() != Fortran::common::TypeCategory::Logical))
+    return std::nullopt;
+  auto elementBytes = Fortran::evaluate::ToInt64(type->MeasureSizeInBytes(
+      converter.getFoldingContext(), /*aligned=*/false));
+  if (!elementBytes)
+    return std::nullopt;
+  std::int64_t step = 1;
+  if (control.step.has_value()) {
+    auto value = Fortran::evaluate::ToInt64(
+        *Fortran::semantics::GetExpr(*control.step));
+    if (!value || *value <= 0)
+      return std::nullopt;
+    step = *value;
+  }
+
+  // The array must be contiguous, so that the section can be described from
+  // the address of its first element.
+  auto dataRef = Fortran::evaluate::ExtractDataRef(*item);
+  const auto *arrayRef =
+      dataRef ? std::get_if<Fortran::evaluate::ArrayRef>(&dataRef->u)
+              : nullptr;
+  if (!arrayRef || !arrayRef->base().IsSymbol())
+    return std::nullopt;
+  const auto &array = arrayRef->base().GetFirstSymbol().GetUltimate();
+  const auto *details =
+      array.detailsIf<Fortran::semantics::ObjectEntityDetails>();
+  if (!details || details->IsAssumedShape() ||
+      Fortran::semantics::IsPointer(array))
+    return std::nullopt;
+
+  const auto &loopSym = *control.name.thing.thing.symbol;
+  std::optional<std::size_t> dim;
+  for (auto subscript : llvm::enumerate(arrayRef->subscript())) {
+    const auto *index =
+        std::get_if<Fortran::evaluate::IndirectSubscriptIntegerExpr>(
+            &subscript.value().u);
+    if (!index)
+      return std::nullopt;
+    if (isVariableReference(index->value(), loopSym)) {
+      if (dim)
+        return std::nullopt;
+      dim = subscript.index();
+    } else if (Fortran::evaluate::CollectSymbols(index->value())
+                   .count(loopSym)) {
+      return std::nullopt;
+    }
+  }
+  if (!dim)
+    return std::nullopt;
+  auto stride = step;
+  if (*dim > 0) {
+    auto shape =
+        Fortran::evaluate::GetShape(converter.getFoldingContext(), array);
+    if (!shape)
+      return std::nullopt;
+    for (std::size_t i = 0; i < *dim; ++i) {
+      auto extent = Fortran::evaluate::ToInt64((*shape)[i]);
+      if (!extent)
+        return std::nullopt;
+      stride *= *extent;
+    }
+  }
+  return IoImpliedDoSection{item, step, stride, *elementBytes};
+}
+
+/// Transfer the items of an io-implied-do that is an array section with a
+/// single runtime call: a block of memory for a contiguous section in an
+/// unformatted transfer, and a descriptor of the section otherwise. The DO
+/// variable is left with the value it has after the last iteration.
+template <typename D>
+static void genIoImpliedDoSection(Fortran::lower::AbstractConverter &converter,
+                                  mlir::Value cookie, const D &ioImpliedDo,
+                                  const IoImpliedDoSection &section,
+                                  bool isFormatted, mlir::Value &ok) {
+  constexpr bool isInput =
+      std::is_same_v<D, Fortran::parser::InputImpliedDo>;
+  auto &builder = converter.getFirOpBuilder();
+  auto loc = converter.getCurrentLocation();
+  auto idxTy = builder.getIndexType();
+  const auto &control = std::get<1>(ioImpliedDo.t);
+  const auto &loopSym = *control.name.thing.thing.symbol;
+  auto loopVar = converter.getSymbolAddress(loopSym);
+  auto genFIRLoopIndex = [&](const Fortran::parser::ScalarIntExpr &expr) {
+    return builder.createConvert(
+        loc, idxTy, converter.genExprValue(*Fortran::semantics::GetExpr(expr)));
+  };
+  auto lowerValue = genFIRLoopIndex(control.lower);
+  auto upperValue = genFIRLoopIndex(control.upper);
+  auto stepValue = builder.createIntegerConstant(loc, idxTy, section.step);
+  auto zero = builder.createIntegerConstant(loc, idxTy, 0);
+  auto one = builder.createIntegerConstant(loc, idxTy, 1);
+  auto diff =
+      builder.create<mlir::arith::SubIOp>(loc, upperValue, lowerValue);
+  auto trips = builder.create<mlir::arith::DivSIOp>(
+      loc, builder.create<mlir::arith::AddIOp>(loc, diff, stepValue),
+      stepValue);
+  auto positive = builder.create<mlir::arith::CmpIOp>(
+      loc, mlir::arith::CmpIPredicate::sgt, trips, zero);
+  mlir::Value count =
+      builder.create<mlir::SelectOp>(loc, positive, trips, zero);
+
+  // Address the first item, then give the DO variable its final value.
+  auto loopVarTy = converter.genType(loopSym);
+  builder.create<fir::StoreOp>(
+      loc, builder.createConvert(loc, loopVarTy, lowerValue), loopVar);
+  auto addr = converter.genExprAddr(section.item, loc);
+  auto finalValue = builder.create<mlir::arith::AddIOp>(
+      loc, lowerValue,
+      builder.create<mlir::arith::MulIOp>(loc, count, stepValue));
+  builder.create<fir::StoreOp>(
+      loc, builder.createConvert(loc, loopVarTy, finalValue), loopVar);
+
+  mlir::FuncOp transferFunc;
+  llvm::SmallVector<mlir::Value, 4> transferArgs = {cookie};
+  if (!isFormatted && section.stride == 1) {
+    if constexpr (isInput)
+      transferFunc =
+          getIORuntimeFunc<mkIOKey(InputUnformattedBlock)>(loc, builder);
+    else
+      transferFunc =
+          getIORuntimeFunc<mkIOKey(OutputUnformattedBlock)>(loc, builder);
+    auto funcTy = transferFunc.getType();
+    auto elementBytes =
+        builder.createIntegerConstant(loc, idxTy, section.elementBytes);
+    auto bytes = builder.create<mlir::arith::MulIOp>(loc, count, elementBytes);
+    transferArgs.push_back(
+        builder.createConvert(loc, funcTy.getInput(1), addr));
+    transferArgs.push_back(
+        builder.createConvert(loc, funcTy.getInput(2), bytes));
+    transferArgs.push_back(
+        builder.createConvert(loc, funcTy.getInput(3), elementBytes));
+  } else {
+    if constexpr (isInput)
+      transferFunc = getIORuntimeFunc<mkIOKey(InputDescriptor)>(loc, builder);
+    else
+      transferFunc = getIORuntimeFunc<mkIOKey(OutputDescriptor)>(loc, builder);
+    // View the memory from the first item as a vector, and take the section
+    // (1 : (count - 1) * stride + 1 : stride) of it.
+    auto eleTy = fir::dyn_cast_ptrEleTy(addr.getType());
+    auto vectorTy = fir::SequenceType::get(
+        {fir::SequenceType::getUnknownExtent()}, eleTy);
+    auto base = builder.createConvert(loc, builder.getRefType(vectorTy), addr);
+    auto strideValue =
+        builder.createIntegerConstant(loc, idxTy, section.stride);
+    auto extent = builder.create<mlir::arith::MulIOp>(loc, count, strideValue);
+    auto shape = builder.create<fir::ShapeOp>(
+        loc, fir::ShapeType::get(builder.getContext(), 1),
+        mlir::ValueRange{extent});
+    auto last = builder.create<mlir::arith::AddIOp>(
+        loc, builder.create<mlir::arith::SubIOp>(loc, extent, strideValue),
+        one);
+    auto slice = builder.create<fir::SliceOp>(
+        loc, fir::SliceType::get(builder.getContext(), 1),
+        mlir::ValueRange{one, last, strideValue}, mlir::ValueRange{});
+    auto box = builder.create<fir::EmboxOp>(loc, fir::BoxType::get(vectorTy),
+                                            base, shape, slice);
+    transferArgs.push_back(
+        builder.createConvert(loc, transferFunc.getType().getInput(1), box));
+  }
+  ok = builder.create<mlir::CallOp>(loc, transferFunc, transferArgs)
+           .getResult(0);
+}
 
 /// Get the OutputXyz routine to output a value of the given type.
 static mlir::FuncOp getOutputFunc(mlir::Location loc,
@@ -220,13 +438,21 @@ static void
 genOutputItemList(Fortran::lower::AbstractConverter &converter,
                   mlir::Value cookie,
                   const std::list<Fortran::parser::OutputItem> &items,
-                  mlir::OpBuilder::InsertPoint &insertPt, bool checkResult,
-                  mlir::Value &ok, bool inIterWhileLoop) {
+                  bool isFormatted, mlir::OpBuilder::InsertPoint &insertPt,
+                  bool checkResult, mlir::Value &ok, bool inIterWhileLoop) {
   auto &builder = converter.getFirOpBuilder();
   for (auto &item : items) {
     if (const auto &impliedDo = std::get_if<1>(&item.u)) {
-      genIoLoop(converter, cookie, impliedDo->value(), checkResult, ok,
-                inIterWhileLoop);
+      if (auto section =
+              getIoImpliedDoSection(converter, impliedDo->value())) {
+        makeNextConditionalOn(builder, converter.getCurrentLocation(),
+                              insertPt, checkResult, ok, inIterWhileLoop);
+        genIoImpliedDoSection(converter, cookie, impliedDo->value(), *section,
+                              isFormatted, ok);
+        continue;
+      }
+      genIoLoop(converter, cookie, impliedDo->value(), isFormatted,
+                checkResult, ok, inIterWhileLoop);
       continue;
     }
     auto &pExpr = std::get<Fortran::parser::Expr>(item.u);
@@ -291,14 +517,23 @@ static mlir::FuncOp getInputFunc(mlir::Location loc,
 static void genInputItemList(Fortran::lower::AbstractConverter &converter,
                              mlir::Value cookie,
                              const std::list<Fortran::parser::InputItem> &items,
+                             bool isFormatted,
                              mlir::OpBuilder::InsertPoint &insertPt,
                              bool checkResult, mlir::Value &ok,
                              bool inIterWhileLoop) {
   auto &builder = converter.getFirOpBuilder();
   for (auto &item : items) {
     if (const auto &impliedDo = std::get_if<1>(&item.u)) {
-      genIoLoop(converter, cookie, impliedDo->value(), checkResult, ok,
-                inIterWhileLoop);
+      if (auto section =
+              getIoImpliedDoSection(converter, impliedDo->value())) {
+        makeNextConditionalOn(builder, converter.getCurrentLocation(),
+                              insertPt, checkResult, ok, inIterWhileLoop);
+        genIoImpliedDoSection(converter, cookie, impliedDo->value(), *section,
+                              isFormatted, ok);
+        continue;
+      }
+      genIoLoop(converter, cookie, impliedDo->value(), isFormatted,
+                checkResult, ok, inIterWhileLoop);
       continue;
     }
     auto &pVar = std::get<Fortran::parser::Variable>(item.u);
@@ -354,7 +589,8 @@ static void genInputItemList(Fortran::lower::AbstractConverter &converter,
 template <typename D>
 static void genIoLoop(Fortran::lower::AbstractConverter &converter,
                       mlir::Value cookie, const D &ioImpliedDo,
-                      bool checkResult, mlir::Value &ok, bool inIterWhileLoop) {
+                      bool isFormatted, bool checkResult, mlir::Value &ok,
+                      bool inIterWhileLoop) {
   mlir::OpBuilder::InsertPoint insertPt;
   auto &builder = converter.getFirOpBuilder();
   auto loc = converter.getCurrentLocation();
@@ -377,11 +613,11 @@ static void genIoLoop(Fortran::lower::AbstractConverter &converter,
                        : builder.create<mlir::arith::ConstantIndexOp>(loc, 1);
   auto genItemList = [&](const D &ioImpliedDo, bool inIterWhileLoop) {
     if constexpr (std::is_same_v<D, Fortran::parser::InputImpliedDo>)
-      genInputItemList(converter, cookie, itemList, insertPt, checkResult, ok,
-                       true);
+      genInputItemList(converter, cookie, itemList, isFormatted, insertPt,
+                       checkResult, ok, true);
     else
-      genOutputItemList(converter, cookie, itemList, insertPt, checkResult, ok,
-                        true);
+      genOutputItemList(converter, cookie, itemList, isFormatted, insertPt,
+                        checkResult, ok, true);
   };
   if (!checkResult) {
     // No I/O call result checks - the loop is a fir.do_loop op.
@@ -1345,13 +1581,13 @@ genDataTransferStmt(Fortran::lower::AbstractConverter &converter, const A &stmt,
 
   // Generate data transfer list calls.
   if constexpr (isInput) // ReadStmt
-    genInputItemList(converter, cookie, stmt.items, insertPt,
+    genInputItemList(converter, cookie, stmt.items, isFormatted, insertPt,
                      csi.hasTransferConditionSpecifier(), ok, false);
   else if constexpr (std::is_same_v<A, Fortran::parser::PrintStmt>)
-    genOutputItemList(converter, cookie, std::get<1>(stmt.t), insertPt,
-                      csi.hasTransferConditionSpecifier(), ok, false);
+    genOutputItemList(converter, cookie, std::get<1>(stmt.t), isFormatted,
+                      insertPt, csi.hasTransferConditionSpecifier(), ok, false);
   else // WriteStmt
-    genOutputItemList(converter, cookie, stmt.items, insertPt,
+    genOutputItemList(converter, cookie, stmt.items, isFormatted, insertPt,
                       csi.hasTransferConditionSpecifier(), ok, false);
 
   // Generate end statement call/s.
@@ -24,6 +24,7 @@
 #include "flang/Lower/Runtime.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include <algorithm>
 #include <string_view>
 #include <utility>
@@ -47,6 +48,10 @@
 /// Enums used to templatize and share lowering of MIN and MAX.
 enum class Extremum { Min, Max };
 
+/// Enum used to templatize and share lowering of SUM, PRODUCT, MAXVAL and
+/// MINVAL.
+enum class Reduction { Sum, Product, Maxval, Minval };
+
 // There are different ways to deal with NaNs in MIN and MAX.
 // Known existing behaviors are listed below and can be selected for
 // f18 MIN/MAX implementation.
@@ -123,10 +128,15 @@ struct IntrinsicLibrary {
   mlir::Value genAbs(mlir::Type, llvm::ArrayRef<mlir::Value>);
   mlir::Value genAimag(mlir::Type, llvm::ArrayRef<mlir::Value>);
   mlir::Value genAint(mlir::Type, llvm::ArrayRef<mlir::Value>);
+  fir::ExtendedValue genAll(mlir::Type, llvm::ArrayRef<fir::ExtendedValue>);
   mlir::Value genAnint(mlir::Type, llvm::ArrayRef<mlir::Value>);
+  fir::ExtendedValue genAny(mlir::Type, llvm::ArrayRef<fir::ExtendedValue>);
   mlir::Value genCeiling(mlir::Type, llvm::ArrayRef<mlir::Value>);
   mlir::Value genConjg(mlir::Type, llvm::ArrayRef<mlir::Value>);
+  fir::ExtendedValue genCount(mlir::Type, llvm::ArrayRef<fir::ExtendedValue>);
   mlir::Value genDim(mlir::Type, llvm::ArrayRef<mlir::Value>);
+  fir::ExtendedValue genDotProduct(mlir::Type,
+                                   llvm::ArrayRef<fir::ExtendedValue>);
   mlir::Value genDprod(mlir::Type, llvm::ArrayRef<mlir::Value>);
   template <Extremum, ExtremumBehavior>
   mlir::Value genExtremum(mlir::Type, llvm::ArrayRef<mlir::Value>);
@@ -137,10 +147,16 @@ struct IntrinsicLibrary {
   mlir::Value genIOr(mlir::Type, llvm::ArrayRef<mlir::Value>);
   fir::ExtendedValue genLen(mlir::Type, llvm::ArrayRef<fir::ExtendedValue>);
   fir::ExtendedValue genLenTrim(mlir::Type, llvm::ArrayRef<fir::ExtendedValue>);
+  fir::ExtendedValue genMatmul(mlir::Type, llvm::ArrayRef<fir::ExtendedValue>);
   mlir::Value genMerge(mlir::Type, llvm::ArrayRef<mlir::Value>);
   mlir::Value genMod(mlir::Type, llvm::ArrayRef<mlir::Value>);
   mlir::Value genNint(mlir::Type, llvm::ArrayRef<mlir::Value>);
+  template <Reduction>
+  fir::ExtendedValue genReduction(mlir::Type,
+                                  llvm::ArrayRef<fir::ExtendedValue>);
   mlir::Value genSign(mlir::Type, llvm::ArrayRef<mlir::Value>);
+  fir::ExtendedValue genTranspose(mlir::Type,
+                                  llvm::ArrayRef<fir::ExtendedValue>);
   /// Implement all conversion functions like DBLE, the first argument is
   /// the value to convert. There may be an additional KIND arguments that
   /// is ignored because this is already reflected in the result type.
@@ -193,6 +209,26 @@ struct IntrinsicLibrary {
   getUnrestrictedIntrinsicSymbolRefAttr(llvm::StringRef name,
                                         mlir::FunctionType signature);
 
+  /// Helpers to expand intrinsics over arrays inline.
+  /// Generate a loop nest over the elements of an array of extents
+  /// \p extents, the first dimension innermost, threading \p init through
+  /// the iterations. The body generator is given the one-based indices of an
+  /// element and the current values, and returns the next values.
+  using ArrayLoopBodyGenerator = std::function<llvm::SmallVector<mlir::Value>(
+      llvm::ArrayRef<mlir::Value>, llvm::ArrayRef<mlir::Value>)>;
+  llvm::SmallVector<mlir::Value>
+  genArrayLoops(llvm::ArrayRef<mlir::Value> extents,
+                llvm::ArrayRef<mlir::Value> init,
+                const ArrayLoopBodyGenerator &genBody);
+  mlir::Value genShape(llvm::ArrayRef<mlir::Value> extents);
+  mlir::Value genElementAddr(mlir::Value addr, mlir::Value shape,
+                             llvm::ArrayRef<mlir::Value> indices);
+  mlir::Value genArrayTemp(mlir::Type eleTy,
+                           llvm::ArrayRef<mlir::Value> extents);
+  fir::ExtendedValue
+  genLogicalReduction(bool isAll, mlir::Type,
+                      llvm::ArrayRef<fir::ExtendedValue>);
+
   Fortran::lower::FirOpBuilder &builder;
   mlir::Location loc;
 };
@@ -208,6 +244,12 @@ struct IntrinsicHandler {
   /// Code heavy intrinsic can be outlined to make FIR
   /// more readable.
   bool outline = false;
+  /// The intrinsic operates on arrays and is expanded inline when its
+  /// arguments allow it. Otherwise the generator returns a null value and
+  /// generates nothing, and the caller calls the runtime. It is never
+  /// outlined: a wrapper would lose the extents of the array arguments and
+  /// return the address of its own stack temporaries.
+  bool expandsArrays = false;
 };
 using I = IntrinsicLibrary;
 static constexpr IntrinsicHandler handlers[]{
@@ -215,12 +257,20 @@ static constexpr IntrinsicHandler handlers[]{
     {"achar", &I::genConversion},
     {"aimag", &I::genAimag},
     {"aint", &I::genAint},
+    {"all", &I::genAll, /*isElemental=*/false, /*outline=*/false,
+     /*expandsArrays=*/true},
     {"anint", &I::genAnint},
+    {"any", &I::genAny, /*isElemental=*/false, /*outline=*/false,
+     /*expandsArrays=*/true},
     {"ceiling", &I::genCeiling},
     {"char", &I::genConversion},
     {"conjg", &I::genConjg},
+    {"count", &I::genCount, /*isElemental=*/false, /*outline=*/false,
+     /*expandsArrays=*/true},
     {"dim", &I::genDim},
     {"dble", &I::genConversion},
+    {"dot_product", &I::genDotProduct, /*isElemental=*/false, /*outline=*/false,
+     /*expandsArrays=*/true},
     {"dprod", &I::genDprod},
     {"floor", &I::genFloor},
     {"iand", &I::genIAnd},
@@ -229,12 +279,24 @@ static constexpr IntrinsicHandler handlers[]{
     {"ior", &I::genIOr},
     {"len", &I::genLen},
     {"len_trim", &I::genLenTrim},
+    {"matmul", &I::genMatmul, /*isElemental=*/false, /*outline=*/false,
+     /*expandsArrays=*/true},
     {"max", &I::genExtremum<Extremum::Max, ExtremumBehavior::MinMaxss>},
+    {"maxval", &I::genReduction<Reduction::Maxval>, /*isElemental=*/false,
+     /*outline=*/false, /*expandsArrays=*/true},
     {"min", &I::genExtremum<Extremum::Min, ExtremumBehavior::MinMaxss>},
+    {"minval", &I::genReduction<Reduction::Minval>, /*isElemental=*/false,
+     /*outline=*/false, /*expandsArrays=*/true},
     {"merge", &I::genMerge},
     {"mod", &I::genMod},
     {"nint", &I::genNint},
+    {"product", &I::genReduction<Reduction::Product>, /*isElemental=*/false,
+     /*outline=*/false, /*expandsArrays=*/true},
     {"sign", &I::genSign},
+    {"sum", &I::genReduction<Reduction::Sum>, /*isElemental=*/false,
+     /*outline=*/false, /*expandsArrays=*/true},
+    {"transpose", &I::genTranspose, /*isElemental=*/false, /*outline=*/false,
+     /*expandsArrays=*/true},
 };
 
 /// To make fir output more readable for debug, one can outline all intrinsic
@@ -245,6 +307,15 @@ static llvm::cl::opt<bool> outlineAllIntrinsics(
         "Lower all intrinsic procedure implementation in their own functions"),
     llvm::cl::init(false));
 
+/// Array results of the inline expansions are allocated on the stack up to
+/// this size. Larger results, and results whose size is not constant, are
+/// left to the runtime.
+static llvm::cl::opt<std::uint64_t> intrinsicStackTempLimit(
+    "intrinsic-stack-temp-limit",
+    llvm::cl::desc("Maximum size in bytes of the stack temporary holding the "
+                   "array result of an inlined intrinsic"),
+    llvm::cl::init(4096));
+
 //===----------------------------------------------------------------------===//
 // Math runtime description and matching utility
 //===----------------------------------------------------------------------===//
@@ -692,7 +763,8 @@ IntrinsicLibrary::genIntrinsicCall(llvm::StringRef name, mlir::Type resultType,
                                    llvm::ArrayRef<fir::ExtendedValue> args) {
   for (auto &handler : handlers)
     if (name == handler.name) {
-      bool outline = handler.outline || outlineAllIntrinsics;
+      bool outline = (handler.outline || outlineAllIntrinsics) &&
+                     !handler.expandsArrays;
       if (const auto *elementalGenerator =
               std::get_if<ElementalGenerator>(&handler.generator))
         return genElementalCall(*elementalGenerator, name, resultType, args,
@@ -922,6 +994,89 @@ mlir::SymbolRefAttr IntrinsicLibrary::getUnrestrictedIntrinsicSymbolRefAttr(
   return SymbolRefAttr::get(funcOp);
 }
 
+llvm::SmallVector<mlir::Value>
+IntrinsicLibrary::genArrayLoops(llvm::ArrayRef<mlir::Value> extents,
+                                llvm::ArrayRef<mlir::Value> init,
+                                const ArrayLoopBodyGenerator &genBody) {
+  auto one = builder.createIntegerConstant(loc, builder.getIndexType(), 1);
+  llvm::SmallVector<mlir::Value> indices(extents.size());
+  std::function<llvm::SmallVector<mlir::Value>(unsigned,
+                                               llvm::ArrayRef<mlir::Value>)>
+      genLoop = [&](unsigned dim, llvm::ArrayRef<mlir::Value> values)
+      -> llvm::SmallVector<mlir::Value> {
+    if (dim == 0)
+      return genBody(indices, values);
+    auto ub = builder.convertToIndexType(loc, extents[dim - 1]);
+    auto loop = builder.create<fir::DoLoopOp>(
+        loc, one, ub, one, /*unordered=*/false, /*finalCountValue=*/false,
+        values);
+    auto insertPt = builder.saveInsertionPoint();
+    builder.setInsertionPointToStart(loop.getBody());
+    indices[dim - 1] = loop.getInductionVar();
+    llvm::SmallVector<mlir::Value> iterArgs(loop.getRegionIterArgs().begin(),
+                                            loop.getRegionIterArgs().end());
+    auto next = genLoop(dim - 1, iterArgs);
+    if (!values.empty())
+      builder.create<fir::ResultOp>(loc, next);
+    builder.restoreInsertionPoint(insertPt);
+    return {loop.getResults().begin(), loop.getResults().end()};
+  };
+  return genLoop(extents.size(), init);
+}
+
+mlir::Value IntrinsicLibrary::genShape(llvm::ArrayRef<mlir::Value> extents) {
+  llvm::SmallVector<mlir::Value> idxExtents;
+  for (auto extent : extents)
+    idxExtents.push_back(builder.convertToIndexType(loc, extent));
+  return builder.create<fir::ShapeOp>(
+      loc, fir::ShapeType::get(builder.getContext(), extents.size()),
+      idxExtents);
+}
+
+mlir::Value
+IntrinsicLibrary::genElementAddr(mlir::Value addr, mlir::Value shape,
+                                 llvm::ArrayRef<mlir::Value> indices) {
+  auto eleTy = fir::dyn_cast_ptrEleTy(addr.getType())
+                   .cast<fir::SequenceType>()
+                   .getEleTy();
+  return builder.create<fir::ArrayCoorOp>(
+      loc, builder.getRefType(eleTy), addr, shape, /*slice=*/mlir::Value{},
+      indices, /*typeparams=*/mlir::ValueRange{});
+}
+
+/// Size in bytes of an element of type \p eleTy of an inlinable array.
+static std::uint64_t getElementSize(Fortran::lower::FirOpBuilder &builder,
+                                    mlir::Type eleTy) {
+  if (auto logicalTy = eleTy.dyn_cast<fir::LogicalType>())
+    return llvm::divideCeil(
+        builder.getKindMap().getLogicalBitsize(logicalTy.getFKind()), 8);
+  return llvm::divideCeil(eleTy.getIntOrFloatBitWidth(), 8);
+}
+
+mlir::Value
+IntrinsicLibrary::genArrayTemp(mlir::Type eleTy,
+                               llvm::ArrayRef<mlir::Value> extents) {
+  // A small temporary of constant shape is allocated once in the entry
+  // block, so that a call in a loop does not grow the stack. No temporary is
+  // created, and a null value is returned, for any other shape.
+  fir::SequenceType::Shape shape;
+  auto size = getElementSize(builder, eleTy);
+  for (auto extent : extents) {
+    auto cst = extent.getDefiningOp<mlir::arith::ConstantOp>();
+    auto attr = cst ? cst.value().dyn_cast<mlir::IntegerAttr>()
+                    : mlir::IntegerAttr{};
+    if (!attr)
+      return {};
+    shape.push_back(attr.getInt());
+    size = llvm::SaturatingMultiply(
+        size, static_cast<std::uint64_t>(
+                  std::max<std::int64_t>(attr.getInt(), 0)));
+  }
+  if (size > intrinsicStackTempLimit)
+    return {};
+  return builder.createTemporary(loc, fir::SequenceType::get(shape, eleTy));
+}
+
 //===----------------------------------------------------------------------===//
 // Code generators for the intrinsic
 //===----------------------------------------------------------------------===//
@@ -1268,17 +1423,353 @@ mlir::Value IntrinsicLibrary::genExtremum(mlir::Type,
   return result;
 }
 
+/// Intrinsics over arrays are expanded inline when the array is contiguous in
+/// memory with known extents and its elements are of an integer, real or
+/// logical type. Descriptors, which may be polymorphic or not contiguous, are
+/// left to the runtime.
+static const fir::ArrayBoxValue *
+getInlinableArray(const fir::ExtendedValue &exv) {
+  const auto *array = exv.getArrayBox();
+  if (!array)
+    return nullptr;
+  auto seqTy = fir::dyn_cast_ptrEleTy(array->getAddr().getType())
+                   .dyn_cast_or_null<fir::SequenceType>();
+  if (!seqTy || seqTy.getDimension() != array->getExtents().size())
+    return nullptr;
+  if (!seqTy.getEleTy()
+           .isa<mlir::IntegerType, mlir::FloatType, fir::LogicalType>())
+    return nullptr;
+  return array;
+}
+
+static mlir::Type getArrayElementType(const fir::ArrayBoxValue &array) {
+  return fir::dyn_cast_ptrEleTy(array.getAddr().getType())
+      .cast<fir::SequenceType>()
+      .getEleTy();
+}
+
+/// Is every argument from position \p first on absent ?
+static bool areAbsent(llvm::ArrayRef<fir::ExtendedValue> args,
+                      unsigned first) {
+  for (const auto &arg : args.drop_front(first))
+    if (fir::getBase(arg))
+      return false;
+  return true;
+}
+
+/// Types on which the inline expansions can compute with the arith dialect.
+static bool isArithmeticType(mlir::Type type) {
+  if (auto intTy = type.dyn_cast<mlir::IntegerType>())
+    return intTy.getWidth() <= 64;
+  return type.isa<mlir::FloatType>();
+}
+
+/// Result of an intrinsic over arrays whose inline expansion does not apply.
+/// Nothing has been generated, and the caller calls the runtime instead.
+static fir::ExtendedValue declineExpansion() { return mlir::Value{}; }
+
+static mlir::Value genAdd(Fortran::lower::FirOpBuilder &builder,
+                          mlir::Location loc, mlir::Value x, mlir::Value y) {
+  if (x.getType().isa<mlir::IntegerType>())
+    return builder.create<mlir::arith::AddIOp>(loc, x, y);
+  return builder.create<mlir::arith::AddFOp>(loc, x, y);
+}
+
+static mlir::Value genMul(Fortran::lower::FirOpBuilder &builder,
+                          mlir::Location loc, mlir::Value x, mlir::Value y) {
+  if (x.getType().isa<mlir::IntegerType>())
+    return builder.create<mlir::arith::MulIOp>(loc, x, y);
+  return builder.create<mlir::arith::MulFOp>(loc, x, y);
+}
+
+/// Initial value of a reduction. MAXVAL and MINVAL of an empty array are the
+/// most negative and most positive finite values, as in the runtime.
+template <Reduction reduction>
+static mlir::Value genReductionInit(Fortran::lower::FirOpBuilder &builder,
+                                    mlir::Location loc, mlir::Type type) {
+  if (auto intTy = type.dyn_cast<mlir::IntegerType>()) {
+    auto width = intTy.getWidth();
+    std::int64_t value = 0;
+    if constexpr (reduction == Reduction::Product)
+      value = 1;
+    else if constexpr (reduction == Reduction::Maxval)
+      value = llvm::APInt::getSignedMinValue(width).getSExtValue();
+    else if constexpr (reduction == Reduction::Minval)
+      value = llvm::APInt::getSignedMaxValue(width).getSExtValue();
+    return builder.createIntegerConstant(loc, type, value);
+  }
+  if constexpr (reduction == Reduction::Sum)
+    return builder.createRealZeroConstant(loc, type);
+  const auto &semantics = type.cast<mlir::FloatType>().getFloatSemantics();
+  if constexpr (reduction == Reduction::Product)
+    return builder.createRealConstant(loc, type, llvm::APFloat(semantics, 1));
+  return builder.createRealConstant(
+      loc, type,
+      llvm::APFloat::getLargest(semantics, reduction == Reduction::Maxval));
+}
+
+// ALL and ANY
+fir::ExtendedValue IntrinsicLibrary::genLogicalReduction(
+    bool isAll, mlir::Type resultType,
+    llvm::ArrayRef<fir::ExtendedValue> args) {
+  // MASK [, DIM]
+  assert(args.size() >= 1);
+  const auto *mask = getInlinableArray(args[0]);
+  if (!mask || !areAbsent(args, 1))
+    return declineExpansion();
+  auto i1Type = builder.getI1Type();
+  auto shape = genShape(mask->getExtents());
+  auto init = builder.createIntegerConstant(loc, i1Type, isAll ? 1 : 0);
+  auto result = genArrayLoops(
+      mask->getExtents(), init,
+      [&](llvm::ArrayRef<mlir::Value> indices,
+          llvm::ArrayRef<mlir::Value> values)
+          -> llvm::SmallVector<mlir::Value> {
+        auto addr = genElementAddr(mask->getAddr(), shape, indices);
+        auto element = builder.createConvert(
+            loc, i1Type, builder.create<fir::LoadOp>(loc, addr));
+        if (isAll)
+          return {builder.create<mlir::arith::AndIOp>(loc, values[0], element)};
+        return {builder.create<mlir::arith::OrIOp>(loc, values[0], element)};
+      });
+  return builder.createConvert(loc, resultType, result[0]);
+}
+
+fir::ExtendedValue
+IntrinsicLibrary::genAll(mlir::Type resultType,
+                         llvm::ArrayRef<fir::ExtendedValue> args) {
+  return genLogicalReduction(/*isAll=*/true, resultType, args);
+}
+
+fir::ExtendedValue
+IntrinsicLibrary::genAny(mlir::Type resultType,
+                         llvm::ArrayRef<fir::ExtendedValue> args) {
+  return genLogicalReduction(/*isAll=*/false, resultType, args);
+}
+
+// COUNT
+fir::ExtendedValue
+IntrinsicLibrary::genCount(mlir::Type resultType,
+                           llvm::ArrayRef<fir::ExtendedValue> args) {
+  // MASK [, DIM] [, KIND]. KIND is reflected in the result type.
+  assert(args.size() >= 1);
+  const auto *mask = getInlinableArray(args[0]);
+  if (!mask || (args.size() > 1 && fir::getBase(args[1])) ||
+      !isArithmeticType(resultType) || !resultType.isa<mlir::IntegerType>())
+    return declineExpansion();
+  auto shape = genShape(mask->getExtents());
+  auto zero = builder.createIntegerConstant(loc, resultType, 0);
+  auto one = builder.createIntegerConstant(loc, resultType, 1);
+  auto result = genArrayLoops(
+      mask->getExtents(), zero,
+      [&](llvm::ArrayRef<mlir::Value> indices,
+          llvm::ArrayRef<mlir::Value> values)
+          -> llvm::SmallVector<mlir::Value> {
+        auto addr = genElementAddr(mask->getAddr(), shape, indices);
+        auto element = builder.createConvert(
+            loc, builder.getI1Type(), builder.create<fir::LoadOp>(loc, addr));
+        auto inc = builder.create<mlir::SelectOp>(loc, element, one, zero);
+        return {builder.create<mlir::arith::AddIOp>(loc, values[0], inc)};
+      });
+  return result[0];
+}
+
+// DOT_PRODUCT
+fir::ExtendedValue
+IntrinsicLibrary::genDotProduct(mlir::Type resultType,
+                                llvm::ArrayRef<fir::ExtendedValue> args) {
+  assert(args.size() == 2);
+  const auto *vectorA = getInlinableArray(args[0]);
+  const auto *vectorB = getInlinableArray(args[1]);
+  bool isLogical = resultType.isa<fir::LogicalType>();
+  // COMPLEX vectors, whose first vector is conjugated, are not inlinable.
+  if (!vectorA || !vectorB || vectorA->getExtents().size() != 1 ||
+      vectorB->getExtents().size() != 1 ||
+      (!isLogical && !isArithmeticType(resultType)))
+    return declineExpansion();
+  auto type = isLogical ? builder.getI1Type() : resultType;
+  auto shapeA = genShape(vectorA->getExtents());
+  auto shapeB = genShape(vectorB->getExtents());
+  auto init = isLogical
+                  ? builder.createIntegerConstant(loc, type, 0)
+                  : genReductionInit<Reduction::Sum>(builder, loc, type);
+  auto result = genArrayLoops(
+      vectorA->getExtents(), init,
+      [&](llvm::ArrayRef<mlir::Value> indices,
+          llvm::ArrayRef<mlir::Value> values)
+          -> llvm::SmallVector<mlir::Value> {
+        auto x = builder.createConvert(
+            loc, type,
+            builder.create<fir::LoadOp>(
+                loc, genElementAddr(vectorA->getAddr(), shapeA, indices)));
+        auto y = builder.createConvert(
+            loc, type,
+            builder.create<fir::LoadOp>(
+                loc, genElementAddr(vectorB->getAddr(), shapeB, indices)));
+        if (isLogical)
+          return {builder.create<mlir::arith::OrIOp>(
+              loc, values[0], builder.create<mlir::arith::AndIOp>(loc, x, y))};
+        return {genAdd(builder, loc, values[0], genMul(builder, loc, x, y))};
+      });
+  return builder.createConvert(loc, resultType, result[0]);
+}
+
+// MATMUL
+fir::ExtendedValue
+IntrinsicLibrary::genMatmul(mlir::Type resultType,
+                            llvm::ArrayRef<fir::ExtendedValue> args) {
+  assert(args.size() == 2);
+  const auto *matrixA = getInlinableArray(args[0]);
+  const auto *matrixB = getInlinableArray(args[1]);
+  auto eleTy = resultType;
+  if (auto seqTy = resultType.dyn_cast<fir::SequenceType>())
+    eleTy = seqTy.getEleTy();
+  if (!matrixA || !matrixB || !isArithmeticType(eleTy))
+    return declineExpansion();
+  auto rankA = matrixA->getExtents().size();
+  auto rankB = matrixB->getExtents().size();
+  if (rankA > 2 || rankB > 2 || (rankA == 1 && rankB == 1))
+    return declineExpansion();
+
+  // The loops run over the rows i of the result, the common dimension k and
+  // the columns j of the result, i innermost, so that the accesses to the
+  // columns of A and of the result are contiguous.
+  const auto &extentsA = matrixA->getExtents();
+  const auto &extentsB = matrixB->getExtents();
+  llvm::SmallVector<mlir::Value> resultExtents;
+  llvm::SmallVector<mlir::Value> loopExtents;
+  if (rankA == 2) {
+    resultExtents.push_back(extentsA[0]);
+    loopExtents.push_back(extentsA[0]);
+  }
+  loopExtents.push_back(extentsA.back());
+  if (rankB == 2) {
+    resultExtents.push_back(extentsB[1]);
+    loopExtents.push_back(extentsB[1]);
+  }
+  auto result = genArrayTemp(eleTy, resultExtents);
+  if (!result)
+    return declineExpansion();
+  auto resultShape = genShape(resultExtents);
+  auto shapeA = genShape(extentsA);
+  auto shapeB = genShape(extentsB);
+  auto zero = genReductionInit<Reduction::Sum>(builder, loc, eleTy);
+  genArrayLoops(resultExtents, {},
+                [&](llvm::ArrayRef<mlir::Value> indices,
+                    llvm::ArrayRef<mlir::Value>) {
+                  builder.create<fir::StoreOp>(
+                      loc, zero, genElementAddr(result, resultShape, indices));
+                  return llvm::SmallVector<mlir::Value>{};
+                });
+  genArrayLoops(
+      loopExtents, {},
+      [&](llvm::ArrayRef<mlir::Value> indices, llvm::ArrayRef<mlir::Value>) {
+        auto k = indices[rankA == 2 ? 1 : 0];
+        llvm::SmallVector<mlir::Value, 2> indicesA{k};
+        llvm::SmallVector<mlir::Value, 2> indicesB{k};
+        llvm::SmallVector<mlir::Value, 2> resultIndices;
+        if (rankA == 2) {
+          indicesA.insert(indicesA.begin(), indices.front());
+          resultIndices.push_back(indices.front());
+        }
+        if (rankB == 2) {
+          indicesB.push_back(indices.back());
+          resultIndices.push_back(indices.back());
+        }
+        auto x = builder.createConvert(
+            loc, eleTy,
+            builder.create<fir::LoadOp>(
+                loc, genElementAddr(matrixA->getAddr(), shapeA, indicesA)));
+        auto y = builder.createConvert(
+            loc, eleTy,
+            builder.create<fir::LoadOp>(
+                loc, genElementAddr(matrixB->getAddr(), shapeB, indicesB)));
+        auto addr = genElementAddr(result, resultShape, resultIndices);
+        auto sum = genAdd(builder, loc, builder.create<fir::LoadOp>(loc, addr),
+                          genMul(builder, loc, x, y));
+        builder.create<fir::StoreOp>(loc, sum, addr);
+        return llvm::SmallVector<mlir::Value>{};
+      });
+  return fir::ArrayBoxValue{result, resultExtents};
+}
+
+// SUM, PRODUCT, MAXVAL and MINVAL
+template <Reduction reduction>
+fir::ExtendedValue
+IntrinsicLibrary::genReduction(mlir::Type resultType,
+                               llvm::ArrayRef<fir::ExtendedValue> args) {
+  // ARRAY [, DIM] [, MASK]
+  assert(args.size() >= 1);
+  const auto *array = getInlinableArray(args[0]);
+  if (!array || !areAbsent(args, 1) || !isArithmeticType(resultType))
+    return declineExpansion();
+  auto shape = genShape(array->getExtents());
+  auto init = genReductionInit<reduction>(builder, loc, resultType);
+  auto result = genArrayLoops(
+      array->getExtents(), init,
+      [&](llvm::ArrayRef<mlir::Value> indices,
+          llvm::ArrayRef<mlir::Value> values)
+          -> llvm::SmallVector<mlir::Value> {
+        auto addr = genElementAddr(array->getAddr(), shape, indices);
+        auto element = builder.createConvert(
+            loc, resultType, builder.create<fir::LoadOp>(loc, addr));
+        if constexpr (reduction == Reduction::Sum) {
+          return {genAdd(builder, loc, values[0], element)};
+        } else if constexpr (reduction == Reduction::Product) {
+          return {genMul(builder, loc, values[0], element)};
+        } else {
+          // NaN elements are skipped, as in the runtime.
+          constexpr auto extremum = reduction == Reduction::Maxval
+                                        ? Extremum::Max
+                                        : Extremum::Min;
+          auto isNext =
+              createExtremumCompare<extremum, ExtremumBehavior::MinMaxss>(
+                  loc, builder, element, values[0]);
+          return {
+              builder.create<mlir::SelectOp>(loc, isNext, element, values[0])};
+        }
+      });
+  return result[0];
+}
+
+// TRANSPOSE
+fir::ExtendedValue
+IntrinsicLibrary::genTranspose(mlir::Type,
+                               llvm::ArrayRef<fir::ExtendedValue> args) {
+  assert(args.size() == 1);
+  const auto *matrix = getInlinableArray(args[0]);
+  if (!matrix || matrix->getExtents().size() != 2)
+    return declineExpansion();
+  const auto &extents = matrix->getExtents();
+  llvm::SmallVector<mlir::Value> resultExtents{extents[1], extents[0]};
+  auto result = genArrayTemp(getArrayElementType(*matrix), resultExtents);
+  if (!result)
+    return declineExpansion();
+  auto resultShape = genShape(resultExtents);
+  auto shape = genShape(extents);
+  genArrayLoops(
+      extents, {},
+      [&](llvm::ArrayRef<mlir::Value> indices, llvm::ArrayRef<mlir::Value>) {
+        auto element = builder.create<fir::LoadOp>(
+            loc, genElementAddr(matrix->getAddr(), shape, indices));
+        builder.create<fir::StoreOp>(
+            loc, element,
+            genElementAddr(result, resultShape, {indices[1], indices[0]}));
+        return llvm::SmallVector<mlir::Value>{};
+      });
+  return fir::ArrayBoxValue{result, resultExtents};
+}
+
 //===----------------------------------------------------------------------===//
 // Public intrinsic call helpers
 //===----------------------------------------------------------------------===//
 
-fir::ExtendedValue
-Fortran::lower::genIntrinsicCall(Fortran::lower::FirOpBuilder &builder,
-                                 mlir::Location loc, llvm::StringRef name,
-                                 mlir::Type resultType,
-                                 llvm::ArrayRef<fir::ExtendedValue> args) {
-  return IntrinsicLibrary{builder, loc}.genIntrinsicCall(name, resultType,
-                                                         args);
+fir::ExtendedValue Fortran::lower::genIntrinsicCall(
+    Fortran::lower::FirOpBuilder &builder, mlir::Location loc,
+    llvm::StringRef name, mlir::Type resultType,
+    llvm::ArrayRef<fir::ExtendedValue> args) {
+  IntrinsicLibrary library{builder, loc};
+  return library.genIntrinsicCall(name, resultType, args);
 }
 
 mlir::Value Fortran::lower::genMax(Fortran::lower::FirOpBuilder &builder,
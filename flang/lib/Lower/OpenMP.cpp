@@ -18,8 +18,14 @@
 #include "flang/Lower/Support/BoxValue.h"
 #include "flang/Lower/Todo.h"
 #include "flang/Parser/parse-tree.h"
+#include "flang/Parser/tools.h"
 #include "flang/Semantics/tools.h"
+#include "mlir/Analysis/SliceAnalysis.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/OpenMP/OpenMPDialect.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Frontend/OpenMP/OMPConstants.h"
 
 static const Fortran::parser::Name *
@@ -48,6 +54,24 @@ static void genObjectList(const Fortran::parser::OmpObjectList &objectList,
   }
 }
 
+/// Collect the symbols of the variables named in an object list.
+static void
+genObjectSymbols(const Fortran::parser::OmpObjectList &objectList,
+                 SmallVectorImpl<const Fortran::semantics::Symbol *> &symbols) {
+  for (const auto &ompObject : objectList.v) {
+    std::visit(
+        Fortran::common::visitors{
+            [&](const Fortran::parser::Designator &designator) {
+              if (const auto *name = getDesignatorNameIfDataRef(designator))
+                symbols.push_back(name->symbol);
+            },
+            [&](const Fortran::parser::Name &name) {
+              symbols.push_back(name.symbol);
+            }},
+        ompObject.u);
+  }
+}
+
 template <typename Op>
 static void createBodyOfOp(Op &op, Fortran::lower::FirOpBuilder &firOpBuilder,
                            mlir::Location &loc) {
@@ -247,6 +271,944 @@ genOMP(Fortran::lower::AbstractConverter &converter,
   }
 }
 
+/// Create an `omp.parallel` operation for the IF and NUM_THREADS clauses of a
+/// combined construct. The other clauses apply to the nested construct.
+static void genCombinedParallelOp(
+    Fortran::lower::AbstractConverter &converter,
+    const Fortran::parser::OmpClauseList &clauseList) {
+  auto &firOpBuilder = converter.getFirOpBuilder();
+  auto currentLocation = converter.getCurrentLocation();
+  mlir::Value ifClauseOperand, numThreadsClauseOperand;
+  for (const auto &clause : clauseList.v) {
+    if (const auto &ifClause =
+            std::get_if<Fortran::parser::OmpClause::If>(&clause.u)) {
+      auto &expr = std::get<Fortran::parser::ScalarLogicalExpr>(ifClause->v.t);
+      ifClauseOperand = fir::getBase(
+          converter.genExprValue(*Fortran::semantics::GetExpr(expr)));
+    } else if (const auto &numThreadsClause =
+                   std::get_if<Fortran::parser::OmpClause::NumThreads>(
+                       &clause.u)) {
+      numThreadsClauseOperand = fir::getBase(converter.genExprValue(
+          *Fortran::semantics::GetExpr(numThreadsClause->v)));
+    }
+  }
+  llvm::ArrayRef<mlir::Type> argTy;
+  auto parallelOp = firOpBuilder.create<mlir::omp::ParallelOp>(
+      currentLocation, argTy, ifClauseOperand, numThreadsClauseOperand,
+      /*default_val=*/nullptr, mlir::ValueRange(), mlir::ValueRange(),
+      mlir::ValueRange(), mlir::ValueRange(), mlir::ValueRange(),
+      mlir::ValueRange(), /*proc_bind_val=*/nullptr);
+  createBodyOfOp<omp::ParallelOp>(parallelOp, firOpBuilder, currentLocation);
+}
+
+/// Block in which the private copies of the variables of a loop construct are
+/// allocated: the entry block of the innermost enclosing parallel region, so
+/// that each thread has its own copies, or of the function if there is none.
+static mlir::Block *
+getPrivateCopyBlock(Fortran::lower::FirOpBuilder &firOpBuilder) {
+  auto *op = firOpBuilder.getBlock()->getParentOp();
+  auto parallelOp = mlir::dyn_cast<mlir::omp::ParallelOp>(op);
+  if (!parallelOp)
+    parallelOp = op->getParentOfType<mlir::omp::ParallelOp>();
+  return parallelOp ? &parallelOp.getRegion().front()
+                    : firOpBuilder.getEntryBlock();
+}
+
+//===----------------------------------------------------------------------===//
+// Reductions
+//===----------------------------------------------------------------------===//
+
+namespace {
+enum class ReductionKind {
+  Add,
+  Multiply,
+  Max,
+  Min,
+  IAnd,
+  IOr,
+  IEor,
+  And,
+  Or,
+  Eqv,
+  Neqv
+};
+} // namespace
+
+static llvm::Optional<ReductionKind>
+getReductionKind(const Fortran::parser::OmpReductionOperator &redOperator) {
+  using IntrinsicOperator =
+      Fortran::parser::DefinedOperator::IntrinsicOperator;
+  if (const auto *definedOperator =
+          std::get_if<Fortran::parser::DefinedOperator>(&redOperator.u)) {
+    const auto *intrinsicOp =
+        std::get_if<IntrinsicOperator>(&definedOperator->u);
+    if (!intrinsicOp)
+      return llvm::None;
+    switch (*intrinsicOp) {
+    case IntrinsicOperator::Add:
+    case IntrinsicOperator::Subtract:
+      // The partial results of a `-` reduction are added.
+      return ReductionKind::Add;
+    case IntrinsicOperator::Multiply:
+      return ReductionKind::Multiply;
+    case IntrinsicOperator::AND:
+      return ReductionKind::And;
+    case IntrinsicOperator::OR:
+      return ReductionKind::Or;
+    case IntrinsicOperator::EQV:
+      return ReductionKind::Eqv;
+    case IntrinsicOperator::NEQV:
+      return ReductionKind::Neqv;
+    default:
+      return llvm::None;
+    }
+  }
+  const auto &procDesignator =
+      std::get<Fortran::parser::ProcedureDesignator>(redOperator.u);
+  const auto *name = std::get_if<Fortran::parser::Name>(&procDesignator.u);
+  if (!name)
+    return llvm::None;
+  return llvm::StringSwitch<llvm::Optional<ReductionKind>>(name->ToString())
+      .Case("max", ReductionKind::Max)
+      .Case("min", ReductionKind::Min)
+      .Case("iand", ReductionKind::IAnd)
+      .Case("ior", ReductionKind::IOr)
+      .Case("ieor", ReductionKind::IEor)
+      .Default(llvm::None);
+}
+
+static bool isLogicalReduction(ReductionKind kind) {
+  return kind == ReductionKind::And || kind == ReductionKind::Or ||
+         kind == ReductionKind::Eqv || kind == ReductionKind::Neqv;
+}
+
+/// Is a reduction of kind `kind` over values of type `type` supported?
+static bool isSupportedReduction(ReductionKind kind, mlir::Type type) {
+  if (isLogicalReduction(kind))
+    return type.isa<fir::LogicalType>();
+  if (kind == ReductionKind::IAnd || kind == ReductionKind::IOr ||
+      kind == ReductionKind::IEor)
+    return type.isa<mlir::IntegerType>();
+  return type.isa<mlir::IntegerType, mlir::FloatType>();
+}
+
+/// Name of the reduction declaration for `kind` and `type`, such as
+/// `add_reduction_i32`.
+static std::string getReductionName(ReductionKind kind, mlir::Type type) {
+  static constexpr const char *prefixes[] = {"add", "multiply", "max", "min",
+                                             "iand", "ior", "ieor", "and",
+                                             "or", "eqv", "neqv"};
+  std::string name = prefixes[static_cast<int>(kind)];
+  name += "_reduction_";
+  if (auto logicalTy = type.dyn_cast<fir::LogicalType>())
+    name += "l" + std::to_string(logicalTy.getFKind());
+  else if (auto floatTy = type.dyn_cast<mlir::FloatType>())
+    name += "f" + std::to_string(floatTy.getWidth());
+  else
+    name += "i" + std::to_string(type.getIntOrFloatBitWidth());
+  return name;
+}
+
+/// Generate the identity value of a reduction, which initializes the private
+/// copies of the reduction variable.
+static mlir::Value genReductionIdentity(Fortran::lower::FirOpBuilder &builder,
+                                        mlir::Location loc, ReductionKind kind,
+                                        mlir::Type type) {
+  if (isLogicalReduction(kind)) {
+    bool value = kind == ReductionKind::And || kind == ReductionKind::Eqv;
+    auto i1 = builder.createIntegerConstant(loc, builder.getI1Type(), value);
+    return builder.createConvert(loc, type, i1);
+  }
+  if (auto intTy = type.dyn_cast<mlir::IntegerType>()) {
+    auto width = intTy.getWidth();
+    std::int64_t value = 0;
+    switch (kind) {
+    case ReductionKind::Multiply:
+      value = 1;
+      break;
+    case ReductionKind::Max:
+      value = llvm::APInt::getSignedMinValue(width).getSExtValue();
+      break;
+    case ReductionKind::Min:
+      value = llvm::APInt::getSignedMaxValue(width).getSExtValue();
+      break;
+    case ReductionKind::IAnd:
+      value = -1;
+      break;
+    default:
+      break;
+    }
+    return builder.createIntegerConstant(loc, type, value);
+  }
+  const auto &semantics = type.cast<mlir::FloatType>().getFloatSemantics();
+  switch (kind) {
+  case ReductionKind::Multiply:
+    return builder.createRealConstant(loc, type, llvm::APFloat(semantics, 1));
+  case ReductionKind::Max:
+    return builder.createRealConstant(
+        loc, type, llvm::APFloat::getLargest(semantics, /*Negative=*/true));
+  case ReductionKind::Min:
+    return builder.createRealConstant(
+        loc, type, llvm::APFloat::getLargest(semantics, /*Negative=*/false));
+  default:
+    return builder.createRealZeroConstant(loc, type);
+  }
+}
+
+/// Generate the combination of two partial results `x` and `y` of a
+/// reduction.
+static mlir::Value genReductionCombiner(Fortran::lower::FirOpBuilder &builder,
+                                        mlir::Location loc, ReductionKind kind,
+                                        mlir::Value x, mlir::Value y) {
+  auto type = x.getType();
+  if (isLogicalReduction(kind)) {
+    auto i1 = builder.getI1Type();
+    auto lhs = builder.createConvert(loc, i1, x);
+    auto rhs = builder.createConvert(loc, i1, y);
+    mlir::Value result;
+    if (kind == ReductionKind::And)
+      result = builder.create<mlir::arith::AndIOp>(loc, lhs, rhs);
+    else if (kind == ReductionKind::Or)
+      result = builder.create<mlir::arith::OrIOp>(loc, lhs, rhs);
+    else
+      result = builder.create<mlir::arith::CmpIOp>(
+          loc,
+          kind == ReductionKind::Eqv ? mlir::arith::CmpIPredicate::eq
+                                     : mlir::arith::CmpIPredicate::ne,
+          lhs, rhs);
+    return builder.createConvert(loc, type, result);
+  }
+  bool isInteger = type.isa<mlir::IntegerType>();
+  switch (kind) {
+  case ReductionKind::Add:
+    if (isInteger)
+      return builder.create<mlir::arith::AddIOp>(loc, x, y);
+    return builder.create<mlir::arith::AddFOp>(loc, x, y);
+  case ReductionKind::Multiply:
+    if (isInteger)
+      return builder.create<mlir::arith::MulIOp>(loc, x, y);
+    return builder.create<mlir::arith::MulFOp>(loc, x, y);
+  case ReductionKind::IAnd:
+    return builder.create<mlir::arith::AndIOp>(loc, x, y);
+  case ReductionKind::IOr:
+    return builder.create<mlir::arith::OrIOp>(loc, x, y);
+  case ReductionKind::IEor:
+    return builder.create<mlir::arith::XOrIOp>(loc, x, y);
+  default:
+    break;
+  }
+  bool isMax = kind == ReductionKind::Max;
+  mlir::Value cmp;
+  if (isInteger)
+    cmp = builder.create<mlir::arith::CmpIOp>(
+        loc,
+        isMax ? mlir::arith::CmpIPredicate::sgt
+              : mlir::arith::CmpIPredicate::slt,
+        x, y);
+  else
+    cmp = builder.create<mlir::arith::CmpFOp>(
+        loc,
+        isMax ? mlir::arith::CmpFPredicate::OGT
+              : mlir::arith::CmpFPredicate::OLT,
+        x, y);
+  return builder.create<mlir::SelectOp>(loc, cmp, x, y);
+}
+
+/// Get the `omp.reduction.declare` operation for `kind` and `type`, creating
+/// it in the module the first time it is needed.
+static mlir::omp::ReductionDeclareOp
+genReductionDeclare(Fortran::lower::AbstractConverter &converter,
+                    mlir::Location loc, ReductionKind kind, mlir::Type type) {
+  auto &firOpBuilder = converter.getFirOpBuilder();
+  auto module = converter.getModuleOp();
+  auto name = getReductionName(kind, type);
+  if (auto decl = module.lookupSymbol<mlir::omp::ReductionDeclareOp>(name))
+    return decl;
+  auto insertPt = firOpBuilder.saveInsertionPoint();
+  firOpBuilder.setInsertionPointToStart(module.getBody());
+  auto decl =
+      firOpBuilder.create<mlir::omp::ReductionDeclareOp>(loc, name, type);
+  firOpBuilder.createBlock(&decl.initializerRegion(), {},
+                           llvm::ArrayRef<mlir::Type>{type});
+  firOpBuilder.create<mlir::omp::YieldOp>(
+      loc, genReductionIdentity(firOpBuilder, loc, kind, type));
+  auto *combiner = firOpBuilder.createBlock(
+      &decl.reductionRegion(), {}, llvm::ArrayRef<mlir::Type>{type, type});
+  firOpBuilder.create<mlir::omp::YieldOp>(
+      loc, genReductionCombiner(firOpBuilder, loc, kind,
+                                combiner->getArgument(0),
+                                combiner->getArgument(1)));
+  firOpBuilder.restoreInsertionPoint(insertPt);
+  return decl;
+}
+
+/// Collect the accumulators of a REDUCTION clause and the symbols of their
+/// reduction declarations.
+static void
+genReductionVars(Fortran::lower::AbstractConverter &converter,
+                 const Fortran::parser::OmpReductionClause &reductionClause,
+                 llvm::SmallVectorImpl<mlir::Value> &reductionVars,
+                 llvm::SmallVectorImpl<mlir::Attribute> &reductionDecls) {
+  auto currentLocation = converter.getCurrentLocation();
+  const auto &redOperator =
+      std::get<Fortran::parser::OmpReductionOperator>(reductionClause.t);
+  auto kind = getReductionKind(redOperator);
+  if (!kind)
+    TODO(currentLocation, "OpenMP reduction operator");
+  llvm::SmallVector<mlir::Value> accumulators;
+  genObjectList(std::get<Fortran::parser::OmpObjectList>(reductionClause.t),
+                converter, accumulators);
+  for (auto accumulator : accumulators) {
+    auto type = fir::dyn_cast_ptrEleTy(accumulator.getType());
+    if (!type || !isSupportedReduction(*kind, type))
+      TODO(currentLocation, "OpenMP reduction on a variable of this type");
+    auto decl = genReductionDeclare(converter, currentLocation, *kind, type);
+    reductionVars.push_back(accumulator);
+    reductionDecls.push_back(
+        mlir::SymbolRefAttr::get(converter.getFirOpBuilder().getContext(),
+                                 decl.sym_name()));
+  }
+}
+
+/// Find the store of an update `x = x op expr` of the accumulator `x` of a
+/// reduction, starting from the load of `x`. Returns a null store if the uses
+/// of the load are not such an update.
+static fir::StoreOp matchReductionUpdate(fir::LoadOp load,
+                                         mlir::Value accumulator) {
+  llvm::SetVector<mlir::Operation *> slice;
+  mlir::getForwardSlice(load.getOperation(), &slice);
+  fir::StoreOp update;
+  for (auto *op : slice) {
+    if (auto store = mlir::dyn_cast<fir::StoreOp>(op)) {
+      auto *def = store.value().getDefiningOp();
+      if (update || store.memref() != accumulator ||
+          store->getBlock() != load->getBlock() ||
+          (def != load.getOperation() && !slice.contains(def)))
+        return {};
+      update = store;
+    } else if (!mlir::wouldOpBeTriviallyDead(op)) {
+      return {};
+    }
+  }
+  return update;
+}
+
+/// Generate the identity of the reduction declared by `decl`, for a value
+/// like `mold`.
+static mlir::Value genReductionIdentity(Fortran::lower::FirOpBuilder &builder,
+                                        mlir::omp::ReductionDeclareOp decl,
+                                        mlir::Value mold) {
+  mlir::BlockAndValueMapping mapping;
+  auto &init = decl.initializerRegion().front();
+  mapping.map(init.getArgument(0), mold);
+  for (auto &op : init.without_terminator())
+    builder.clone(op, mapping);
+  return mapping.lookupOrDefault(
+      mlir::cast<mlir::omp::YieldOp>(init.getTerminator()).results()[0]);
+}
+
+/// Rewrite the update `x = x op expr` of the accumulator `x` of a reduction,
+/// from its load to its store `update`, into the contribution
+/// `op(identity, expr)` of the current iteration.
+static void genReductionUpdate(Fortran::lower::FirOpBuilder &builder,
+                               fir::LoadOp load, fir::StoreOp update,
+                               mlir::Value accumulator,
+                               mlir::omp::ReductionDeclareOp decl) {
+  builder.setInsertionPoint(load);
+  load.getResult().replaceAllUsesWith(
+      genReductionIdentity(builder, decl, load.getResult()));
+  load.erase();
+  builder.setInsertionPoint(update);
+  builder.create<mlir::omp::ReductionOp>(update.getLoc(), update.value(),
+                                         accumulator);
+  update.erase();
+}
+
+/// Replace the accumulator of a reduction by a private copy in the uses
+/// `users` in the body of `wsLoopOp`. The copy is initialized with the
+/// identity of the reduction at the start of each iteration and its value is
+/// contributed to the reduction at the end, where the builder is. This
+/// supports any reference to the accumulator in the body.
+static void genPrivateReduction(Fortran::lower::FirOpBuilder &builder,
+                                mlir::omp::WsLoopOp wsLoopOp,
+                                mlir::Value accumulator,
+                                mlir::omp::ReductionDeclareOp decl,
+                                llvm::ArrayRef<mlir::Operation *> users) {
+  auto loc = wsLoopOp.getLoc();
+  auto type = fir::dyn_cast_ptrEleTy(accumulator.getType());
+  auto insertPt = builder.saveInsertionPoint();
+  builder.setInsertionPointToStart(getPrivateCopyBlock(builder));
+  auto copy = builder.create<fir::AllocaOp>(loc, type, llvm::StringRef{},
+                                            llvm::StringRef{});
+  for (auto *user : users)
+    user->replaceUsesOfWith(accumulator, copy);
+  builder.setInsertionPointToStart(&wsLoopOp.getRegion().front());
+  builder.create<fir::StoreOp>(
+      loc,
+      genReductionIdentity(builder, decl,
+                           builder.create<fir::UndefOp>(loc, type)),
+      copy);
+  builder.restoreInsertionPoint(insertPt);
+  builder.create<mlir::omp::ReductionOp>(
+      loc, builder.create<fir::LoadOp>(loc, copy), accumulator);
+}
+
+//===----------------------------------------------------------------------===//
+// Loop constructs
+//===----------------------------------------------------------------------===//
+
+/// Types of the variables that a loop construct can privatize: their private
+/// copies are initialized and copied back with a load and a store.
+static bool isPrivatizableType(mlir::Type type) {
+  return fir::isa_integer(type) || fir::isa_real(type) ||
+         fir::isa_complex(type) || type.isa<fir::LogicalType>();
+}
+
+/// Allocate the private copy of the variable at `original` for the symbol
+/// `sym`, and bind the symbol to it. With `copyIn`, the copy is initialized
+/// with the value of the variable at the insertion point.
+static mlir::Value genPrivateCopy(Fortran::lower::AbstractConverter &converter,
+                                  const Fortran::semantics::Symbol &sym,
+                                  mlir::Value original, bool copyIn) {
+  auto &firOpBuilder = converter.getFirOpBuilder();
+  auto currentLocation = converter.getCurrentLocation();
+  auto type = fir::dyn_cast_ptrEleTy(original.getType());
+  if (!type || !isPrivatizableType(type))
+    TODO(currentLocation, "OpenMP privatization of a non scalar variable");
+  auto insertPt = firOpBuilder.saveInsertionPoint();
+  firOpBuilder.setInsertionPointToStart(getPrivateCopyBlock(firOpBuilder));
+  auto copy = firOpBuilder.create<fir::AllocaOp>(
+      currentLocation, type, llvm::StringRef{}, sym.name().ToString());
+  firOpBuilder.restoreInsertionPoint(insertPt);
+  if (copyIn)
+    firOpBuilder.create<fir::StoreOp>(
+        currentLocation,
+        firOpBuilder.create<fir::LoadOp>(currentLocation, original), copy);
+  converter.bindSymbol(sym, copy);
+  return copy;
+}
+
+std::int64_t Fortran::lower::getCollapseValue(
+    const Fortran::parser::OmpClauseList &clauseList) {
+  for (const auto &clause : clauseList.v)
+    if (const auto &collapseClause =
+            std::get_if<Fortran::parser::OmpClause::Collapse>(&clause.u))
+      if (auto value = Fortran::semantics::GetIntValue(collapseClause->v))
+        return *value;
+  return 1;
+}
+
+static void
+genOMP(Fortran::lower::AbstractConverter &converter,
+       Fortran::lower::pft::Evaluation &eval,
+       const Fortran::parser::OpenMPLoopConstruct &loopConstruct) {
+  const auto &beginLoopDirective =
+      std::get<Fortran::parser::OmpBeginLoopDirective>(loopConstruct.t);
+  const auto &loopDirective =
+      std::get<Fortran::parser::OmpLoopDirective>(beginLoopDirective.t);
+  const auto &wsLoopOpClauseList =
+      std::get<Fortran::parser::OmpClauseList>(beginLoopDirective.t);
+  auto &firOpBuilder = converter.getFirOpBuilder();
+  auto currentLocation = converter.getCurrentLocation();
+  // A SIMD loop remains a DO loop, annotated by genOpenMPLoopAnnotation.
+  if (loopDirective.v == llvm::omp::OMPD_simd)
+    return;
+  // The SIMD part of a combined construct allows, but does not require,
+  // vectorizing the chunks of the worksharing loop.
+  bool isParallel = loopDirective.v == llvm::omp::OMPD_parallel_do ||
+                    loopDirective.v == llvm::omp::OMPD_parallel_do_simd;
+  if (!isParallel && loopDirective.v != llvm::omp::OMPD_do &&
+      loopDirective.v != llvm::omp::OMPD_do_simd)
+    TODO(currentLocation, "OpenMPLoopConstruct");
+  const auto &doConstruct =
+      std::get<std::optional<Fortran::parser::DoConstruct>>(loopConstruct.t);
+  assert(doConstruct && "loop construct without DO loop");
+
+  // Collect the bounds of the associated loops. The iteration space is
+  // computed in the widest type of their induction variables.
+  llvm::SmallVector<mlir::Value> lowerBound, upperBound, step;
+  llvm::SmallVector<const Fortran::semantics::Symbol *> ivs;
+  mlir::Type loopVarType;
+  const auto *loop = &*doConstruct;
+  for (auto collapseValue = Fortran::lower::getCollapseValue(
+           wsLoopOpClauseList);
+       ; --collapseValue) {
+    if (!loop || !loop->IsDoNormal())
+      TODO(currentLocation, "OpenMP loop construct without counted DO loops");
+    const auto &bounds =
+        std::get<Fortran::parser::LoopControl::Bounds>(
+            loop->GetLoopControl()->u);
+    const auto *iv = bounds.name.thing.symbol;
+    auto ivType = converter.genType(*iv);
+    if (!loopVarType ||
+        ivType.getIntOrFloatBitWidth() > loopVarType.getIntOrFloatBitWidth())
+      loopVarType = ivType;
+    ivs.push_back(iv);
+    lowerBound.push_back(fir::getBase(
+        converter.genExprValue(*Fortran::semantics::GetExpr(bounds.lower))));
+    upperBound.push_back(fir::getBase(
+        converter.genExprValue(*Fortran::semantics::GetExpr(bounds.upper))));
+    if (bounds.step)
+      step.push_back(fir::getBase(
+          converter.genExprValue(*Fortran::semantics::GetExpr(*bounds.step))));
+    else
+      step.push_back(
+          firOpBuilder.createIntegerConstant(currentLocation, ivType, 1));
+    if (collapseValue <= 1)
+      break;
+    // The next collapsed loop is the first construct of the body.
+    const auto &body = std::get<Fortran::parser::Block>(loop->t);
+    loop = body.empty()
+               ? nullptr
+               : Fortran::parser::Unwrap<Fortran::parser::DoConstruct>(
+                     body.front());
+  }
+  for (auto *bounds : {&lowerBound, &upperBound, &step})
+    for (auto &value : *bounds)
+      value = firOpBuilder.createConvert(currentLocation, loopVarType, value);
+
+  if (isParallel)
+    genCombinedParallelOp(converter, wsLoopOpClauseList);
+
+  llvm::SmallVector<const Fortran::semantics::Symbol *> privateSymbols,
+      firstprivateSymbols, lastprivateSymbols;
+  llvm::SmallVector<mlir::Value> reductionVars;
+  llvm::SmallVector<mlir::Attribute> reductionDecls;
+  mlir::Value scheduleChunkClauseOperand;
+  mlir::StringAttr scheduleClauseOperand;
+  mlir::IntegerAttr collapseClauseOperand, orderedClauseOperand;
+  mlir::UnitAttr nowaitClauseOperand;
+  for (const auto &clause : wsLoopOpClauseList.v) {
+    if (const auto &privateClause =
+            std::get_if<Fortran::parser::OmpClause::Private>(&clause.u)) {
+      genObjectSymbols(privateClause->v, privateSymbols);
+    } else if (const auto &firstprivateClause =
+                   std::get_if<Fortran::parser::OmpClause::Firstprivate>(
+                       &clause.u)) {
+      genObjectSymbols(firstprivateClause->v, firstprivateSymbols);
+    } else if (const auto &lastprivateClause =
+                   std::get_if<Fortran::parser::OmpClause::Lastprivate>(
+                       &clause.u)) {
+      genObjectSymbols(lastprivateClause->v, lastprivateSymbols);
+    } else if (const auto &reductionClause =
+                   std::get_if<Fortran::parser::OmpClause::Reduction>(
+                       &clause.u)) {
+      genReductionVars(converter, reductionClause->v, reductionVars,
+                       reductionDecls);
+    } else if (const auto &scheduleClause =
+                   std::get_if<Fortran::parser::OmpClause::Schedule>(
+                       &clause.u)) {
+      const auto &ompScheduleClause = scheduleClause->v;
+      using ScheduleType = Fortran::parser::OmpScheduleClause::ScheduleType;
+      omp::ClauseScheduleKind scheduleKind = omp::ClauseScheduleKind::Static;
+      switch (std::get<ScheduleType>(ompScheduleClause.t)) {
+      case ScheduleType::Static:
+        scheduleKind = omp::ClauseScheduleKind::Static;
+        break;
+      case ScheduleType::Dynamic:
+        scheduleKind = omp::ClauseScheduleKind::Dynamic;
+        break;
+      case ScheduleType::Guided:
+        scheduleKind = omp::ClauseScheduleKind::Guided;
+        break;
+      case ScheduleType::Auto:
+        scheduleKind = omp::ClauseScheduleKind::Auto;
+        break;
+      case ScheduleType::Runtime:
+        scheduleKind = omp::ClauseScheduleKind::Runtime;
+        break;
+      }
+      scheduleClauseOperand = firOpBuilder.getStringAttr(
+          omp::stringifyClauseScheduleKind(scheduleKind));
+      if (const auto &chunkExpr =
+              std::get<std::optional<Fortran::parser::ScalarIntExpr>>(
+                  ompScheduleClause.t))
+        scheduleChunkClauseOperand = firOpBuilder.createConvert(
+            currentLocation, loopVarType,
+            fir::getBase(converter.genExprValue(
+                *Fortran::semantics::GetExpr(*chunkExpr))));
+    } else if (std::get_if<Fortran::parser::OmpClause::Collapse>(&clause.u)) {
+      collapseClauseOperand = firOpBuilder.getI64IntegerAttr(ivs.size());
+    } else if (const auto &orderedClause =
+                   std::get_if<Fortran::parser::OmpClause::Ordered>(
+                       &clause.u)) {
+      orderedClauseOperand = firOpBuilder.getI64IntegerAttr(
+          orderedClause->v
+              ? Fortran::semantics::GetIntValue(*orderedClause->v).value_or(0)
+              : 0);
+    }
+  }
+  // In Fortran, NOWAIT is a clause of the END DO directive.
+  if (const auto &endLoopDirective =
+          std::get<std::optional<Fortran::parser::OmpEndLoopDirective>>(
+              loopConstruct.t))
+    for (const auto &clause :
+         std::get<Fortran::parser::OmpClauseList>(endLoopDirective->t).v)
+      if (std::get_if<Fortran::parser::OmpClause::Nowait>(&clause.u))
+        nowaitClauseOperand = firOpBuilder.getUnitAttr();
+
+  // The loop variables and the variables of the PRIVATE, FIRSTPRIVATE and
+  // LASTPRIVATE clauses are privatized here: the translation of omp.wsloop
+  // to LLVM IR ignores its privatization operands. The symbols are bound to
+  // their private copies until genOpenMPLoopEnd.
+  converter.pushSymbolScope();
+  llvm::SmallVector<const Fortran::semantics::Symbol *> privatized;
+  for (const auto &symbols :
+       {llvm::makeArrayRef(ivs), llvm::makeArrayRef(privateSymbols),
+        llvm::makeArrayRef(firstprivateSymbols),
+        llvm::makeArrayRef(lastprivateSymbols)})
+    for (const auto *sym : symbols)
+      if (!llvm::is_contained(privatized, sym))
+        privatized.push_back(sym);
+  llvm::SmallVector<mlir::Value> ivAddrs;
+  llvm::SmallVector<std::pair<mlir::Value, mlir::Value>> lastprivates;
+  for (const auto *sym : privatized) {
+    auto original = converter.getSymbolAddress(*sym);
+    auto copy =
+        genPrivateCopy(converter, *sym, original,
+                       llvm::is_contained(firstprivateSymbols, sym));
+    if (llvm::is_contained(lastprivateSymbols, sym))
+      lastprivates.emplace_back(original, copy);
+  }
+  for (const auto *iv : ivs)
+    ivAddrs.push_back(converter.getSymbolAddress(*iv));
+
+  // The value of each loop variable in the last iteration, which is not the
+  // upper bound when the step does not divide the iteration space.
+  llvm::SmallVector<mlir::Value> lastValues;
+  if (!lastprivates.empty())
+    for (auto bounds : llvm::zip(lowerBound, upperBound, step)) {
+      auto tripCount = firOpBuilder.create<mlir::arith::DivSIOp>(
+          currentLocation,
+          firOpBuilder.create<mlir::arith::SubIOp>(
+              currentLocation, std::get<1>(bounds), std::get<0>(bounds)),
+          std::get<2>(bounds));
+      lastValues.push_back(firOpBuilder.create<mlir::arith::AddIOp>(
+          currentLocation, std::get<0>(bounds),
+          firOpBuilder.create<mlir::arith::MulIOp>(
+              currentLocation, tripCount, std::get<2>(bounds))));
+    }
+
+  // Fortran DO loops include their upper bound.
+  llvm::ArrayRef<mlir::Type> argTy;
+  auto wsLoopOp = firOpBuilder.create<mlir::omp::WsLoopOp>(
+      currentLocation, argTy, lowerBound, upperBound, step,
+      /*private_vars=*/mlir::ValueRange(),
+      /*firstprivate_vars=*/mlir::ValueRange(),
+      /*lastprivate_vars=*/mlir::ValueRange(),
+      /*linear_vars=*/mlir::ValueRange(),
+      /*linear_step_vars=*/mlir::ValueRange(), reductionVars,
+      scheduleClauseOperand, scheduleChunkClauseOperand,
+      collapseClauseOperand, nowaitClauseOperand, orderedClauseOperand,
+      /*order_val=*/nullptr, /*inclusive=*/firOpBuilder.getUnitAttr(),
+      /*buildBody=*/false);
+  if (!reductionDecls.empty())
+    wsLoopOp.reductionsAttr(firOpBuilder.getArrayAttr(reductionDecls));
+
+  // The region has one argument per collapsed loop. The body of the innermost
+  // loop reads the loop variables from memory, so store the arguments there.
+  llvm::SmallVector<mlir::Type> ivTypes(ivs.size(), loopVarType);
+  auto *block =
+      firOpBuilder.createBlock(&wsLoopOp.getRegion(), {}, ivTypes);
+  firOpBuilder.create<mlir::omp::YieldOp>(currentLocation, mlir::ValueRange());
+  firOpBuilder.setInsertionPointToStart(block);
+  for (auto ivAddr : llvm::enumerate(ivAddrs)) {
+    auto value = firOpBuilder.createConvert(
+        currentLocation, fir::dyn_cast_ptrEleTy(ivAddr.value().getType()),
+        block->getArgument(ivAddr.index()));
+    firOpBuilder.create<fir::StoreOp>(currentLocation, value, ivAddr.value());
+  }
+  if (lastprivates.empty())
+    return;
+
+  // The iteration in which every loop variable has its last value copies the
+  // LASTPRIVATE variables out, after the body. A LASTPRIVATE loop variable
+  // gets the value it has after the sequential loop, one step past the last.
+  mlir::Value isLast;
+  for (auto last : llvm::enumerate(lastValues)) {
+    auto cmp = firOpBuilder.create<mlir::arith::CmpIOp>(
+        currentLocation, mlir::arith::CmpIPredicate::eq,
+        block->getArgument(last.index()), last.value());
+    isLast = isLast ? firOpBuilder.create<mlir::arith::AndIOp>(
+                          currentLocation, isLast, cmp)
+                    : cmp.getResult();
+  }
+  auto ifOp = firOpBuilder.create<fir::IfOp>(currentLocation, isLast,
+                                             /*withOtherwise=*/false);
+  firOpBuilder.setInsertionPointToStart(&ifOp.thenRegion().front());
+  for (auto [original, copy] : lastprivates) {
+    mlir::Value value;
+    const auto *iv = llvm::find(ivAddrs, copy);
+    if (iv != ivAddrs.end()) {
+      auto dim = iv - ivAddrs.begin();
+      value = firOpBuilder.createConvert(
+          currentLocation, fir::dyn_cast_ptrEleTy(copy.getType()),
+          firOpBuilder.create<mlir::arith::AddIOp>(
+              currentLocation, lastValues[dim], step[dim]));
+    } else {
+      value = firOpBuilder.create<fir::LoadOp>(currentLocation, copy);
+    }
+    firOpBuilder.create<fir::StoreOp>(currentLocation, value, original);
+  }
+  // The body is lowered before the copy out.
+  firOpBuilder.setInsertionPoint(ifOp);
+}
+
+void Fortran::lower::genOpenMPLoopEnd(
+    Fortran::lower::AbstractConverter &converter) {
+  auto &firOpBuilder = converter.getFirOpBuilder();
+  auto *parentOp = firOpBuilder.getBlock()->getParentOp();
+  auto wsLoopOp = mlir::dyn_cast<mlir::omp::WsLoopOp>(parentOp);
+  if (!wsLoopOp)
+    return;
+  converter.popSymbolScope();
+  if (wsLoopOp.getNumReductionVars() == 0)
+    return;
+  auto insertPt = firOpBuilder.saveInsertionPoint();
+  for (auto reduction :
+       llvm::zip(wsLoopOp.reduction_vars(), *wsLoopOp.reductions())) {
+    auto accumulator = std::get<0>(reduction);
+    auto decl =
+        mlir::SymbolTable::lookupNearestSymbolFrom<
+            mlir::omp::ReductionDeclareOp>(
+            wsLoopOp, std::get<1>(reduction).cast<mlir::SymbolRefAttr>());
+    llvm::SmallVector<mlir::Operation *> users;
+    for (auto *user : accumulator.getUsers())
+      if (wsLoopOp->isProperAncestor(user))
+        users.push_back(user);
+    // The updates `x = x op expr` are rewritten in place when they are the
+    // only references to the accumulator. Otherwise the body works on a
+    // private copy of the accumulator.
+    llvm::SmallVector<std::pair<fir::LoadOp, fir::StoreOp>> updates;
+    llvm::SmallPtrSet<mlir::Operation *, 4> updateStores;
+    bool onlyUpdates = true;
+    for (auto *user : users) {
+      if (auto load = mlir::dyn_cast<fir::LoadOp>(user)) {
+        auto update = matchReductionUpdate(load, accumulator);
+        if (!update || !updateStores.insert(update).second) {
+          onlyUpdates = false;
+          break;
+        }
+        updates.emplace_back(load, update);
+      }
+    }
+    onlyUpdates = onlyUpdates && llvm::all_of(users, [&](auto *user) {
+                    return mlir::isa<fir::LoadOp>(user) ||
+                           updateStores.contains(user);
+                  });
+    if (onlyUpdates) {
+      for (auto [load, update] : updates)
+        genReductionUpdate(firOpBuilder, load, update, accumulator, decl);
+    } else {
+      firOpBuilder.restoreInsertionPoint(insertPt);
+      genPrivateReduction(firOpBuilder, wsLoopOp, accumulator, decl, users);
+    }
+  }
+  firOpBuilder.restoreInsertionPoint(insertPt);
+}
+
+//===----------------------------------------------------------------------===//
+// SIMD constructs
+//===----------------------------------------------------------------------===//
+
+static constexpr llvm::StringRef simdMetadataName = "__flang_omp_simd";
+
+/// Create a new access group for the memory accesses of a SIMD loop. The
+/// iterations of a SIMD loop may run concurrently, so no access in this group
+/// depends on an access of another iteration. The access groups are declared
+/// in an `llvm.metadata` operation of the module.
+static mlir::SymbolRefAttr
+genSimdAccessGroup(Fortran::lower::AbstractConverter &converter) {
+  auto &firOpBuilder = converter.getFirOpBuilder();
+  auto currentLocation = converter.getCurrentLocation();
+  auto module = converter.getModuleOp();
+  auto insertPt = firOpBuilder.saveInsertionPoint();
+  auto metadata = module.lookupSymbol<mlir::LLVM::MetadataOp>(simdMetadataName);
+  if (!metadata) {
+    firOpBuilder.setInsertionPointToEnd(module.getBody());
+    metadata = firOpBuilder.create<mlir::LLVM::MetadataOp>(currentLocation,
+                                                           simdMetadataName);
+    firOpBuilder.createBlock(&metadata.body());
+    firOpBuilder.create<mlir::LLVM::ReturnOp>(currentLocation,
+                                              mlir::ValueRange{});
+  }
+  auto &body = metadata.body().front();
+  std::string groupName =
+      "group" + std::to_string(std::distance(body.begin(), body.end()) - 1);
+  firOpBuilder.setInsertionPoint(body.getTerminator());
+  firOpBuilder.create<mlir::LLVM::AccessGroupMetadataOp>(currentLocation,
+                                                         groupName);
+  firOpBuilder.restoreInsertionPoint(insertPt);
+  return mlir::SymbolRefAttr::get(
+      firOpBuilder.getContext(), simdMetadataName,
+      mlir::FlatSymbolRefAttr::get(firOpBuilder.getContext(), groupName));
+}
+
+mlir::Attribute Fortran::lower::genOpenMPLoopAnnotation(
+    Fortran::lower::AbstractConverter &converter,
+    Fortran::lower::pft::Evaluation &doEval) {
+  // Find the construct enclosing the DO loop and the loops around it.
+  std::int64_t depth = 1;
+  auto *construct = doEval.parentConstruct;
+  for (; construct && construct->isA<Fortran::parser::DoConstruct>(); ++depth)
+    construct = construct->parentConstruct;
+  const auto *ompConstruct =
+      construct ? construct->getIf<Fortran::parser::OpenMPConstruct>()
+                : nullptr;
+  const auto *loopConstruct =
+      ompConstruct
+          ? std::get_if<Fortran::parser::OpenMPLoopConstruct>(&ompConstruct->u)
+          : nullptr;
+  if (!loopConstruct)
+    return {};
+  const auto &beginLoopDirective =
+      std::get<Fortran::parser::OmpBeginLoopDirective>(loopConstruct->t);
+  if (std::get<Fortran::parser::OmpLoopDirective>(beginLoopDirective.t).v !=
+      llvm::omp::OMPD_simd)
+    return {};
+  // Only the innermost associated loop is vectorized.
+  const auto &clauseList =
+      std::get<Fortran::parser::OmpClauseList>(beginLoopDirective.t);
+  if (depth != Fortran::lower::getCollapseValue(clauseList))
+    return {};
+
+  // SIMDLEN is the preferred vector length and SAFELEN bounds it.
+  llvm::Optional<std::int64_t> width;
+  for (const auto &clause : clauseList.v) {
+    llvm::Optional<std::int64_t> value;
+    if (const auto &simdlenClause =
+            std::get_if<Fortran::parser::OmpClause::Simdlen>(&clause.u))
+      value = Fortran::semantics::GetIntValue(simdlenClause->v);
+    else if (const auto &safelenClause =
+                 std::get_if<Fortran::parser::OmpClause::Safelen>(&clause.u))
+      value = Fortran::semantics::GetIntValue(safelenClause->v);
+    if (value && (!width || *value < *width))
+      width = value;
+  }
+  mlir::LLVM::LoopOptionsAttrBuilder options;
+  options.setVectorizeEnable(true);
+  if (width)
+    options.setVectorizeWidth(static_cast<std::uint64_t>(*width));
+  auto &firOpBuilder = converter.getFirOpBuilder();
+  mlir::Attribute accessGroup = genSimdAccessGroup(converter);
+  return firOpBuilder.getDictionaryAttr(
+      {firOpBuilder.getNamedAttr(
+           mlir::LLVM::LLVMDialect::getParallelAccessAttrName(),
+           firOpBuilder.getArrayAttr(accessGroup)),
+       firOpBuilder.getNamedAttr(
+           mlir::LLVM::LLVMDialect::getLoopOptionsAttrName(),
+           mlir::LLVM::LoopOptionsAttr::get(firOpBuilder.getContext(),
+                                            options))});
+}
+
+static void genOMP(Fortran::lower::AbstractConverter &converter,
+                   const Fortran::parser::OpenMPDeclareSimdConstruct
+                       &declareSimdConstruct) {
+  // DECLARE SIMD allows, but does not require, the creation of SIMD versions
+  // of the procedure. No variant is created, and calls from SIMD loops stay
+  // scalar calls, so the directive is ignored.
+}
+
+void Fortran::lower::genOpenMPDeclarativeConstruct(
+    Fortran::lower::AbstractConverter &converter,
+    const Fortran::parser::OpenMPDeclarativeConstruct &ompDeclConstruct) {
+  std::visit(
+      Fortran::common::visitors{
+          [&](const Fortran::parser::OpenMPDeclareSimdConstruct
+                  &declareSimdConstruct) {
+            genOMP(converter, declareSimdConstruct);
+          },
+          [&](const auto &) {
+            TODO(converter.getCurrentLocation(),
+                 "OpenMPDeclarativeConstruct");
+          },
+      },
+      ompDeclConstruct.u);
+}
+
+//===----------------------------------------------------------------------===//
+// Synchronization constructs
+//===----------------------------------------------------------------------===//
+
+/// Create an `omp.critical` operation, declaring its name in the module the
+/// first time it is used, and set the insertion point in its body.
+static mlir::omp::CriticalOp
+genCriticalOp(Fortran::lower::AbstractConverter &converter,
+              llvm::StringRef name, std::int64_t hint) {
+  auto &firOpBuilder = converter.getFirOpBuilder();
+  auto currentLocation = converter.getCurrentLocation();
+  mlir::FlatSymbolRefAttr nameAttr;
+  if (!name.empty()) {
+    auto module = converter.getModuleOp();
+    if (!module.lookupSymbol<mlir::omp::CriticalDeclareOp>(name)) {
+      auto insertPt = firOpBuilder.saveInsertionPoint();
+      firOpBuilder.setInsertionPointToStart(module.getBody());
+      firOpBuilder.create<mlir::omp::CriticalDeclareOp>(currentLocation, name);
+      firOpBuilder.restoreInsertionPoint(insertPt);
+    }
+    nameAttr = mlir::FlatSymbolRefAttr::get(firOpBuilder.getContext(), name);
+  }
+  auto criticalOp = firOpBuilder.create<mlir::omp::CriticalOp>(
+      currentLocation, nameAttr, firOpBuilder.getI64IntegerAttr(hint));
+  createBodyOfOp<omp::CriticalOp>(criticalOp, firOpBuilder, currentLocation);
+  return criticalOp;
+}
+
+static void
+genOMP(Fortran::lower::AbstractConverter &converter,
+       Fortran::lower::pft::Evaluation &eval,
+       const Fortran::parser::OpenMPCriticalConstruct &criticalConstruct) {
+  const auto &criticalDirective =
+      std::get<Fortran::parser::OmpCriticalDirective>(criticalConstruct.t);
+  std::string name;
+  if (const auto &criticalName =
+          std::get<std::optional<Fortran::parser::Name>>(criticalDirective.t))
+    name = criticalName->ToString();
+  std::int64_t hint = 0;
+  for (const auto &clause :
+       std::get<Fortran::parser::OmpClauseList>(criticalDirective.t).v)
+    if (const auto &hintClause =
+            std::get_if<Fortran::parser::OmpClause::Hint>(&clause.u))
+      hint = Fortran::semantics::GetIntValue(hintClause->v).value_or(0);
+  genCriticalOp(converter, name, hint);
+}
+
+/// The OpenMP dialect has no atomic operations. An ATOMIC construct is
+/// lowered as a critical section shared by all the ATOMIC constructs of the
+/// program, which provides the required mutual exclusion between them.
+static void
+genOMP(Fortran::lower::AbstractConverter &converter,
+       Fortran::lower::pft::Evaluation &eval,
+       const Fortran::parser::OpenMPAtomicConstruct &atomicConstruct) {
+  const auto *assignmentStmt = std::visit(
+      Fortran::common::visitors{
+          [](const Fortran::parser::OmpAtomicCapture &)
+              -> const Fortran::parser::AssignmentStmt * { return nullptr; },
+          [](const auto &atomic) -> const Fortran::parser::AssignmentStmt * {
+            return &std::get<Fortran::parser::Statement<
+                        Fortran::parser::AssignmentStmt>>(atomic.t)
+                        .statement;
+          }},
+      atomicConstruct.u);
+  auto currentLocation = converter.getCurrentLocation();
+  if (!assignmentStmt)
+    TODO(currentLocation, "OpenMP ATOMIC CAPTURE");
+  auto &firOpBuilder = converter.getFirOpBuilder();
+  auto criticalOp = genCriticalOp(converter, "__omp_atomic", /*hint=*/0);
+  auto addr = converter.genExprAddr(
+      *Fortran::semantics::GetExpr(
+          std::get<Fortran::parser::Variable>(assignmentStmt->t)),
+      &currentLocation);
+  auto value = fir::getBase(converter.genExprValue(
+      *Fortran::semantics::GetExpr(
+          std::get<Fortran::parser::Expr>(assignmentStmt->t)),
+      &currentLocation));
+  value = firOpBuilder.createConvert(
+      currentLocation, fir::dyn_cast_ptrEleTy(addr.getType()), value);
+  firOpBuilder.create<fir::StoreOp>(currentLocation, value, addr);
+  firOpBuilder.setInsertionPointAfter(criticalOp);
+}
+
 void Fortran::lower::genOpenMPConstruct(
     Fortran::lower::AbstractConverter &converter,
     Fortran::lower::pft::Evaluation &eval,
@@ -263,7 +1225,7 @@ void Fortran::lower::genOpenMPConstruct(
             TODO(converter.getCurrentLocation(), "OpenMPSectionsConstruct");
           },
           [&](const Fortran::parser::OpenMPLoopConstruct &loopConstruct) {
-            TODO(converter.getCurrentLocation(), "OpenMPLoopConstruct");
+            genOMP(converter, eval, loopConstruct);
           },
           [&](const Fortran::parser::OpenMPDeclarativeAllocate
                   &execAllocConstruct) {
@@ -277,11 +1239,11 @@ void Fortran::lower::genOpenMPConstruct(
             genOMP(converter, eval, blockConstruct);
           },
           [&](const Fortran::parser::OpenMPAtomicConstruct &atomicConstruct) {
-            TODO(converter.getCurrentLocation(), "OpenMPAtomicConstruct");
+            genOMP(converter, eval, atomicConstruct);
           },
           [&](const Fortran::parser::OpenMPCriticalConstruct
                   &criticalConstruct) {
-            TODO(converter.getCurrentLocation(), "OpenMPCriticalConstruct");
+            genOMP(converter, eval, criticalConstruct);
           },
       },
       ompConstruct.u);
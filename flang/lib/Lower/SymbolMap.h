@@ -18,6 +18,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Compiler.h"
 
@@ -236,7 +237,25 @@ public:
   void erase(semantics::SymbolRef sym) { symbolMap.erase(&*sym); }
 
   /// Remove all symbols from the map.
-  void clear() { symbolMap.clear(); }
+  void clear() {
+    symbolMap.clear();
+    scopes.clear();
+  }
+
+  /// Open a scope. The mappings added or replaced until the matching
+  /// popScope are undone by it.
+  void pushScope() { scopes.emplace_back(); }
+
+  /// Close the innermost scope and restore the mappings it replaced.
+  void popScope() {
+    assert(!scopes.empty() && "no scope to pop");
+    for (auto &saved : llvm::reverse(scopes.back())) {
+      symbolMap.erase(saved.first);
+      if (saved.second)
+        symbolMap.try_emplace(saved.first, saved.second);
+    }
+    scopes.pop_back();
+  }
 
   /// Dump the map. For debugging.
   LLVM_DUMP_METHOD void dump() const;
@@ -245,13 +264,22 @@ private:
   /// Add `symbol` to the current map and bind a `box`.
   void makeSym(semantics::SymbolRef sym, const SymbolBox &box,
                bool force = false) {
-    if (force)
-      erase(sym);
+    auto previous = lookupSymbol(sym);
+    if (previous && !force)
+      return;
+    if (!scopes.empty())
+      scopes.back().emplace_back(&*sym, previous);
+    erase(sym);
     assert(box && "cannot add an undefined symbol box");
     symbolMap.try_emplace(&*sym, box);
   }
 
   llvm::DenseMap<const semantics::Symbol *, SymbolBox> symbolMap;
+  /// For each open scope, the mappings it added or replaced, with the
+  /// previous mapping (undefined if there was none).
+  llvm::SmallVector<
+      llvm::SmallVector<std::pair<const semantics::Symbol *, SymbolBox>>>
+      scopes;
 };
 
 } // namespace Fortran::lower
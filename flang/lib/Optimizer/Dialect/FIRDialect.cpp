@@ -14,9 +14,41 @@
 #include "flang/Optimizer/Dialect/FIRAttr.h"
 #include "flang/Optimizer/Dialect/FIROps.h"
 #include "flang/Optimizer/Dialect/FIRType.h"
+#include "mlir/Transforms/InliningUtils.h"
 
 using namespace fir;
 
+namespace {
+/// This class defines the interface for handling inlining of FIR calls.
+struct FIRInlinerInterface : public mlir::DialectInlinerInterface {
+  using DialectInlinerInterface::DialectInlinerInterface;
+
+  /// Any call may be inlined as far as FIR is concerned. Whether it should be
+  /// is left to the cost model of the inlining pass.
+  bool isLegalToInline(mlir::Operation *call, mlir::Operation *callable,
+                       bool wouldBeCloned) const final {
+    return true;
+  }
+
+  /// The regions of FIR structured operations (fir.do_loop, fir.iterate_while,
+  /// fir.if, ...) must hold exactly one block, as their terminators yield the
+  /// values of the operation. The body of a callee with several blocks would
+  /// be spliced into the region as a CFG, with branches that cannot be
+  /// expressed there, so only single block callees are inlined into them.
+  bool isLegalToInline(mlir::Region *dest, mlir::Region *src,
+                       bool wouldBeCloned,
+                       mlir::BlockAndValueMapping &map) const final {
+    return llvm::hasSingleElement(*src);
+  }
+
+  bool isLegalToInline(mlir::Operation *op, mlir::Region *reg,
+                       bool wouldBeCloned,
+                       mlir::BlockAndValueMapping &map) const final {
+    return fir::canLegallyInline(op, reg, map);
+  }
+};
+} // namespace
+
 fir::FIROpsDialect::FIROpsDialect(mlir::MLIRContext *ctx)
     : mlir::Dialect("fir", ctx, mlir::TypeID::get<FIROpsDialect>()) {
   registerTypes();
@@ -25,6 +57,7 @@ fir::FIROpsDialect::FIROpsDialect(mlir::MLIRContext *ctx)
 #define GET_OP_LIST
 #include "flang/Optimizer/Dialect/FIROps.cpp.inc"
       >();
+  addInterfaces<FIRInlinerInterface>();
 }
 
 // anchor the class vtable to this compilation unit
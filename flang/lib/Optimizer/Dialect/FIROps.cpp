@@ -3234,6 +3234,39 @@ bool fir::valueHasFirAttribute(mlir::Value value,
   return false;
 }
 
+mlir::Operation *fir::getAllocationRoot(mlir::Value memref) {
+  while (auto *op = memref.getDefiningOp()) {
+    if (mlir::isa<fir::AllocaOp, fir::AllocMemOp, fir::AddrOfOp>(op))
+      return op;
+    if (auto embox = mlir::dyn_cast<fir::EmboxOp>(op))
+      memref = embox.memref();
+    else if (auto rebox = mlir::dyn_cast<fir::ReboxOp>(op))
+      memref = rebox.box();
+    else if (auto boxAddr = mlir::dyn_cast<fir::BoxAddrOp>(op))
+      memref = boxAddr.val();
+    else if (auto convert = mlir::dyn_cast<fir::ConvertOp>(op))
+      memref = convert.value();
+    else if (auto coor = mlir::dyn_cast<fir::CoordinateOp>(op))
+      memref = coor.ref();
+    else if (auto coor = mlir::dyn_cast<fir::ArrayCoorOp>(op))
+      memref = coor.memref();
+    else
+      return {};
+  }
+  return {};
+}
+
+bool fir::isDistinctAllocation(mlir::Value a, mlir::Value b) {
+  auto *rootA = getAllocationRoot(a);
+  auto *rootB = getAllocationRoot(b);
+  if (!rootA || !rootB || rootA == rootB)
+    return false;
+  // Each fir.address_of of a global yields the address of the same storage.
+  auto addrA = mlir::dyn_cast<fir::AddrOfOp>(rootA);
+  auto addrB = mlir::dyn_cast<fir::AddrOfOp>(rootB);
+  return !addrA || !addrB || addrA.symbol() != addrB.symbol();
+}
+
 mlir::Type fir::applyPathToType(mlir::Type eleTy, mlir::ValueRange path) {
   for (auto i = path.begin(), end = path.end(); eleTy && i < end;) {
     eleTy = llvm::TypeSwitch<mlir::Type, mlir::Type>(eleTy)
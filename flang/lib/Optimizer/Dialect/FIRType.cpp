@@ -12,6 +12,7 @@
 
 #include "flang/Optimizer/Dialect/FIRType.h"
 #include "flang/Optimizer/Dialect/FIRDialect.h"
+#include "mlir/Dialect/OpenMP/OpenMPDialect.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinDialect.h"
 #include "mlir/IR/Diagnostics.h"
@@ -834,10 +835,27 @@ bool fir::VectorType::isValidElementType(mlir::Type t) {
 // FIROpsDialect
 //===----------------------------------------------------------------------===//
 
+namespace {
+/// Model that lets FIR memory references designate OpenMP variables, such as
+/// the accumulators of a reduction.
+template <typename TYPE>
+struct OpenMPPointerLikeModel
+    : public mlir::omp::PointerLikeType::ExternalModel<
+          OpenMPPointerLikeModel<TYPE>, TYPE> {
+  mlir::Type getElementType(mlir::Type pointer) const {
+    return pointer.cast<TYPE>().getElementType();
+  }
+};
+} // namespace
+
 void FIROpsDialect::registerTypes() {
   addTypes<BoxType, BoxCharType, BoxProcType, CharacterType, fir::ComplexType,
            FieldType, HeapType, fir::IntegerType, LenType, LogicalType,
            PointerType, RealType, RecordType, ReferenceType, SequenceType,
            ShapeType, ShapeShiftType, ShiftType, SliceType, TypeDescType,
            fir::VectorType>();
+  ReferenceType::attachInterface<OpenMPPointerLikeModel<ReferenceType>>(
+      *getContext());
+  PointerType::attachInterface<OpenMPPointerLikeModel<PointerType>>(
+      *getContext());
 }
@@ -0,0 +1,35 @@
+//===-- Inliner.cpp -------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// The legality rules for inlining FIR operations. Whether a call is worth
+// inlining is decided by the cost model of the fir-inline pass.
+//
+//===----------------------------------------------------------------------===//
+
+#include "flang/Optimizer/Dialect/FIRDialect.h"
+#include "flang/Optimizer/Dialect/FIROps.h"
+#include "mlir/IR/BuiltinOps.h"
+
+/// Is `reg` the body of a loop, or nested in one within its function?
+static bool isInLoop(mlir::Region *reg) {
+  for (auto *op = reg->getParentOp(); op && !mlir::isa<mlir::FuncOp>(op);
+       op = op->getParentOp())
+    if (mlir::isa<fir::DoLoopOp, fir::IterWhileOp>(op))
+      return true;
+  return false;
+}
+
+/// Should we inline the callable `op` into region `reg`?
+bool fir::canLegallyInline(mlir::Operation *op, mlir::Region *reg,
+                           mlir::BlockAndValueMapping &map) {
+  // A fir.alloca of the callee would allocate new stack storage on each
+  // iteration of a loop that encloses the call, and never release it.
+  if (mlir::isa<fir::AllocaOp>(op))
+    return !isInLoop(reg);
+  return true;
+}
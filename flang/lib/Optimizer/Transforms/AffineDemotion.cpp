@@ -6,11 +6,11 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This transformation is a prototype that demote affine dialects operations
-// after optimizations to FIR loops operations.
-// It is used after the AffinePromotion pass.
-// It is not part of the production pipeline and would need more work in order
-// to be used in production.
+// This transformation demotes the affine dialect memory operations left by the
+// AffinePromotion pass, after the loop nests have been optimized, to FIR
+// operations. The array memrefs created by the promotion are turned back into
+// fir.array_coor operations on the arrays. The affine loops themselves are
+// lowered by the affine to standard conversion.
 // More information can be found in this presentation:
 // https://slides.com/rajanwalia/deck
 //
@@ -27,6 +27,7 @@
 #include "mlir/Dialect/SCF/SCF.h"
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
 #include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/IntegerSet.h"
 #include "mlir/IR/Visitors.h"
 #include "mlir/Pass/Pass.h"
@@ -40,6 +41,70 @@
 
 using namespace fir;
 
+/// Returns the address of the element of the array cast to a memref by
+/// `cast` at the memref `indices`. The cast operands are the array, its
+/// extents unless it is boxed, and its lower bounds unless they are all one.
+/// The indices are the zero-based offsets of the element in the dimensions of
+/// the array in reverse order.
+static mlir::Value genArrayCoor(mlir::Location loc,
+                                mlir::UnrealizedConversionCastOp cast,
+                                mlir::ValueRange indices, mlir::Type eleTy,
+                                mlir::PatternRewriter &rewriter) {
+  auto inputs = cast.inputs();
+  auto array = inputs.front();
+  auto rank = cast.getResult(0).getType().cast<mlir::MemRefType>().getRank();
+  auto bounds = inputs.drop_front();
+  mlir::ValueRange extents;
+  if (!array.getType().isa<fir::BoxType>()) {
+    extents = bounds.take_front(rank);
+    bounds = bounds.drop_front(rank);
+  }
+  mlir::ValueRange origins = bounds;
+  auto *ctx = rewriter.getContext();
+  mlir::Value shape;
+  if (!origins.empty() && !extents.empty()) {
+    llvm::SmallVector<mlir::Value> pairs;
+    for (auto [origin, extent] : llvm::zip(origins, extents)) {
+      pairs.push_back(origin);
+      pairs.push_back(extent);
+    }
+    shape = rewriter.create<fir::ShapeShiftOp>(
+        loc, fir::ShapeShiftType::get(ctx, rank), pairs);
+  } else if (!origins.empty()) {
+    shape = rewriter.create<fir::ShiftOp>(loc, fir::ShiftType::get(ctx, rank),
+                                          origins);
+  } else if (!extents.empty()) {
+    shape = rewriter.create<fir::ShapeOp>(loc, fir::ShapeType::get(ctx, rank),
+                                          extents);
+  }
+  // The subscript of the element in a dimension is its offset plus the lower
+  // bound of the dimension.
+  mlir::Value one;
+  if (origins.empty())
+    one = rewriter.create<mlir::arith::ConstantIndexOp>(loc, 1);
+  llvm::SmallVector<mlir::Value> coor;
+  for (auto iter : llvm::enumerate(llvm::reverse(indices))) {
+    auto origin = origins.empty() ? one : origins[iter.index()];
+    coor.push_back(
+        rewriter.create<mlir::arith::AddIOp>(loc, iter.value(), origin));
+  }
+  return rewriter.create<fir::ArrayCoorOp>(loc, fir::ReferenceType::get(eleTy),
+                                           array, shape, mlir::Value{}, coor,
+                                           mlir::ValueRange{});
+}
+
+/// Returns the address of the element of `memref` at `indices`.
+static mlir::Value genCoordinate(mlir::Location loc, mlir::Value memref,
+                                 mlir::ValueRange indices, mlir::Type eleTy,
+                                 mlir::PatternRewriter &rewriter) {
+  if (auto cast = memref.getDefiningOp<mlir::UnrealizedConversionCastOp>())
+    if (fir::isa_ref_type(cast.inputs().front().getType()) ||
+        cast.inputs().front().getType().isa<fir::BoxType>())
+      return genArrayCoor(loc, cast, indices, eleTy, rewriter);
+  return rewriter.create<fir::CoordinateOp>(
+      loc, fir::ReferenceType::get(eleTy), memref, indices);
+}
+
 namespace {
 
 class AffineLoadConversion : public OpRewritePattern<mlir::AffineLoadOp> {
@@ -54,11 +119,10 @@ public:
     if (!maybeExpandedMap)
       return failure();
 
-    auto coorOp = rewriter.create<fir::CoordinateOp>(
-        op.getLoc(), fir::ReferenceType::get(op.getResult().getType()),
-        op.getMemRef(), *maybeExpandedMap);
+    auto coor = genCoordinate(op.getLoc(), op.getMemRef(), *maybeExpandedMap,
+                              op.getResult().getType(), rewriter);
 
-    rewriter.replaceOpWithNewOp<fir::LoadOp>(op, coorOp.getResult());
+    rewriter.replaceOpWithNewOp<fir::LoadOp>(op, coor);
     return success();
   }
 };
@@ -75,11 +139,10 @@ public:
     if (!maybeExpandedMap)
       return failure();
 
-    auto coorOp = rewriter.create<fir::CoordinateOp>(
-        op.getLoc(), fir::ReferenceType::get(op.getValueToStore().getType()),
-        op.getMemRef(), *maybeExpandedMap);
-    rewriter.replaceOpWithNewOp<fir::StoreOp>(op, op.getValueToStore(),
-                                              coorOp.getResult());
+    auto coor =
+        genCoordinate(op.getLoc(), op.getMemRef(), *maybeExpandedMap,
+                      op.getValueToStore().getType(), rewriter);
+    rewriter.replaceOpWithNewOp<fir::StoreOp>(op, op.getValueToStore(), coor);
     return success();
   }
 };
@@ -162,7 +225,14 @@ public:
       mlir::emitError(mlir::UnknownLoc::get(context),
                       "error in converting affine dialect\n");
       signalPassFailure();
+      return;
     }
+    // The array memrefs are no longer used.
+    function.walk([](mlir::UnrealizedConversionCastOp cast) {
+      if (cast.use_empty() && cast->getNumResults() == 1 &&
+          cast->getResult(0).getType().isa<mlir::MemRefType>())
+        cast.erase();
+    });
   }
 };
 
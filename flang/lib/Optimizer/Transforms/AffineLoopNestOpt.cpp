@@ -0,0 +1,257 @@
+//===-- AffineLoopNestOpt.cpp ---------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Optimize the locality of the perfect affine loop nests obtained by promoting
+// FIR loops.
+//
+// In each nest, the loop whose induction variable indexes the fastest varying
+// dimension of the most arrays is moved innermost, so that the inner loop
+// walks through memory contiguously. A Fortran loop nest written in the wrong
+// order, such as
+//
+//   do i = 1, n
+//     do j = 1, m
+//       a(i, j) = b(i, j) + c(i, j)
+//
+// is thus interchanged. A fully permutable nest is then tiled, and the loop
+// enclosing the innermost loop is unrolled and jammed so that the array
+// elements it reuses stay in registers. Every transformation is checked
+// against the dependences of the nest.
+//
+// The loop nest optimization pipeline promotes the FIR loops, runs this pass,
+// demotes the memory operations back to FIR and lowers the affine loops.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "flang/Optimizer/Transforms/Passes.h"
+#include "mlir/Analysis/AffineAnalysis.h"
+#include "mlir/Analysis/AffineStructures.h"
+#include "mlir/Conversion/AffineToStandard/AffineToStandard.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Transforms/LoopUtils.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+#include <vector>
+
+#define DEBUG_TYPE "flang-affine-loop-nest-opt"
+
+using Dependence = llvm::SmallVector<mlir::DependenceComponent, 2>;
+
+/// Collects the components, for the loops of `band`, of the dependences
+/// between the memory accesses of the nest. Returns false if a dependence
+/// cannot be analyzed.
+static bool getDependences(llvm::ArrayRef<mlir::AffineForOp> band,
+                           std::vector<Dependence> &dependences) {
+  llvm::SmallVector<mlir::Operation *> accesses;
+  band.front()->walk([&](mlir::Operation *op) {
+    if (mlir::isa<mlir::AffineReadOpInterface, mlir::AffineWriteOpInterface>(
+            op))
+      accesses.push_back(op);
+  });
+  for (auto *src : accesses) {
+    mlir::MemRefAccess srcAccess(src);
+    for (auto *dst : accesses) {
+      mlir::MemRefAccess dstAccess(dst);
+      for (unsigned depth = 1; depth <= band.size(); ++depth) {
+        mlir::FlatAffineValueConstraints constraints;
+        Dependence components;
+        auto result = mlir::checkMemrefAccessDependence(
+            srcAccess, dstAccess, depth, &constraints, &components);
+        if (result.value == mlir::DependenceResult::Failure) {
+          LLVM_DEBUG(llvm::dbgs() << "AffineLoopNestOpt: cannot analyze "
+                                     "dependence\n";
+                     src->dump(); dst->dump(););
+          return false;
+        }
+        if (mlir::hasDependence(result))
+          dependences.push_back(components);
+      }
+    }
+  }
+  return true;
+}
+
+/// Is the nest still correct with loop `i` moved to position `permutation[i]`?
+/// Each dependence must remain lexicographically non-negative.
+static bool isValidPermutation(llvm::ArrayRef<Dependence> dependences,
+                               llvm::ArrayRef<unsigned> permutation) {
+  llvm::SmallVector<unsigned> loopAt(permutation.size());
+  for (auto iter : llvm::enumerate(permutation))
+    loopAt[iter.value()] = iter.index();
+  for (const auto &dependence : dependences)
+    for (auto loop : loopAt) {
+      const auto &component = dependence[loop];
+      if (!component.lb || *component.lb < 0)
+        return false;
+      if (*component.lb > 0)
+        break;
+    }
+  return true;
+}
+
+/// A band can be tiled when no dependence goes backward in any of its loops.
+static bool isFullyPermutable(llvm::ArrayRef<Dependence> dependences,
+                              unsigned depth) {
+  return llvm::all_of(dependences, [&](const Dependence &dependence) {
+    for (unsigned loop = 0; loop < depth; ++loop)
+      if (!dependence[loop].lb || *dependence[loop].lb < 0)
+        return false;
+    return true;
+  });
+}
+
+/// Counts the accesses in `root` that use induction variable `iv` in their
+/// last subscript only, and so walk contiguously through memory along it.
+static unsigned countContiguousAccesses(mlir::AffineForOp root,
+                                        mlir::Value iv) {
+  unsigned count = 0;
+  auto visit = [&](mlir::AffineMap map, mlir::ValueRange operands) {
+    if (map.getNumResults() == 0)
+      return;
+    bool inLast = false;
+    bool elsewhere = false;
+    for (auto operand : llvm::enumerate(operands)) {
+      if (operand.value() != iv)
+        continue;
+      for (unsigned i = 0, e = map.getNumResults(); i < e; ++i) {
+        auto expr = map.getResult(i);
+        auto pos = operand.index();
+        bool uses = pos < map.getNumDims()
+                        ? expr.isFunctionOfDim(pos)
+                        : expr.isFunctionOfSymbol(pos - map.getNumDims());
+        if (!uses)
+          continue;
+        if (i + 1 == e)
+          inLast = true;
+        else
+          elsewhere = true;
+      }
+    }
+    if (inLast && !elsewhere)
+      ++count;
+  };
+  root.walk([&](mlir::AffineLoadOp op) {
+    visit(op.getAffineMap(), op.getMapOperands());
+  });
+  root.walk([&](mlir::AffineStoreOp op) {
+    visit(op.getAffineMap(), op.getMapOperands());
+  });
+  return count;
+}
+
+namespace {
+class AffineLoopNestOpt : public fir::AffineLoopNestOptBase<AffineLoopNestOpt> {
+public:
+  void runOnFunction() override {
+    llvm::SmallVector<mlir::AffineForOp> roots;
+    getFunction().walk([&](mlir::AffineForOp op) {
+      if (!op->getParentOfType<mlir::AffineForOp>())
+        roots.push_back(op);
+    });
+    for (auto root : roots)
+      optimizeNest(root);
+  }
+
+private:
+  void optimizeNest(mlir::AffineForOp root) {
+    llvm::SmallVector<mlir::AffineForOp, 6> band;
+    mlir::getPerfectlyNestedLoops(band, root);
+    auto depth = band.size();
+    if (depth < 2)
+      return;
+    std::vector<Dependence> dependences;
+    if (!getDependences(band, dependences))
+      return;
+
+    if (interchange(band, dependences)) {
+      dependences.clear();
+      if (!getDependences(band, dependences))
+        return;
+    }
+
+    bool canUnrollJam;
+    if (tileSize > 1 && isFullyPermutable(dependences, depth)) {
+      llvm::SmallVector<unsigned, 6> tileSizes(depth, tileSize);
+      llvm::SmallVector<mlir::AffineForOp, 6> tiledNest;
+      if (mlir::failed(mlir::tilePerfectlyNested(band, tileSizes, &tiledNest)))
+        return;
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopNestOpt: tiled nest\n";);
+      band.assign(tiledNest.begin() + depth, tiledNest.end());
+      // The intra-tile loops remain fully permutable.
+      canUnrollJam = true;
+    } else {
+      llvm::SmallVector<unsigned, 6> swapInner;
+      for (unsigned i = 0; i < depth; ++i)
+        swapInner.push_back(i);
+      std::swap(swapInner[depth - 2], swapInner[depth - 1]);
+      canUnrollJam = isValidPermutation(dependences, swapInner);
+    }
+
+    if (unrollJamFactor > 1 && canUnrollJam &&
+        mlir::succeeded(
+            mlir::loopUnrollJamByFactor(band[depth - 2], unrollJamFactor)))
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopNestOpt: unrolled and jammed\n";);
+  }
+
+  /// Move the loop along which the most accesses are contiguous innermost.
+  /// Returns true if `band` was permuted.
+  bool interchange(llvm::SmallVectorImpl<mlir::AffineForOp> &band,
+                   llvm::ArrayRef<Dependence> dependences) {
+    auto depth = band.size();
+    unsigned best = depth - 1;
+    unsigned bestCount =
+        countContiguousAccesses(band.front(), band[best].getInductionVar());
+    for (unsigned i = 0; i + 1 < depth; ++i) {
+      auto count =
+          countContiguousAccesses(band.front(), band[i].getInductionVar());
+      if (count > bestCount) {
+        best = i;
+        bestCount = count;
+      }
+    }
+    if (best == depth - 1)
+      return false;
+    llvm::SmallVector<unsigned, 6> permutation;
+    for (unsigned i = 0; i < depth; ++i)
+      permutation.push_back(i < best ? i : i == best ? depth - 1 : i - 1);
+    if (!isValidPermutation(dependences, permutation)) {
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopNestOpt: interchange prevented by "
+                                 "dependences\n";);
+      return false;
+    }
+    auto newRoot = band[mlir::permuteLoops(band, permutation)];
+    LLVM_DEBUG(llvm::dbgs() << "AffineLoopNestOpt: interchanged loop " << best
+                            << " innermost\n";);
+    band.clear();
+    mlir::getPerfectlyNestedLoops(band, newRoot);
+    return true;
+  }
+};
+} // namespace
+
+std::unique_ptr<mlir::Pass> fir::createAffineLoopNestOptPass() {
+  return std::make_unique<AffineLoopNestOpt>();
+}
+
+void fir::addAffineLoopOptPipeline(mlir::OpPassManager &pm) {
+  pm.addNestedPass<mlir::FuncOp>(fir::createPromoteToAffinePass());
+  pm.addNestedPass<mlir::FuncOp>(fir::createAffineLoopNestOptPass());
+  pm.addNestedPass<mlir::FuncOp>(fir::createAffineDemotionPass());
+  pm.addNestedPass<mlir::FuncOp>(mlir::createLowerAffinePass());
+}
+
+void fir::registerAffineLoopOptPipeline() {
+  mlir::PassPipelineRegistration<>(
+      "fir-affine-loop-opt",
+      "Optimize FIR loop nests over arrays in the affine dialect",
+      [](mlir::OpPassManager &pm) { fir::addAffineLoopOptPipeline(pm); });
+}
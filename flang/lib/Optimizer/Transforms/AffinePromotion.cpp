@@ -6,10 +6,26 @@
 //
 //===----------------------------------------------------------------------===//
 //
-// This transformation is a prototype that promote FIR loops operations
-// to affine dialect operations.
-// It is not part of the production pipeline and would need more work in order
-// to be used in production.
+// This transformation promotes FIR loop nests over arrays to the affine
+// dialect, so that the loop nest optimizations of MLIR can be applied to them.
+//
+// A fir.do_loop is promoted to an affine.for when its step is a constant, its
+// bounds are affine functions of the induction variables of the enclosing
+// promoted loops and of values defined at the top level of the function, and
+// its body only loads and stores array elements whose fir.array_coor
+// subscripts are such functions too. The arrays may be described by a shape,
+// a shape with lower bounds or a descriptor, and may be sliced with constant
+// strides. A fir.if in such a loop is promoted to an affine.if.
+//
+// Each array accessed in a promoted loop nest is cast to a memref with the
+// dimensions of the array in reverse order, so that the last subscript of the
+// memref varies fastest in memory, as MLIR expects. The memref subscripts are
+// the zero-based offsets of the element in each dimension of the array, and
+// the AffineDemotion pass turns the accesses back into fir.array_coor.
+// MLIR takes distinct memrefs to be independent, so only arrays whose
+// allocations are known to be distinct from those of all the other arrays
+// are promoted.
+//
 // More information can be found in this presentation:
 // https://slides.com/rajanwalia/deck
 //
@@ -18,154 +34,155 @@
 #include "PassDetail.h"
 #include "flang/Optimizer/Dialect/FIRDialect.h"
 #include "flang/Optimizer/Dialect/FIROps.h"
+#include "flang/Optimizer/Dialect/FIROpsSupport.h"
 #include "flang/Optimizer/Dialect/FIRType.h"
 #include "flang/Optimizer/Transforms/Passes.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/SCF/SCF.h"
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
 #include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/IntegerSet.h"
 #include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Debug.h"
+#include <algorithm>
+#include <tuple>
 
 #define DEBUG_TYPE "flang-affine-promotion"
 
 using namespace fir;
 
-namespace {
-struct AffineLoopAnalysis;
-struct AffineIfAnalysis;
-
-/// Stores analysis objects for all loops and if operations inside a function
-/// these analysis are used twice, first for marking operations for rewrite and
-/// second when doing rewrite.
-struct AffineFunctionAnalysis {
-  explicit AffineFunctionAnalysis(mlir::FuncOp funcOp) {
-    for (fir::DoLoopOp op : funcOp.getOps<fir::DoLoopOp>())
-      loopAnalysisMap.try_emplace(op, op, *this);
-  }
-
-  AffineLoopAnalysis getChildLoopAnalysis(fir::DoLoopOp op) const;
-
-  AffineIfAnalysis getChildIfAnalysis(fir::IfOp op) const;
+static bool isIntegerLike(mlir::Type type) {
+  return type.isa<mlir::IntegerType, mlir::IndexType>();
+}
 
-  llvm::DenseMap<mlir::Operation *, AffineLoopAnalysis> loopAnalysisMap;
-  llvm::DenseMap<mlir::Operation *, AffineIfAnalysis> ifAnalysisMap;
-};
-} // namespace
+static Optional<int64_t> constantIntegerLike(const mlir::Value value) {
+  if (auto convert = value.getDefiningOp<fir::ConvertOp>())
+    if (isIntegerLike(convert.value().getType()))
+      return constantIntegerLike(convert.value());
+  if (auto definition = value.getDefiningOp<mlir::arith::ConstantOp>())
+    if (auto stepAttr = definition.value().dyn_cast<IntegerAttr>())
+      return stepAttr.getInt();
+  return {};
+}
 
-static bool analyzeCoordinate(mlir::Value coordinate, mlir::Operation *op) {
-  if (auto blockArg = coordinate.dyn_cast<mlir::BlockArgument>()) {
-    if (isa<fir::DoLoopOp>(blockArg.getOwner()->getParentOp()))
-      return true;
-    LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: array coordinate is not a "
-                               "loop induction variable (owner not loopOp)\n";
-               op->dump());
+static bool isInductionVariable(mlir::Value value) {
+  auto blockArg = value.dyn_cast<mlir::BlockArgument>();
+  if (!blockArg)
     return false;
-  }
-  LLVM_DEBUG(
-      llvm::dbgs() << "AffineLoopAnalysis: array coordinate is not a loop "
-                      "induction variable (not a block argument)\n";
-      op->dump(); coordinate.getDefiningOp()->dump());
+  auto *owner = blockArg.getOwner()->getParentOp();
+  if (auto loop = mlir::dyn_cast_or_null<fir::DoLoopOp>(owner))
+    return loop.getInductionVar() == value;
+  if (auto loop = mlir::dyn_cast_or_null<mlir::AffineForOp>(owner))
+    return loop.getInductionVar() == value;
   return false;
 }
 
 namespace {
-struct AffineLoopAnalysis {
-  AffineLoopAnalysis() = default;
-
-  explicit AffineLoopAnalysis(fir::DoLoopOp op, AffineFunctionAnalysis &afa)
-      : legality(analyzeLoop(op, afa)) {}
+/// Translates integer computations to affine expressions. The induction
+/// variables of loops are used as dimensions and the values defined at the top
+/// level of the function as symbols.
+class AffineExprBuilder {
+public:
+  using MaybeAffineExpr = llvm::Optional<mlir::AffineExpr>;
 
-  bool canPromoteToAffine() { return legality; }
+  explicit AffineExprBuilder(mlir::MLIRContext *context) : context(context) {}
 
-private:
-  bool analyzeBody(fir::DoLoopOp loopOperation,
-                   AffineFunctionAnalysis &functionAnalysis) {
-    for (auto loopOp : loopOperation.getOps<fir::DoLoopOp>()) {
-      auto analysis = functionAnalysis.loopAnalysisMap
-                          .try_emplace(loopOp, loopOp, functionAnalysis)
-                          .first->getSecond();
-      if (!analysis.canPromoteToAffine())
-        return false;
+  /// Returns an AffineExpr if `value` is a result of operations that can be
+  /// done in an affine expression, this includes -, +, * and rem by a
+  /// constant, constant and integer conversions.
+  MaybeAffineExpr build(mlir::Value value) {
+    if (!isIntegerLike(value.getType()))
+      return {};
+    if (auto constant = constantIntegerLike(value))
+      return mlir::getAffineConstantExpr(*constant, context);
+    if (auto op = value.getDefiningOp<fir::ConvertOp>())
+      if (isIntegerLike(op.value().getType()))
+        return build(op.value());
+    if (auto op = value.getDefiningOp<mlir::arith::AddIOp>())
+      return combine(mlir::AffineExprKind::Add, build(op.lhs()),
+                     build(op.rhs()));
+    if (auto op = value.getDefiningOp<mlir::arith::SubIOp>()) {
+      auto rhs = build(op.rhs());
+      return combine(mlir::AffineExprKind::Add, build(op.lhs()),
+                     rhs ? MaybeAffineExpr{-*rhs} : MaybeAffineExpr{});
     }
-    for (auto ifOp : loopOperation.getOps<fir::IfOp>())
-      functionAnalysis.ifAnalysisMap.try_emplace(ifOp, ifOp, functionAnalysis);
-    return true;
+    if (auto op = value.getDefiningOp<mlir::arith::MulIOp>()) {
+      auto lhs = build(op.lhs());
+      auto rhs = build(op.rhs());
+      // Only a product with a constant factor is affine.
+      if (lhs && rhs &&
+          (lhs->isa<mlir::AffineConstantExpr>() ||
+           rhs->isa<mlir::AffineConstantExpr>()))
+        return *lhs * *rhs;
+      return {};
+    }
+    if (auto op = value.getDefiningOp<mlir::arith::RemUIOp>()) {
+      auto rhs = constantIntegerLike(op.rhs());
+      if (rhs && *rhs > 0)
+        return combine(mlir::AffineExprKind::Mod, build(op.lhs()),
+                       mlir::getAffineConstantExpr(*rhs, context));
+      return {};
+    }
+    if (isInductionVariable(value) ||
+        (value.getDefiningOp<mlir::AffineApplyOp>() && mlir::isValidDim(value)))
+      return dim(value);
+    if (mlir::isTopLevelValue(value))
+      return symbol(value);
+    return {};
   }
 
-  bool analyzeLoop(fir::DoLoopOp loopOperation,
-                   AffineFunctionAnalysis &functionAnalysis) {
-    LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: \n"; loopOperation.dump(););
-    return analyzeMemoryAccess(loopOperation) &&
-           analyzeBody(loopOperation, functionAnalysis);
+  /// Returns the dimension bound to `value`.
+  mlir::AffineExpr dim(mlir::Value value) {
+    return mlir::getAffineDimExpr(position(dims, value), context);
   }
 
-  bool analyzeReference(mlir::Value memref, mlir::Operation *op) {
-    if (auto acoOp = memref.getDefiningOp<ArrayCoorOp>()) {
-      if (acoOp.memref().getType().isa<fir::BoxType>()) {
-        // TODO: Look if and how fir.box can be promoted to affine.
-        LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: cannot promote loop, "
-                                   "array memory operation uses fir.box\n";
-                   op->dump(); acoOp.dump(););
-        return false;
-      }
-      bool canPromote = true;
-      for (auto coordinate : acoOp.indices())
-        canPromote = canPromote && analyzeCoordinate(coordinate, op);
-      return canPromote;
-    }
-    if (auto coOp = memref.getDefiningOp<CoordinateOp>()) {
-      LLVM_DEBUG(llvm::dbgs()
-                     << "AffineLoopAnalysis: cannot promote loop, "
-                        "array memory operation uses non ArrayCoorOp\n";
-                 op->dump(); coOp.dump(););
+  llvm::ArrayRef<mlir::Value> getDims() const { return dims; }
+  llvm::ArrayRef<mlir::Value> getSymbols() const { return symbols; }
 
-      return false;
-    }
-    LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: unknown type of memory "
-                               "reference for array load\n";
-               op->dump(););
-    return false;
+  /// Returns an affine map from the dimensions and symbols to `results`.
+  mlir::AffineMap getMap(llvm::ArrayRef<mlir::AffineExpr> results) const {
+    return mlir::AffineMap::get(dims.size(), symbols.size(), results, context);
   }
 
-  bool analyzeMemoryAccess(fir::DoLoopOp loopOperation) {
-    for (auto loadOp : loopOperation.getOps<fir::LoadOp>())
-      if (!analyzeReference(loadOp.memref(), loadOp))
-        return false;
-    for (auto storeOp : loopOperation.getOps<fir::StoreOp>())
-      if (!analyzeReference(storeOp.memref(), storeOp))
-        return false;
-    return true;
+private:
+  MaybeAffineExpr combine(mlir::AffineExprKind kind, MaybeAffineExpr lhs,
+                          MaybeAffineExpr rhs) {
+    if (lhs.hasValue() && rhs.hasValue())
+      return mlir::getAffineBinaryOpExpr(kind, lhs.getValue(), rhs.getValue());
+    return {};
   }
 
-  bool legality{};
-};
-} // namespace
+  mlir::AffineExpr symbol(mlir::Value value) {
+    return mlir::getAffineSymbolExpr(position(symbols, value), context);
+  }
 
-AffineLoopAnalysis
-AffineFunctionAnalysis::getChildLoopAnalysis(fir::DoLoopOp op) const {
-  auto it = loopAnalysisMap.find_as(op);
-  if (it == loopAnalysisMap.end()) {
-    LLVM_DEBUG(llvm::dbgs() << "AffineFunctionAnalysis: not computed for:\n";
-               op.dump(););
-    op.emitError("error in fetching loop analysis in AffineFunctionAnalysis\n");
-    return {};
+  static unsigned position(llvm::SmallVectorImpl<mlir::Value> &values,
+                           mlir::Value value) {
+    auto *it = llvm::find(values, value);
+    if (it == values.end()) {
+      values.push_back(value);
+      return values.size() - 1;
+    }
+    return it - values.begin();
   }
-  return it->getSecond();
-}
 
-namespace {
-/// Calculates arguments for creating an IntegerSet. symCount, dimCount are the
-/// final number of symbols and dimensions of the affine map. Integer set if
-/// possible is in Optional IntegerSet.
-struct AffineIfCondition {
-  using MaybeAffineExpr = llvm::Optional<mlir::AffineExpr>;
+  mlir::MLIRContext *context;
+  llvm::SmallVector<mlir::Value> dims;
+  llvm::SmallVector<mlir::Value> symbols;
+};
 
-  explicit AffineIfCondition(mlir::Value fc) : firCondition(fc) {
+/// Calculates arguments for creating an IntegerSet. The integer set, if
+/// possible, is in Optional IntegerSet; its dimensions and symbols are those
+/// of the expression builder.
+struct AffineIfCondition {
+  explicit AffineIfCondition(mlir::Value fc)
+      : firCondition(fc), exprBuilder(fc.getContext()) {
     if (auto condDef = firCondition.getDefiningOp<mlir::arith::CmpIOp>())
       fromCmpIOp(condDef);
   }
@@ -177,68 +194,21 @@ struct AffineIfCondition {
     return integerSet.getValue();
   }
 
-  mlir::ValueRange getAffineArgs() const { return affineArgs; }
+  const AffineExprBuilder &getExprBuilder() const { return exprBuilder; }
 
 private:
-  MaybeAffineExpr affineBinaryOp(mlir::AffineExprKind kind, mlir::Value lhs,
-                                 mlir::Value rhs) {
-    return affineBinaryOp(kind, toAffineExpr(lhs), toAffineExpr(rhs));
-  }
-
-  MaybeAffineExpr affineBinaryOp(mlir::AffineExprKind kind, MaybeAffineExpr lhs,
-                                 MaybeAffineExpr rhs) {
-    if (lhs.hasValue() && rhs.hasValue())
-      return mlir::getAffineBinaryOpExpr(kind, lhs.getValue(), rhs.getValue());
-    return {};
-  }
-
-  MaybeAffineExpr toAffineExpr(MaybeAffineExpr e) { return e; }
-
-  MaybeAffineExpr toAffineExpr(int64_t value) {
-    return {mlir::getAffineConstantExpr(value, firCondition.getContext())};
-  }
-
-  /// Returns an AffineExpr if it is a result of operations that can be done
-  /// in an affine expression, this includes -, +, *, rem, constant.
-  /// block arguments of a loopOp or forOp are used as dimensions
-  MaybeAffineExpr toAffineExpr(mlir::Value value) {
-    if (auto op = value.getDefiningOp<mlir::arith::SubIOp>())
-      return affineBinaryOp(mlir::AffineExprKind::Add, toAffineExpr(op.lhs()),
-                            affineBinaryOp(mlir::AffineExprKind::Mul,
-                                           toAffineExpr(op.rhs()),
-                                           toAffineExpr(-1)));
-    if (auto op = value.getDefiningOp<mlir::arith::AddIOp>())
-      return affineBinaryOp(mlir::AffineExprKind::Add, op.lhs(), op.rhs());
-    if (auto op = value.getDefiningOp<mlir::arith::MulIOp>())
-      return affineBinaryOp(mlir::AffineExprKind::Mul, op.lhs(), op.rhs());
-    if (auto op = value.getDefiningOp<mlir::arith::RemUIOp>())
-      return affineBinaryOp(mlir::AffineExprKind::Mod, op.lhs(), op.rhs());
-    if (auto op = value.getDefiningOp<mlir::arith::ConstantOp>())
-      if (auto intConstant = op.value().dyn_cast<IntegerAttr>())
-        return toAffineExpr(intConstant.getInt());
-    if (auto blockArg = value.dyn_cast<mlir::BlockArgument>()) {
-      affineArgs.push_back(value);
-      if (isa<fir::DoLoopOp>(blockArg.getOwner()->getParentOp()) ||
-          isa<mlir::AffineForOp>(blockArg.getOwner()->getParentOp()))
-        return {mlir::getAffineDimExpr(dimCount++, value.getContext())};
-      return {mlir::getAffineSymbolExpr(symCount++, value.getContext())};
-    }
-    return {};
-  }
-
   void fromCmpIOp(mlir::arith::CmpIOp cmpOp) {
-    auto lhsAffine = toAffineExpr(cmpOp.lhs());
-    auto rhsAffine = toAffineExpr(cmpOp.rhs());
+    auto lhsAffine = exprBuilder.build(cmpOp.lhs());
+    auto rhsAffine = exprBuilder.build(cmpOp.rhs());
     if (!lhsAffine.hasValue() || !rhsAffine.hasValue())
       return;
     auto constraintPair = constraint(
         cmpOp.predicate(), rhsAffine.getValue() - lhsAffine.getValue());
     if (!constraintPair)
       return;
-    integerSet = mlir::IntegerSet::get(dimCount, symCount,
-                                       {constraintPair.getValue().first},
-                                       {constraintPair.getValue().second});
-    return;
+    integerSet = mlir::IntegerSet::get(
+        exprBuilder.getDims().size(), exprBuilder.getSymbols().size(),
+        {constraintPair.getValue().first}, {constraintPair.getValue().second});
   }
 
   llvm::Optional<std::pair<AffineExpr, bool>>
@@ -259,23 +229,397 @@ private:
     }
   }
 
-  llvm::SmallVector<mlir::Value> affineArgs;
   llvm::Optional<mlir::IntegerSet> integerSet;
   mlir::Value firCondition;
-  unsigned symCount{0u};
-  unsigned dimCount{0u};
+  AffineExprBuilder exprBuilder;
+};
+
+/// An array element addressed by a fir.array_coor, as the subscripts of a
+/// memref: the zero-based offsets of the element in the dimensions of the
+/// array, last dimension first.
+struct ArrayAccess {
+  mlir::Value base;
+  // The extents of the array, unless it is described by a descriptor.
+  llvm::SmallVector<mlir::Value> extents;
+  // The lower bounds of the array, if they are not all one.
+  llvm::SmallVector<mlir::Value> origins;
+  llvm::SmallVector<mlir::AffineExpr> subscripts;
 };
 } // namespace
 
+static llvm::SmallVector<mlir::Value> getExtents(fir::ArrayCoorOp acoOp) {
+  llvm::SmallVector<mlir::Value> extents;
+  if (auto shape = acoOp.shape()) {
+    if (auto shapeOp = shape.getDefiningOp<fir::ShapeOp>()) {
+      auto shapeExtents = shapeOp.getExtents();
+      extents.append(shapeExtents.begin(), shapeExtents.end());
+    } else if (auto shapeShift = shape.getDefiningOp<fir::ShapeShiftOp>()) {
+      auto shapeExtents = shapeShift.getExtents();
+      extents.append(shapeExtents.begin(), shapeExtents.end());
+    }
+  }
+  return extents;
+}
+
+static llvm::SmallVector<mlir::Value> getOrigins(fir::ArrayCoorOp acoOp) {
+  std::vector<mlir::Value> origins;
+  if (auto shape = acoOp.shape()) {
+    if (auto shapeShift = shape.getDefiningOp<fir::ShapeShiftOp>())
+      origins = shapeShift.getOrigins();
+    else if (auto shift = shape.getDefiningOp<fir::ShiftOp>())
+      origins = shift.getOrigins();
+  }
+  return {origins.begin(), origins.end()};
+}
+
+/// Computes the memref subscripts of the element addressed by `acoOp`. The
+/// induction variables and symbols they use are added to `builder`.
+static llvm::Optional<ArrayAccess>
+analyzeArrayCoor(fir::ArrayCoorOp acoOp, AffineExprBuilder &builder) {
+  auto memrefTy = acoOp.memref().getType();
+  auto seqTy = fir::dyn_cast_ptrOrBoxEleTy(memrefTy)
+                   .dyn_cast_or_null<fir::SequenceType>();
+  if (!seqTy || !acoOp.typeparams().empty() ||
+      !mlir::MemRefType::isValidElementType(seqTy.getEleTy())) {
+    LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: array element type cannot "
+                               "be used in a memref\n";
+               acoOp.dump(););
+    return {};
+  }
+  auto rank = seqTy.getDimension();
+  if (acoOp.indices().size() != rank)
+    return {};
+  ArrayAccess access;
+  access.base = acoOp.memref();
+  if (!memrefTy.isa<fir::BoxType>()) {
+    access.extents = getExtents(acoOp);
+    if (access.extents.size() != rank) {
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: array has no shape\n";
+                 acoOp.dump(););
+      return {};
+    }
+  }
+  fir::SliceOp slice;
+  if (auto sliceVal = acoOp.slice()) {
+    slice = sliceVal.getDefiningOp<fir::SliceOp>();
+    if (!slice || !slice.fields().empty()) {
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: unknown or component "
+                                 "slice\n";
+                 acoOp.dump(););
+      return {};
+    }
+  }
+  if (auto shape = acoOp.shape())
+    if (!mlir::isa_and_nonnull<fir::ShapeOp, fir::ShapeShiftOp, fir::ShiftOp>(
+            shape.getDefiningOp()))
+      return {};
+  access.origins = getOrigins(acoOp);
+  auto &origins = access.origins;
+  auto one = mlir::getAffineConstantExpr(1, acoOp.getContext());
+  for (unsigned dim = 0; dim < rank; ++dim) {
+    auto index = builder.build(acoOp.indices()[dim]);
+    auto origin = origins.empty() ? AffineExprBuilder::MaybeAffineExpr{one}
+                                  : builder.build(origins[dim]);
+    if (!index || !origin) {
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: array coordinate is not "
+                                 "an affine function of loop induction "
+                                 "variables\n";
+                 acoOp.dump(););
+      return {};
+    }
+    auto offset = *index - *origin;
+    if (slice) {
+      auto triples = slice.triples();
+      auto lower = builder.build(triples[3 * dim]);
+      auto stride = constantIntegerLike(triples[3 * dim + 2]);
+      // A scalar subscript has an undefined upper bound.
+      if (!lower || !stride ||
+          mlir::isa_and_nonnull<fir::UndefOp>(
+              triples[3 * dim + 1].getDefiningOp())) {
+        LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: slice triple is not "
+                                   "affine with a constant stride\n";
+                   acoOp.dump(););
+        return {};
+      }
+      offset = offset * *stride + *lower - *origin;
+    }
+    access.subscripts.push_back(offset);
+  }
+  std::reverse(access.subscripts.begin(), access.subscripts.end());
+  return access;
+}
+
+static bool isPointer(mlir::Type type) {
+  if (auto boxTy = type.dyn_cast<fir::BoxType>())
+    type = boxTy.getEleTy();
+  return type.isa<fir::PointerType>();
+}
+
+static bool sameExtent(mlir::Value a, mlir::Value b) {
+  if (a == b)
+    return true;
+  auto ca = constantIntegerLike(a);
+  auto cb = constantIntegerLike(b);
+  return ca && cb && *ca == *cb;
+}
+
+/// The outermost affine.for enclosing `op`.
+static mlir::Operation *getNestRoot(mlir::Operation *op) {
+  mlir::Operation *root = nullptr;
+  for (auto *parent = op->getParentOp(); parent; parent = parent->getParentOp())
+    if (mlir::isa<mlir::AffineForOp>(parent))
+      root = parent;
+  return root;
+}
+
 namespace {
-/// Analysis for affine promotion of fir.if
+struct AffineLoopAnalysis;
+struct AffineIfAnalysis;
+
+/// Stores analysis objects for all loops and if operations inside a function
+/// these analysis are used twice, first for marking operations for rewrite and
+/// second when doing rewrite. Also caches the values created while rewriting
+/// that are shared by several operations.
+struct AffineFunctionAnalysis {
+  explicit AffineFunctionAnalysis(mlir::FuncOp funcOp);
+
+  bool canPromoteToAffine(fir::DoLoopOp op) const;
+  bool canPromoteToAffine(fir::IfOp op) const;
+
+  /// Can the elements of array `base` be accessed through a memref?
+  bool canPromoteArray(mlir::Value base) const {
+    auto it = promotableArrays.find(base);
+    return it != promotableArrays.end() && it->second;
+  }
+
+  /// Returns `value`, defined at the top level of the function, as an index.
+  mlir::Value getIndexSymbol(mlir::Value value,
+                             mlir::PatternRewriter &rewriter) {
+    if (value.getType().isa<mlir::IndexType>())
+      return value;
+    auto &symbol = indexSymbols[value];
+    if (!symbol) {
+      mlir::OpBuilder::InsertionGuard guard(rewriter);
+      rewriter.setInsertionPointAfterValue(value);
+      symbol = rewriter.create<fir::ConvertOp>(
+          value.getLoc(), rewriter.getIndexType(), value);
+    }
+    return symbol;
+  }
+
+  /// Returns the operands of the maps of `builder`.
+  llvm::SmallVector<mlir::Value>
+  getMapOperands(const AffineExprBuilder &builder,
+                 mlir::PatternRewriter &rewriter) {
+    llvm::SmallVector<mlir::Value> operands(builder.getDims().begin(),
+                                            builder.getDims().end());
+    for (auto symbol : builder.getSymbols())
+      operands.push_back(getIndexSymbol(symbol, rewriter));
+    return operands;
+  }
+
+  /// Returns the memref for the array of `access` in loop nest `nest`. Each
+  /// array has a single memref in a loop nest so that the affine analyses can
+  /// tell when two accesses are to the same array.
+  mlir::Value getArrayHandle(mlir::Operation *nest, const ArrayAccess &access,
+                             mlir::PatternRewriter &rewriter) {
+    auto &handle = arrayHandles[{nest, access.base}];
+    if (handle)
+      return handle;
+    mlir::OpBuilder::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPoint(nest);
+    auto loc = nest->getLoc();
+    auto seqTy = fir::dyn_cast_ptrOrBoxEleTy(access.base.getType())
+                     .cast<fir::SequenceType>();
+    llvm::SmallVector<int64_t> shape(seqTy.getShape().rbegin(),
+                                     seqTy.getShape().rend());
+    auto toIndex = [&](mlir::Value value) -> mlir::Value {
+      if (auto constant = constantIntegerLike(value))
+        return rewriter.create<mlir::arith::ConstantIndexOp>(loc, *constant);
+      if (!value.getType().isa<mlir::IndexType>())
+        return rewriter.create<fir::ConvertOp>(loc, rewriter.getIndexType(),
+                                               value);
+      return value;
+    };
+    // The operands are the array, its extents unless it is boxed, and its
+    // lower bounds unless they are all one; AffineDemotion rebuilds the
+    // shape of the array from them.
+    llvm::SmallVector<mlir::Value> operands = {access.base};
+    for (auto iter : llvm::enumerate(access.extents)) {
+      if (auto constant = constantIntegerLike(iter.value()))
+        shape[shape.size() - 1 - iter.index()] = *constant;
+      operands.push_back(toIndex(iter.value()));
+    }
+    for (auto origin : access.origins)
+      operands.push_back(toIndex(origin));
+    auto memrefTy = mlir::MemRefType::get(shape, seqTy.getEleTy());
+    handle = rewriter
+                 .create<mlir::UnrealizedConversionCastOp>(
+                     loc, mlir::TypeRange{memrefTy}, operands)
+                 .getResult(0);
+    return handle;
+  }
+
+  llvm::DenseMap<mlir::Operation *, AffineLoopAnalysis> loopAnalysisMap;
+  llvm::DenseMap<mlir::Operation *, AffineIfAnalysis> ifAnalysisMap;
+
+private:
+  void collectArrays(mlir::FuncOp funcOp);
+
+  llvm::DenseMap<mlir::Value, bool> promotableArrays;
+  llvm::DenseMap<mlir::Value, mlir::Value> indexSymbols;
+  llvm::DenseMap<std::pair<mlir::Operation *, mlir::Value>, mlir::Value>
+      arrayHandles;
+};
+
+struct AffineLoopAnalysis {
+  AffineLoopAnalysis() = default;
+
+  explicit AffineLoopAnalysis(fir::DoLoopOp op, AffineFunctionAnalysis &afa)
+      : legality(analyzeLoop(op, afa)) {}
+
+  bool canPromoteToAffine() const { return legality; }
+
+  void disablePromotion() { legality = false; }
+
+  /// The loops enclosing this loop nest whose induction variables it uses. The
+  /// nest can only be promoted along with them.
+  llvm::ArrayRef<mlir::Operation *> getOuterLoops() const { return outerLoops; }
+
+private:
+  void noteOuterLoop(fir::DoLoopOp loop, mlir::Operation *outer) {
+    if (!loop->isAncestor(outer) && !llvm::is_contained(outerLoops, outer))
+      outerLoops.push_back(outer);
+  }
+
+  void noteOuterLoops(fir::DoLoopOp loop, const AffineExprBuilder &builder) {
+    for (auto dim : builder.getDims())
+      if (auto blockArg = dim.dyn_cast<mlir::BlockArgument>())
+        if (auto *owner = blockArg.getOwner()->getParentOp())
+          if (mlir::isa<fir::DoLoopOp>(owner))
+            noteOuterLoop(loop, owner);
+  }
+
+  bool analyzeBounds(fir::DoLoopOp loop) {
+    if (loop.getNumResults() != 0) {
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: loop has results\n";);
+      return false;
+    }
+    auto step = constantIntegerLike(loop.step());
+    if (!step || *step == 0) {
+      LLVM_DEBUG(llvm::dbgs()
+                     << "AffineLoopAnalysis: loop step is not a constant\n";);
+      return false;
+    }
+    AffineExprBuilder builder(loop.getContext());
+    if (!builder.build(loop.lowerBound()) ||
+        !builder.build(loop.upperBound())) {
+      LLVM_DEBUG(llvm::dbgs()
+                     << "AffineLoopAnalysis: loop bounds are not affine\n";);
+      return false;
+    }
+    noteOuterLoops(loop, builder);
+    return true;
+  }
+
+  bool analyzeIf(fir::DoLoopOp loop, fir::IfOp op) {
+    if (op.getNumResults() != 0) {
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: if has results\n";
+                 op.dump(););
+      return false;
+    }
+    AffineIfCondition condition(op.condition());
+    if (!condition.hasIntegerSet()) {
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: if condition is not "
+                                 "affine\n";
+                 op.dump(););
+      return false;
+    }
+    noteOuterLoops(loop, condition.getExprBuilder());
+    return true;
+  }
+
+  bool analyzeReference(fir::DoLoopOp loop, mlir::Value memref,
+                        mlir::Operation *op, AffineFunctionAnalysis &afa) {
+    auto acoOp = memref.getDefiningOp<ArrayCoorOp>();
+    if (!acoOp) {
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: memory reference is not "
+                                 "an array element\n";
+                 op->dump(););
+      return false;
+    }
+    if (!afa.canPromoteArray(acoOp.memref())) {
+      LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: array may be a pointer, "
+                                 "is aliased or is not invariant\n";
+                 op->dump(); acoOp.dump(););
+      return false;
+    }
+    AffineExprBuilder builder(op->getContext());
+    if (!analyzeArrayCoor(acoOp, builder))
+      return false;
+    noteOuterLoops(loop, builder);
+    return true;
+  }
+
+  /// Only loops, conditionals, array element loads and stores, and operations
+  /// without side effects may be promoted. Loops nested in this one must have
+  /// been analyzed already.
+  bool analyzeBody(fir::DoLoopOp loop, AffineFunctionAnalysis &afa) {
+    auto result = loop->walk<mlir::WalkOrder::PreOrder>(
+        [&](mlir::Operation *op) -> mlir::WalkResult {
+          if (op == loop.getOperation())
+            return mlir::WalkResult::advance();
+          if (auto inner = mlir::dyn_cast<fir::DoLoopOp>(op)) {
+            auto it = afa.loopAnalysisMap.find(op);
+            if (it == afa.loopAnalysisMap.end() ||
+                !it->second.canPromoteToAffine())
+              return mlir::WalkResult::interrupt();
+            for (auto *outer : it->second.getOuterLoops())
+              noteOuterLoop(loop, outer);
+            return mlir::WalkResult::skip();
+          }
+          bool legal = true;
+          if (auto ifOp = mlir::dyn_cast<fir::IfOp>(op))
+            legal = analyzeIf(loop, ifOp);
+          else if (auto load = mlir::dyn_cast<fir::LoadOp>(op))
+            legal = analyzeReference(loop, load.memref(), op, afa);
+          else if (auto store = mlir::dyn_cast<fir::StoreOp>(op))
+            legal = analyzeReference(loop, store.memref(), op, afa);
+          else if (!mlir::isa<fir::ResultOp>(op) &&
+                   (op->getNumRegions() != 0 ||
+                    !mlir::MemoryEffectOpInterface::hasNoEffect(op))) {
+            LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: cannot promote "
+                                       "operation\n";
+                       op->dump(););
+            legal = false;
+          }
+          return legal ? mlir::WalkResult::advance()
+                       : mlir::WalkResult::interrupt();
+        });
+    return !result.wasInterrupted();
+  }
+
+  bool analyzeLoop(fir::DoLoopOp loopOperation,
+                   AffineFunctionAnalysis &functionAnalysis) {
+    LLVM_DEBUG(llvm::dbgs() << "AffineLoopAnalysis: \n"; loopOperation.dump(););
+    return analyzeBounds(loopOperation) &&
+           analyzeBody(loopOperation, functionAnalysis);
+  }
+
+  bool legality{};
+  llvm::SmallVector<mlir::Operation *, 2> outerLoops;
+};
+
+/// Analysis for affine promotion of fir.if. Only the fir.if operations in the
+/// promoted loops are analyzed, and those have been checked by the analysis
+/// of the loop.
 struct AffineIfAnalysis {
   AffineIfAnalysis() = default;
 
   explicit AffineIfAnalysis(fir::IfOp op, AffineFunctionAnalysis &afa)
       : legality(analyzeIf(op, afa)) {}
 
-  bool canPromoteToAffine() { return legality; }
+  bool canPromoteToAffine() const { return legality; }
 
 private:
   bool analyzeIf(fir::IfOp op, AffineFunctionAnalysis &afa) {
@@ -290,155 +634,128 @@ private:
 };
 } // namespace
 
-AffineIfAnalysis
-AffineFunctionAnalysis::getChildIfAnalysis(fir::IfOp op) const {
-  auto it = ifAnalysisMap.find_as(op);
-  if (it == ifAnalysisMap.end()) {
-    LLVM_DEBUG(llvm::dbgs() << "AffineFunctionAnalysis: not computed for:\n";
-               op.dump(););
-    op.emitError("error in fetching if analysis in AffineFunctionAnalysis\n");
-    return {};
-  }
-  return it->getSecond();
-}
-
-/// AffineMap rewriting fir.array_coor operation to affine apply,
-/// %dim = fir.gendim %lowerBound, %upperBound, %stride
-/// %a = fir.array_coor %arr(%dim) %i
-/// returning affineMap = affine_map<(i)[lb, ub, st] -> (i*st - lb)>
-static mlir::AffineMap createArrayIndexAffineMap(unsigned dimensions,
-                                                 MLIRContext *context) {
-  auto index = mlir::getAffineConstantExpr(0, context);
-  auto accuExtent = mlir::getAffineConstantExpr(1, context);
-  for (unsigned i = 0; i < dimensions; ++i) {
-    mlir::AffineExpr idx = mlir::getAffineDimExpr(i, context),
-                     lowerBound = mlir::getAffineSymbolExpr(i * 3, context),
-                     currentExtent =
-                         mlir::getAffineSymbolExpr(i * 3 + 1, context),
-                     stride = mlir::getAffineSymbolExpr(i * 3 + 2, context),
-                     currentPart = (idx * stride - lowerBound) * accuExtent;
-    index = currentPart + index;
-    accuExtent = accuExtent * currentExtent;
-  }
-  return mlir::AffineMap::get(dimensions, dimensions * 3, index);
-}
-
-static Optional<int64_t> constantIntegerLike(const mlir::Value value) {
-  if (auto definition = value.getDefiningOp<mlir::arith::ConstantOp>())
-    if (auto stepAttr = definition.value().dyn_cast<IntegerAttr>())
-      return stepAttr.getInt();
-  return {};
+AffineFunctionAnalysis::AffineFunctionAnalysis(mlir::FuncOp funcOp) {
+  collectArrays(funcOp);
+  // Inner loops are analyzed before the loops that contain them.
+  funcOp.walk([&](fir::DoLoopOp op) {
+    AffineLoopAnalysis analysis(op, *this);
+    loopAnalysisMap[op] = analysis;
+  });
+  // A loop nest that uses the induction variable of an outer loop can only be
+  // promoted with that loop; outer loops are visited first.
+  funcOp.walk<mlir::WalkOrder::PreOrder>([&](fir::DoLoopOp op) {
+    auto &analysis = loopAnalysisMap[op];
+    for (auto *outer : analysis.getOuterLoops())
+      if (!loopAnalysisMap[outer].canPromoteToAffine())
+        analysis.disablePromotion();
+  });
+  funcOp.walk([&](fir::IfOp op) {
+    if (auto loop = op->getParentOfType<fir::DoLoopOp>())
+      if (canPromoteToAffine(loop))
+        ifAnalysisMap.try_emplace(op, op, *this);
+  });
 }
 
-static mlir::Type coordinateArrayElement(fir::ArrayCoorOp op) {
-  if (auto refType = op.memref().getType().dyn_cast_or_null<ReferenceType>()) {
-    if (auto seqType = refType.getEleTy().dyn_cast_or_null<SequenceType>()) {
-      return seqType.getEleTy();
+/// An array can be promoted when it is not a POINTER, when its base and
+/// bounds are defined before the loop nests that access it, and when all its
+/// accesses agree on its extents. The memrefs of distinct bases are taken as
+/// independent, so every base must be a distinct allocation: dummy
+/// arguments, POINTERs, Cray pointees and EQUIVALENCEd variables may share
+/// storage with another base, and arrays that cannot be proven distinct from
+/// every other array are not promoted.
+void AffineFunctionAnalysis::collectArrays(mlir::FuncOp funcOp) {
+  llvm::DenseMap<mlir::Value, llvm::SmallVector<mlir::Value>> arrayExtents;
+  auto isInvariant = [](mlir::Value value) {
+    return constantIntegerLike(value) || mlir::isTopLevelValue(value);
+  };
+  funcOp.walk([&](fir::ArrayCoorOp acoOp) {
+    auto base = acoOp.memref();
+    auto extents = getExtents(acoOp);
+    auto inserted = promotableArrays.try_emplace(base, true);
+    if (inserted.second) {
+      inserted.first->second =
+          !isPointer(base.getType()) && mlir::isTopLevelValue(base) &&
+          llvm::all_of(extents, isInvariant) &&
+          llvm::all_of(getOrigins(acoOp), isInvariant);
+      arrayExtents[base] = extents;
+      return;
     }
-  }
-  op.emitError(
-      "AffineLoopConversion: array type in coordinate operation not valid\n");
-  return mlir::Type();
-}
-
-static void populateIndexArgs(fir::ArrayCoorOp acoOp, fir::ShapeOp shape,
-                              SmallVectorImpl<mlir::Value> &indexArgs,
-                              mlir::PatternRewriter &rewriter) {
-  auto one = rewriter.create<mlir::arith::ConstantOp>(
-      acoOp.getLoc(), rewriter.getIndexType(), rewriter.getIndexAttr(1));
-  auto extents = shape.extents();
-  for (auto i = extents.begin(); i < extents.end(); i++) {
-    indexArgs.push_back(one);
-    indexArgs.push_back(*i);
-    indexArgs.push_back(one);
-  }
-}
-
-static void populateIndexArgs(fir::ArrayCoorOp acoOp, fir::ShapeShiftOp shape,
-                              SmallVectorImpl<mlir::Value> &indexArgs,
-                              mlir::PatternRewriter &rewriter) {
-  auto one = rewriter.create<mlir::arith::ConstantOp>(
-      acoOp.getLoc(), rewriter.getIndexType(), rewriter.getIndexAttr(1));
-  auto extents = shape.pairs();
-  for (auto i = extents.begin(); i < extents.end();) {
-    indexArgs.push_back(*i++);
-    indexArgs.push_back(*i++);
-    indexArgs.push_back(one);
-  }
+    auto &known = arrayExtents[base];
+    if (known.size() != extents.size() ||
+        !llvm::all_of(llvm::zip(known, extents), [](auto pair) {
+          return sameExtent(std::get<0>(pair), std::get<1>(pair));
+        }))
+      inserted.first->second = false;
+  });
+  for (auto &a : promotableArrays)
+    for (auto &b : promotableArrays)
+      if (a.first != b.first && !fir::isDistinctAllocation(a.first, b.first)) {
+        a.second = false;
+        b.second = false;
+      }
 }
 
-static void populateIndexArgs(fir::ArrayCoorOp acoOp, fir::SliceOp slice,
-                              SmallVectorImpl<mlir::Value> &indexArgs,
-                              mlir::PatternRewriter &rewriter) {
-  auto extents = slice.triples();
-  for (auto i = extents.begin(); i < extents.end();) {
-    indexArgs.push_back(*i++);
-    indexArgs.push_back(*i++);
-    indexArgs.push_back(*i++);
-  }
+bool AffineFunctionAnalysis::canPromoteToAffine(fir::DoLoopOp op) const {
+  auto it = loopAnalysisMap.find(op);
+  return it != loopAnalysisMap.end() && it->getSecond().canPromoteToAffine();
 }
 
-static void populateIndexArgs(fir::ArrayCoorOp acoOp,
-                              SmallVectorImpl<mlir::Value> &indexArgs,
-                              mlir::PatternRewriter &rewriter) {
-  if (auto shape = acoOp.shape().getDefiningOp<ShapeOp>())
-    return populateIndexArgs(acoOp, shape, indexArgs, rewriter);
-  if (auto shapeShift = acoOp.shape().getDefiningOp<ShapeShiftOp>())
-    return populateIndexArgs(acoOp, shapeShift, indexArgs, rewriter);
-  if (auto slice = acoOp.shape().getDefiningOp<SliceOp>())
-    return populateIndexArgs(acoOp, slice, indexArgs, rewriter);
-  return;
+bool AffineFunctionAnalysis::canPromoteToAffine(fir::IfOp op) const {
+  auto it = ifAnalysisMap.find(op);
+  return it != ifAnalysisMap.end() && it->getSecond().canPromoteToAffine();
 }
 
-/// Returns affine.apply and fir.convert from array_coor and gendims
-static std::pair<mlir::AffineApplyOp, fir::ConvertOp>
-createAffineOps(mlir::Value arrayRef, mlir::PatternRewriter &rewriter) {
-  auto acoOp = arrayRef.getDefiningOp<ArrayCoorOp>();
-  auto affineMap =
-      createArrayIndexAffineMap(acoOp.indices().size(), acoOp.getContext());
-  SmallVector<mlir::Value> indexArgs;
-  indexArgs.append(acoOp.indices().begin(), acoOp.indices().end());
-
-  populateIndexArgs(acoOp, indexArgs, rewriter);
-
-  auto affineApply = rewriter.create<mlir::AffineApplyOp>(acoOp.getLoc(),
-                                                          affineMap, indexArgs);
-  auto arrayElementType = coordinateArrayElement(acoOp);
-  auto newType = mlir::MemRefType::get({-1}, arrayElementType);
-  auto arrayConvert =
-      rewriter.create<fir::ConvertOp>(acoOp.getLoc(), newType, acoOp.memref());
-  return std::make_pair(affineApply, arrayConvert);
+/// Returns the memref, affine map and map operands addressing the array
+/// element at `memref` for the promoted memory operation `op`.
+static std::tuple<mlir::Value, mlir::AffineMap, llvm::SmallVector<mlir::Value>>
+createAffineAccess(mlir::Value memref, mlir::Operation *op,
+                   AffineFunctionAnalysis &functionAnalysis,
+                   mlir::PatternRewriter &rewriter) {
+  auto acoOp = memref.getDefiningOp<ArrayCoorOp>();
+  AffineExprBuilder builder(acoOp.getContext());
+  auto access = analyzeArrayCoor(acoOp, builder);
+  assert(access && "array access must have been analyzed");
+  auto handle =
+      functionAnalysis.getArrayHandle(getNestRoot(op), *access, rewriter);
+  return {handle, builder.getMap(access->subscripts),
+          functionAnalysis.getMapOperands(builder, rewriter)};
 }
 
-static void rewriteLoad(fir::LoadOp loadOp, mlir::PatternRewriter &rewriter) {
+static void rewriteLoad(fir::LoadOp loadOp,
+                        AffineFunctionAnalysis &functionAnalysis,
+                        mlir::PatternRewriter &rewriter) {
   rewriter.setInsertionPoint(loadOp);
-  auto affineOps = createAffineOps(loadOp.memref(), rewriter);
-  rewriter.replaceOpWithNewOp<mlir::AffineLoadOp>(
-      loadOp, affineOps.second.getResult(), affineOps.first.getResult());
+  auto [memref, map, operands] =
+      createAffineAccess(loadOp.memref(), loadOp, functionAnalysis, rewriter);
+  rewriter.replaceOpWithNewOp<mlir::AffineLoadOp>(loadOp, memref, map,
+                                                  operands);
 }
 
 static void rewriteStore(fir::StoreOp storeOp,
+                         AffineFunctionAnalysis &functionAnalysis,
                          mlir::PatternRewriter &rewriter) {
   rewriter.setInsertionPoint(storeOp);
-  auto affineOps = createAffineOps(storeOp.memref(), rewriter);
+  auto [memref, map, operands] =
+      createAffineAccess(storeOp.memref(), storeOp, functionAnalysis, rewriter);
   rewriter.replaceOpWithNewOp<mlir::AffineStoreOp>(storeOp, storeOp.value(),
-                                                   affineOps.second.getResult(),
-                                                   affineOps.first.getResult());
+                                                   memref, map, operands);
 }
 
-static void rewriteMemoryOps(Block *block, mlir::PatternRewriter &rewriter) {
+static void rewriteMemoryOps(Block *block,
+                             AffineFunctionAnalysis &functionAnalysis,
+                             mlir::PatternRewriter &rewriter) {
   for (auto &bodyOp : block->getOperations()) {
     if (isa<fir::LoadOp>(bodyOp))
-      rewriteLoad(cast<fir::LoadOp>(bodyOp), rewriter);
+      rewriteLoad(cast<fir::LoadOp>(bodyOp), functionAnalysis, rewriter);
     if (isa<fir::StoreOp>(bodyOp))
-      rewriteStore(cast<fir::StoreOp>(bodyOp), rewriter);
+      rewriteStore(cast<fir::StoreOp>(bodyOp), functionAnalysis, rewriter);
   }
 }
 
 namespace {
-/// Convert `fir.do_loop` to `affine.for`, creates fir.convert for arrays to
-/// memref, rewrites array_coor to affine.apply with affine_map. Rewrites fir
-/// loads and stores to affine.
+/// Convert `fir.do_loop` to `affine.for`, creates memrefs for the arrays and
+/// rewrites fir loads and stores of array elements to affine loads and stores
+/// with the subscripts of the elements as affine maps.
 class AffineLoopConversion : public mlir::OpRewritePattern<fir::DoLoopOp> {
 public:
   using OpRewritePattern::OpRewritePattern;
@@ -450,8 +767,6 @@ public:
                   mlir::PatternRewriter &rewriter) const override {
     LLVM_DEBUG(llvm::dbgs() << "AffineLoopConversion: rewriting loop:\n";
                loop.dump(););
-    LLVM_ATTRIBUTE_UNUSED auto loopAnalysis =
-        functionAnalysis.getChildLoopAnalysis(loop);
     auto &loopOps = loop.getBody()->getOperations();
     auto loopAndIndex = createAffineFor(loop, rewriter);
     auto affineFor = loopAndIndex.first;
@@ -467,7 +782,7 @@ public:
     loop.getInductionVar().replaceAllUsesWith(inductionVar);
     rewriter.finalizeRootUpdate(loop.getOperation());
 
-    rewriteMemoryOps(affineFor.getBody(), rewriter);
+    rewriteMemoryOps(affineFor.getBody(), functionAnalysis, rewriter);
 
     LLVM_DEBUG(llvm::dbgs() << "AffineLoopConversion: loop rewriten to:\n";
                affineFor.dump(););
@@ -478,53 +793,46 @@ public:
 private:
   std::pair<mlir::AffineForOp, mlir::Value>
   createAffineFor(fir::DoLoopOp op, mlir::PatternRewriter &rewriter) const {
-    if (auto constantStep = constantIntegerLike(op.step()))
-      if (constantStep.getValue() > 0)
-        return positiveConstantStep(op, constantStep.getValue(), rewriter);
-    return genericBounds(op, rewriter);
+    auto step = *constantIntegerLike(op.step());
+    AffineExprBuilder builder(op.getContext());
+    auto lowerBound = *builder.build(op.lowerBound());
+    auto upperBound = *builder.build(op.upperBound());
+    if (step > 0)
+      return positiveConstantStep(op, builder, lowerBound, upperBound, step,
+                                  rewriter);
+    return negativeConstantStep(op, builder, lowerBound, upperBound, step,
+                                rewriter);
   }
 
   // when step for the loop is positive compile time constant
   std::pair<mlir::AffineForOp, mlir::Value>
-  positiveConstantStep(fir::DoLoopOp op, int64_t step,
-                       mlir::PatternRewriter &rewriter) const {
+  positiveConstantStep(fir::DoLoopOp op, const AffineExprBuilder &builder,
+                       mlir::AffineExpr lowerBound, mlir::AffineExpr upperBound,
+                       int64_t step, mlir::PatternRewriter &rewriter) const {
+    auto operands = functionAnalysis.getMapOperands(builder, rewriter);
     auto affineFor = rewriter.create<mlir::AffineForOp>(
-        op.getLoc(), ValueRange(op.lowerBound()),
-        mlir::AffineMap::get(0, 1,
-                             mlir::getAffineSymbolExpr(0, op.getContext())),
-        ValueRange(op.upperBound()),
-        mlir::AffineMap::get(0, 1,
-                             1 + mlir::getAffineSymbolExpr(0, op.getContext())),
-        step);
+        op.getLoc(), operands, builder.getMap(lowerBound), operands,
+        builder.getMap(upperBound + 1), step);
     return std::make_pair(affineFor, affineFor.getInductionVar());
   }
 
+  // when step for the loop is negative compile time constant, the loop counts
+  // its iterations upward and computes the index from the iteration
   std::pair<mlir::AffineForOp, mlir::Value>
-  genericBounds(fir::DoLoopOp op, mlir::PatternRewriter &rewriter) const {
-    auto lowerBound = mlir::getAffineSymbolExpr(0, op.getContext());
-    auto upperBound = mlir::getAffineSymbolExpr(1, op.getContext());
-    auto step = mlir::getAffineSymbolExpr(2, op.getContext());
-    mlir::AffineMap upperBoundMap = mlir::AffineMap::get(
-        0, 3, (upperBound - lowerBound + step).floorDiv(step));
-    auto genericUpperBound = rewriter.create<mlir::AffineApplyOp>(
-        op.getLoc(), upperBoundMap,
-        ValueRange({op.lowerBound(), op.upperBound(), op.step()}));
-    auto actualIndexMap = mlir::AffineMap::get(
-        1, 2,
-        (lowerBound + mlir::getAffineDimExpr(0, op.getContext())) *
-            mlir::getAffineSymbolExpr(1, op.getContext()));
-
+  negativeConstantStep(fir::DoLoopOp op, AffineExprBuilder &builder,
+                       mlir::AffineExpr lowerBound, mlir::AffineExpr upperBound,
+                       int64_t step, mlir::PatternRewriter &rewriter) const {
+    auto tripCount = (lowerBound - upperBound - step).floorDiv(-step);
     auto affineFor = rewriter.create<mlir::AffineForOp>(
         op.getLoc(), ValueRange(),
         AffineMap::getConstantMap(0, op.getContext()),
-        genericUpperBound.getResult(),
-        mlir::AffineMap::get(0, 1,
-                             1 + mlir::getAffineSymbolExpr(0, op.getContext())),
-        1);
+        functionAnalysis.getMapOperands(builder, rewriter),
+        builder.getMap(tripCount), 1);
+    auto iteration = builder.dim(affineFor.getInductionVar());
     rewriter.setInsertionPointToStart(affineFor.getBody());
     auto actualIndex = rewriter.create<mlir::AffineApplyOp>(
-        op.getLoc(), actualIndexMap,
-        ValueRange({affineFor.getInductionVar(), op.lowerBound(), op.step()}));
+        op.getLoc(), builder.getMap(lowerBound + iteration * step),
+        functionAnalysis.getMapOperands(builder, rewriter));
     return std::make_pair(affineFor, actualIndex.getResult());
   }
 
@@ -536,7 +844,7 @@ class AffineIfConversion : public mlir::OpRewritePattern<fir::IfOp> {
 public:
   using OpRewritePattern::OpRewritePattern;
   AffineIfConversion(mlir::MLIRContext *context, AffineFunctionAnalysis &afa)
-      : OpRewritePattern(context) {}
+      : OpRewritePattern(context), functionAnalysis(afa) {}
   mlir::LogicalResult
   matchAndRewrite(fir::IfOp op,
                   mlir::PatternRewriter &rewriter) const override {
@@ -552,7 +860,9 @@ public:
     }
     auto affineIf = rewriter.create<mlir::AffineIfOp>(
         op.getLoc(), affineCondition.getIntegerSet(),
-        affineCondition.getAffineArgs(), !op.elseRegion().empty());
+        functionAnalysis.getMapOperands(affineCondition.getExprBuilder(),
+                                        rewriter),
+        !op.elseRegion().empty());
     rewriter.startRootUpdate(affineIf);
     affineIf.getThenBlock()->getOperations().splice(
         std::prev(affineIf.getThenBlock()->end()), ifOps, ifOps.begin(),
@@ -564,13 +874,18 @@ public:
           std::prev(otherOps.end()));
     }
     rewriter.finalizeRootUpdate(affineIf);
-    rewriteMemoryOps(affineIf.getBody(), rewriter);
+    rewriteMemoryOps(affineIf.getThenBlock(), functionAnalysis, rewriter);
+    if (affineIf.hasElse())
+      rewriteMemoryOps(affineIf.getElseBlock(), functionAnalysis, rewriter);
 
     LLVM_DEBUG(llvm::dbgs() << "AffineIfConversion: if converted to:\n";
                affineIf.dump(););
     rewriter.replaceOp(op, affineIf.getOperation()->getResults());
     return success();
   }
+
+private:
+  AffineFunctionAnalysis &functionAnalysis;
 };
 
 /// Promote fir.do_loop and fir.if to affine.for and affine.if, in the cases
@@ -582,7 +897,6 @@ public:
 
     auto *context = &getContext();
     auto function = getFunction();
-    markAllAnalysesPreserved();
     auto functionAnalysis = AffineFunctionAnalysis(function);
     mlir::OwningRewritePatternList patterns(context);
     patterns.insert<AffineIfConversion>(context, functionAnalysis);
@@ -591,13 +905,14 @@ public:
     target.addLegalDialect<
         mlir::AffineDialect, FIROpsDialect, mlir::scf::SCFDialect,
         mlir::arith::ArithmeticDialect, mlir::StandardOpsDialect>();
+    target.addLegalOp<mlir::UnrealizedConversionCastOp>();
     target.addDynamicallyLegalOp<IfOp>([&functionAnalysis](fir::IfOp op) {
-      return !(functionAnalysis.getChildIfAnalysis(op).canPromoteToAffine());
-    });
-    target.addDynamicallyLegalOp<DoLoopOp>([&functionAnalysis](
-                                               fir::DoLoopOp op) {
-      return !(functionAnalysis.getChildLoopAnalysis(op).canPromoteToAffine());
+      return !functionAnalysis.canPromoteToAffine(op);
     });
+    target.addDynamicallyLegalOp<DoLoopOp>(
+        [&functionAnalysis](fir::DoLoopOp op) {
+          return !functionAnalysis.canPromoteToAffine(op);
+        });
 
     LLVM_DEBUG(llvm::dbgs()
                    << "AffineDialectPromotion: running promotion on: \n";
@@ -0,0 +1,865 @@
+//===-- ArrayValueCopy.cpp ------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Lower the array value operations (fir.array_load, fir.array_fetch,
+// fir.array_update, fir.array_modify, and fir.array_merge_store) to
+// operations on memory.
+//
+// An array value is immutable, so an assignment such as `a(2:n) = a(1:n-1)`
+// has to behave as if the right-hand side were evaluated in its entirety
+// before any element of `a` is modified. Copying the destination to a
+// temporary and back achieves this but doubles the memory traffic of every
+// array assignment. Instead, for each fir.array_merge_store, the elements
+// read by every fir.array_fetch from the same memory are compared with the
+// elements written by the updates that reach the merge. When the subscripts
+// of both are the same loop induction variables plus constants, the number
+// of iterations between the read of an element and its update is known.
+//
+//   - If no element can be read after it is updated, the updates are made
+//     directly to the destination.
+//   - If elements are read only after being updated by earlier iterations
+//     of an unordered loop, that loop is run backward and the updates are
+//     made directly to the destination.
+//   - Otherwise, the updates are made to a heap temporary that holds a copy
+//     of the destination and is copied back at the merge.
+//
+// Loops whose iterations now depend on one another lose their unordered
+// attribute.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "flang/Optimizer/Dialect/FIRDialect.h"
+#include "flang/Optimizer/Dialect/FIROps.h"
+#include "flang/Optimizer/Dialect/FIROpsSupport.h"
+#include "flang/Optimizer/Dialect/FIRType.h"
+#include "flang/Optimizer/Support/Utils.h"
+#include "flang/Optimizer/Transforms/Passes.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/Transforms/DialectConversion.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "flang-array-value-copy"
+
+namespace {
+
+/// An integer of the form `root + offset`. A null `root` denotes the constant
+/// `offset`.
+struct ShiftedValue {
+  mlir::Value root;
+  std::int64_t offset{0};
+};
+
+/// The position of an accessed element along one dimension of an array in
+/// memory, `base + stride * index`. The stride is zero when a slice fixes the
+/// subscript of the dimension, and unknown when it is not a constant.
+struct Subscript {
+  ShiftedValue base;
+  mlir::Value strideValue;
+  llvm::Optional<std::int64_t> stride;
+  ShiftedValue index;
+};
+
+/// How the elements read by a fetch relate to those written by an update
+/// when both operate on the same memory.
+enum class Dependence {
+  None,     // no element is read after it is updated
+  Forward,  // correct if the carrying loop runs forward
+  Backward, // correct if the carrying loop runs backward
+  Unknown
+};
+
+/// The heap temporary that receives the updates of an array value.
+struct Temporary {
+  mlir::Value memref;
+  mlir::Value shape;
+  llvm::SmallVector<mlir::Value> extents;
+};
+
+/// Decides, for each fir.array_merge_store, whether its updates can be made
+/// in place and which loops must then run backward.
+class ArrayCopyAnalysis {
+public:
+  explicit ArrayCopyAnalysis(mlir::Operation *root);
+
+  bool failed() const { return failed_; }
+
+  /// The array_load whose value is updated by `op`, a fir.array_update or
+  /// fir.array_modify.
+  fir::ArrayLoadOp getDestination(mlir::Operation *op) const {
+    return destinations_.lookup(op);
+  }
+
+  /// The array_loads whose updates require a temporary.
+  llvm::ArrayRef<fir::ArrayLoadOp> getCopies() const { return copies_; }
+
+  /// The loops that now carry a dependence, mapped to true when they must
+  /// run backward.
+  const llvm::MapVector<mlir::Operation *, bool> &getLoopDirections() const {
+    return directions_;
+  }
+
+private:
+  void analyze(fir::ArrayMergeStoreOp store,
+               llvm::ArrayRef<fir::ArrayFetchOp> fetches);
+
+  bool failed_{false};
+  llvm::DenseMap<mlir::Operation *, fir::ArrayLoadOp> destinations_;
+  llvm::SmallVector<fir::ArrayLoadOp> copies_;
+  llvm::MapVector<mlir::Operation *, bool> directions_;
+};
+} // namespace
+
+/// Split `value` into a root and a constant offset, looking through integer
+/// conversions and additions or subtractions of constants.
+static ShiftedValue decompose(mlir::Value value) {
+  std::int64_t offset = 0;
+  while (true) {
+    if (auto c = fir::getIntIfConstant(value))
+      return {{}, offset + *c};
+    if (auto conv = value.getDefiningOp<fir::ConvertOp>()) {
+      if (conv.value().getType().isIntOrIndex()) {
+        value = conv.value();
+        continue;
+      }
+    } else if (auto add = value.getDefiningOp<mlir::arith::AddIOp>()) {
+      if (auto c = fir::getIntIfConstant(add.rhs())) {
+        offset += *c;
+        value = add.lhs();
+        continue;
+      }
+      if (auto c = fir::getIntIfConstant(add.lhs())) {
+        offset += *c;
+        value = add.rhs();
+        continue;
+      }
+    } else if (auto sub = value.getDefiningOp<mlir::arith::SubIOp>()) {
+      if (auto c = fir::getIntIfConstant(sub.rhs())) {
+        offset -= *c;
+        value = sub.lhs();
+        continue;
+      }
+    }
+    return {value, offset};
+  }
+}
+
+static bool isScalarSliceDim(fir::SliceOp slice, unsigned dim) {
+  return mlir::isa_and_nonnull<fir::UndefOp>(
+      slice.triples()[3 * dim + 1].getDefiningOp());
+}
+
+static fir::SequenceType getMemrefType(fir::ArrayLoadOp load) {
+  return fir::dyn_cast_ptrOrBoxEleTy(load.memref().getType())
+      .cast<fir::SequenceType>();
+}
+
+/// The lower bound of dimension `dim` of the array loaded by `load`.
+static ShiftedValue getLowerBound(fir::ArrayLoadOp load, unsigned dim) {
+  if (auto shape = load.shape()) {
+    if (shape.getDefiningOp<fir::ShapeOp>())
+      return {{}, 1};
+    if (auto shapeShift = shape.getDefiningOp<fir::ShapeShiftOp>())
+      return decompose(shapeShift.getOrigins()[dim]);
+    if (auto shift = shape.getDefiningOp<fir::ShiftOp>())
+      return decompose(shift.getOrigins()[dim]);
+    return {shape, 0};
+  }
+  // A descriptor carries its own lower bounds.
+  if (load.memref().getType().isa<fir::BoxType>())
+    return {load.memref(), 0};
+  return {{}, 1};
+}
+
+/// Compute the subscripts in memory of the element at `indices` of the array
+/// value of `load`. Returns false if the slice projects a component.
+static bool getSubscripts(fir::ArrayLoadOp load, mlir::ValueRange indices,
+                          llvm::SmallVectorImpl<Subscript> &subscripts) {
+  fir::SliceOp slice;
+  if (auto sliceVal = load.slice()) {
+    slice = sliceVal.getDefiningOp<fir::SliceOp>();
+    if (!slice || !slice.fields().empty())
+      return false;
+  }
+  unsigned next = 0;
+  for (unsigned dim = 0, rank = getMemrefType(load).getDimension(); dim < rank;
+       ++dim) {
+    Subscript sub;
+    if (slice) {
+      auto triples = slice.triples();
+      sub.base = decompose(triples[3 * dim]);
+      if (isScalarSliceDim(slice, dim)) {
+        sub.stride = 0;
+        subscripts.push_back(sub);
+        continue;
+      }
+      sub.strideValue = triples[3 * dim + 2];
+      sub.stride = fir::getIntIfConstant(sub.strideValue);
+    } else {
+      sub.base = getLowerBound(load, dim);
+      sub.stride = 1;
+    }
+    if (next >= indices.size())
+      return false;
+    sub.index = decompose(indices[next++]);
+    subscripts.push_back(sub);
+  }
+  return true;
+}
+
+static mlir::ValueRange getIndices(mlir::Operation *update) {
+  if (auto op = mlir::dyn_cast<fir::ArrayUpdateOp>(update))
+    return op.indices();
+  return mlir::cast<fir::ArrayModifyOp>(update).indices();
+}
+
+/// Collect the loops, outermost first, that enclose `op` and are nested in
+/// `block`. Returns the ancestor of `op` in `block`, or null if there is none.
+static mlir::Operation *
+getLoopNest(mlir::Operation *op, mlir::Block *block,
+            llvm::SmallVectorImpl<mlir::Operation *> &nest) {
+  while (op && op->getBlock() != block) {
+    op = op->getParentOp();
+    if (mlir::isa_and_nonnull<fir::DoLoopOp, fir::IterWhileOp>(op))
+      nest.push_back(op);
+  }
+  std::reverse(nest.begin(), nest.end());
+  return op;
+}
+
+/// Does `a` execute before `b` in every iteration of the loops enclosing both?
+static bool executesBefore(mlir::Operation *a, mlir::Operation *b) {
+  if (auto *ancestor = a->getBlock()->findAncestorOpInBlock(*b))
+    return ancestor != a && a->isBeforeInBlock(ancestor);
+  if (auto *ancestor = b->getBlock()->findAncestorOpInBlock(*a))
+    return ancestor->isBeforeInBlock(b);
+  return false;
+}
+
+/// Return the kind of dependence of the update `update` of the array value
+/// of `dest` on `fetch`, which reads the same memory. If the dependence is
+/// carried by a loop, that loop is returned in `carrier`.
+static Dependence analyzeDependence(fir::ArrayFetchOp fetch,
+                                    mlir::Operation *update,
+                                    fir::ArrayLoadOp dest, mlir::Block *block,
+                                    mlir::Operation *&carrier) {
+  llvm::SmallVector<mlir::Operation *> fetchNest;
+  llvm::SmallVector<mlir::Operation *> nest;
+  auto *fetchTop = getLoopNest(fetch, block, fetchNest);
+  auto *updateTop = getLoopNest(update, block, nest);
+  if (!fetchTop || !updateTop)
+    return Dependence::Unknown;
+  if (fetchTop != updateTop)
+    return fetchTop->isBeforeInBlock(updateTop) ? Dependence::None
+                                                : Dependence::Unknown;
+  if (fetchNest != nest)
+    return Dependence::Unknown;
+
+  auto load = fetch.sequence().getDefiningOp<fir::ArrayLoadOp>();
+  if (load.shape() != dest.shape())
+    return Dependence::Unknown;
+  llvm::SmallVector<Subscript> reads;
+  llvm::SmallVector<Subscript> writes;
+  if (!getSubscripts(load, fetch.indices(), reads) ||
+      !getSubscripts(dest, getIndices(update), writes))
+    return Dependence::Unknown;
+
+  // The read of an element in iteration `i` of nest[j] is of the element
+  // that is updated in iteration `i + distance[j]`.
+  llvm::SmallVector<llvm::Optional<std::int64_t>> distance(nest.size());
+  for (auto [read, write] : llvm::zip(reads, writes)) {
+    if (read.base.root != write.base.root)
+      return Dependence::Unknown;
+    if (read.stride ? read.stride != write.stride
+                    : !read.strideValue ||
+                          read.strideValue != write.strideValue)
+      return Dependence::Unknown;
+    if (read.index.root != write.index.root)
+      return Dependence::Unknown;
+    auto delta = read.base.offset - write.base.offset;
+    auto indexDelta = read.index.offset - write.index.offset;
+    auto *loopIt = nest.end();
+    if (auto arg = read.index.root.dyn_cast_or_null<mlir::BlockArgument>())
+      if (auto loop =
+              mlir::dyn_cast<fir::DoLoopOp>(arg.getOwner()->getParentOp()))
+        if (loop.getInductionVar() == arg)
+          loopIt = llvm::find(nest, loop.getOperation());
+    if (loopIt == nest.end()) {
+      // The subscript is the same in every iteration of the nest.
+      if (read.index.root && !nest.empty() &&
+          nest.front()->isAncestor(
+              read.index.root.getParentRegion()->getParentOp()))
+        return Dependence::Unknown;
+      if (!read.stride) {
+        if (delta != 0 || indexDelta != 0)
+          return Dependence::Unknown;
+        continue;
+      }
+      if (delta + *read.stride * indexDelta != 0)
+        return Dependence::None;
+      continue;
+    }
+    std::int64_t d = indexDelta;
+    if (delta != 0) {
+      if (!read.stride || *read.stride == 0)
+        return Dependence::Unknown;
+      if (delta % *read.stride != 0)
+        return Dependence::None;
+      d += delta / *read.stride;
+    }
+    auto loop = mlir::cast<fir::DoLoopOp>(*loopIt);
+    auto step = fir::getIntIfConstant(loop.step());
+    if (!step || *step <= 0) {
+      if (d != 0)
+        return Dependence::Unknown;
+    } else if (d % *step != 0) {
+      return Dependence::None;
+    }
+    auto &dist = distance[loopIt - nest.begin()];
+    if (dist && *dist != d)
+      return Dependence::None;
+    dist = d;
+  }
+
+  // Every element is accessed in all iterations of a loop that does not
+  // appear in the subscripts.
+  for (auto &dist : distance)
+    if (!dist)
+      return Dependence::Unknown;
+  for (auto [dist, loop] : llvm::zip(distance, nest))
+    if (*dist != 0) {
+      carrier = loop;
+      return *dist > 0 ? Dependence::Forward : Dependence::Backward;
+    }
+  return executesBefore(fetch, update) ? Dependence::None
+                                       : Dependence::Unknown;
+}
+
+/// Might `a` and `b` refer to overlapping memory? Returns true in `same`
+/// if they are the same reference, in which case their accesses can be
+/// compared. Only references to distinct allocations are known not to
+/// overlap; dummy arguments, POINTERs and EQUIVALENCEd variables may all
+/// share storage.
+static bool mayAlias(mlir::Value a, mlir::Value b, bool &same) {
+  same = a == b;
+  return same || !fir::isDistinctAllocation(a, b);
+}
+
+/// Collect the fir.array_update and fir.array_modify operations in the chain
+/// of array values that starts with the value of `load`. Returns false if a
+/// value in the chain has a use that this pass does not understand.
+static bool collectUpdates(fir::ArrayLoadOp load,
+                           llvm::SmallVectorImpl<mlir::Operation *> &updates) {
+  llvm::SmallVector<mlir::Value> worklist{load.getResult()};
+  llvm::DenseSet<mlir::Value> visited;
+  auto visitLoop = [&](auto loop, unsigned operandNumber) {
+    if (operandNumber < loop.getNumControlOperands())
+      return false;
+    auto i = operandNumber - loop.getNumControlOperands();
+    worklist.push_back(loop.getRegionIterArgs()[i]);
+    worklist.push_back(loop.getResult(
+        i + loop.getNumResults() - loop.getNumIterOperands()));
+    return true;
+  };
+  while (!worklist.empty()) {
+    auto value = worklist.pop_back_val();
+    if (!visited.insert(value).second)
+      continue;
+    for (auto &use : value.getUses()) {
+      auto *user = use.getOwner();
+      auto operandNumber = use.getOperandNumber();
+      if (mlir::isa<fir::ArrayFetchOp, fir::ArrayMergeStoreOp>(user))
+        continue;
+      if (auto update = mlir::dyn_cast<fir::ArrayUpdateOp>(user)) {
+        if (operandNumber != 0)
+          return false;
+        updates.push_back(user);
+        worklist.push_back(update.getResult());
+      } else if (auto modify = mlir::dyn_cast<fir::ArrayModifyOp>(user)) {
+        updates.push_back(user);
+        worklist.push_back(modify.getResult(1));
+      } else if (auto loop = mlir::dyn_cast<fir::DoLoopOp>(user)) {
+        if (!visitLoop(loop, operandNumber))
+          return false;
+      } else if (auto loop = mlir::dyn_cast<fir::IterWhileOp>(user)) {
+        if (!visitLoop(loop, operandNumber))
+          return false;
+      } else if (mlir::isa<fir::ResultOp>(user)) {
+        auto *parent = user->getParentOp();
+        worklist.push_back(parent->getResult(
+            operandNumber + parent->getNumResults() - user->getNumOperands()));
+      } else {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+ArrayCopyAnalysis::ArrayCopyAnalysis(mlir::Operation *root) {
+  llvm::SmallVector<fir::ArrayFetchOp> fetches;
+  llvm::SmallVector<fir::ArrayMergeStoreOp> stores;
+  root->walk([&](mlir::Operation *op) {
+    if (auto fetch = mlir::dyn_cast<fir::ArrayFetchOp>(op))
+      fetches.push_back(fetch);
+    else if (auto store = mlir::dyn_cast<fir::ArrayMergeStoreOp>(op))
+      stores.push_back(store);
+  });
+  for (auto store : stores)
+    analyze(store, fetches);
+}
+
+void ArrayCopyAnalysis::analyze(fir::ArrayMergeStoreOp store,
+                                llvm::ArrayRef<fir::ArrayFetchOp> fetches) {
+  auto dest = store.original().getDefiningOp<fir::ArrayLoadOp>();
+  llvm::SmallVector<mlir::Operation *> updates;
+  if (dest.memref() != store.memref() || !collectUpdates(dest, updates)) {
+    store.emitOpError("cannot lower this array value to memory operations");
+    failed_ = true;
+    return;
+  }
+  for (auto *update : updates)
+    destinations_[update] = dest;
+
+  auto *block = store->getBlock();
+  llvm::MapVector<mlir::Operation *, bool> required;
+  bool copy = false;
+  for (auto fetch : fetches) {
+    auto load = fetch.sequence().getDefiningOp<fir::ArrayLoadOp>();
+    bool same = false;
+    if (!mayAlias(load.memref(), store.memref(), same))
+      continue;
+    // Only fetches in the statement that ends with the merge are of concern.
+    auto *fetchTop = block->findAncestorOpInBlock(*fetch);
+    if (!fetchTop || !fetchTop->isBeforeInBlock(store) ||
+        !executesBefore(dest, fetch))
+      continue;
+    if (!same) {
+      copy = true;
+      break;
+    }
+    for (auto *update : updates) {
+      mlir::Operation *carrier = nullptr;
+      auto dependence = analyzeDependence(fetch, update, dest, block, carrier);
+      if (dependence == Dependence::None)
+        continue;
+      if (dependence == Dependence::Unknown) {
+        copy = true;
+        break;
+      }
+      auto backward = dependence == Dependence::Backward;
+      if (required.insert({carrier, backward}).first->second != backward) {
+        copy = true;
+        break;
+      }
+    }
+    if (copy)
+      break;
+  }
+
+  if (!copy)
+    for (auto [op, backward] : required) {
+      // Only a loop whose iterations may run in any order can be reversed.
+      auto loop = mlir::cast<fir::DoLoopOp>(op);
+      if (backward && !loop.unordered())
+        copy = true;
+      auto it = directions_.find(op);
+      if (it != directions_.end() && it->second != backward)
+        copy = true;
+    }
+  LLVM_DEBUG(llvm::dbgs() << "array-value-copy: "
+                          << (copy ? "temporary for " : "in place ") << store
+                          << '\n');
+  if (copy) {
+    if (!dest.typeparams().empty()) {
+      store.emitOpError(
+          "not yet implemented: temporary array with length parameters");
+      failed_ = true;
+    }
+    copies_.push_back(dest);
+    return;
+  }
+  for (auto [op, backward] : required)
+    directions_.insert({op, backward});
+}
+
+static mlir::Value toIndex(mlir::OpBuilder &builder, mlir::Location loc,
+                           mlir::Value value) {
+  auto idxTy = builder.getIndexType();
+  if (value.getType() == idxTy)
+    return value;
+  return builder.create<fir::ConvertOp>(loc, idxTy, value);
+}
+
+/// The lower bounds, as indices, of an array with shape `shape`.
+static llvm::SmallVector<mlir::Value> getOrigins(mlir::OpBuilder &builder,
+                                                 mlir::Location loc,
+                                                 mlir::Value shape,
+                                                 unsigned rank) {
+  llvm::SmallVector<mlir::Value> origins;
+  std::vector<mlir::Value> bounds;
+  if (shape) {
+    if (auto shapeShift = shape.getDefiningOp<fir::ShapeShiftOp>())
+      bounds = shapeShift.getOrigins();
+    else if (auto shift = shape.getDefiningOp<fir::ShiftOp>())
+      bounds = shift.getOrigins();
+  }
+  for (auto bound : bounds)
+    origins.push_back(toIndex(builder, loc, bound));
+  if (origins.empty())
+    origins.append(rank,
+                   builder.create<mlir::arith::ConstantIndexOp>(loc, 1));
+  return origins;
+}
+
+/// Generate the address of the element at the zero-based `indices` of the
+/// array value of an array_load of `memref`.
+static mlir::Value genElementAddress(mlir::OpBuilder &builder,
+                                     mlir::Location loc, mlir::Value memref,
+                                     mlir::Value shape, mlir::Value slice,
+                                     mlir::ValueRange indices,
+                                     mlir::ValueRange typeparams,
+                                     mlir::Type arrayTy) {
+  auto rank = fir::dyn_cast_ptrOrBoxEleTy(memref.getType())
+                  .cast<fir::SequenceType>()
+                  .getDimension();
+  auto origins = getOrigins(builder, loc, shape, rank);
+  auto sliceOp = slice ? slice.getDefiningOp<fir::SliceOp>() : fir::SliceOp{};
+  llvm::SmallVector<mlir::Value> coor;
+  unsigned next = 0;
+  for (unsigned dim = 0; dim < rank; ++dim) {
+    if (sliceOp && isScalarSliceDim(sliceOp, dim)) {
+      coor.push_back(origins[dim]);
+      continue;
+    }
+    auto index = toIndex(builder, loc, indices[next++]);
+    coor.push_back(
+        builder.create<mlir::arith::AddIOp>(loc, index, origins[dim]));
+  }
+  auto eleTy = arrayTy.cast<fir::SequenceType>().getEleTy();
+  mlir::Value addr = builder.create<fir::ArrayCoorOp>(
+      loc, fir::ReferenceType::get(eleTy), memref, shape, slice, coor,
+      typeparams);
+  if (next < indices.size()) {
+    auto path = indices.drop_front(next);
+    auto ty = fir::applyPathToType(eleTy, path);
+    addr = builder.create<fir::CoordinateOp>(loc, fir::ReferenceType::get(ty),
+                                             addr, path);
+  }
+  return addr;
+}
+
+/// The extents, as indices, of the array loaded by `load`.
+static llvm::SmallVector<mlir::Value> getExtents(mlir::OpBuilder &builder,
+                                                 mlir::Location loc,
+                                                 fir::ArrayLoadOp load) {
+  llvm::SmallVector<mlir::Value> extents;
+  for (auto extent : load.getExtents())
+    extents.push_back(toIndex(builder, loc, extent));
+  if (!extents.empty())
+    return extents;
+  auto seqTy = getMemrefType(load);
+  auto idxTy = builder.getIndexType();
+  for (auto dim : llvm::enumerate(seqTy.getShape())) {
+    if (load.memref().getType().isa<fir::BoxType>()) {
+      auto dimVal =
+          builder.create<mlir::arith::ConstantIndexOp>(loc, dim.index());
+      auto dims = builder.create<fir::BoxDimsOp>(loc, idxTy, idxTy, idxTy,
+                                                 load.memref(), dimVal);
+      extents.push_back(dims.getResult(1));
+    } else {
+      extents.push_back(
+          builder.create<mlir::arith::ConstantIndexOp>(loc, dim.value()));
+    }
+  }
+  return extents;
+}
+
+/// Copy every element of the array at `from` to the array at `to`. Both have
+/// the extents `extents` and the lower bounds given by their shapes.
+static void genArrayCopy(mlir::OpBuilder &builder, mlir::Location loc,
+                         mlir::Value to, mlir::Value toShape, mlir::Value from,
+                         mlir::Value fromShape,
+                         llvm::ArrayRef<mlir::Value> extents) {
+  auto insPt = builder.saveInsertionPoint();
+  auto zero = builder.create<mlir::arith::ConstantIndexOp>(loc, 0);
+  auto one = builder.create<mlir::arith::ConstantIndexOp>(loc, 1);
+  // Iterate over the leftmost dimension in the innermost loop.
+  llvm::SmallVector<mlir::Value> indices(extents.size());
+  for (auto dim : llvm::reverse(llvm::seq<std::size_t>(0, extents.size()))) {
+    auto ub = builder.create<mlir::arith::SubIOp>(loc, extents[dim], one);
+    auto loop = builder.create<fir::DoLoopOp>(loc, zero, ub, one,
+                                              /*unordered=*/true);
+    builder.setInsertionPointToStart(loop.getBody());
+    indices[dim] = loop.getInductionVar();
+  }
+  auto arrTy = fir::dyn_cast_ptrOrBoxEleTy(from.getType());
+  auto fromAddr = genElementAddress(builder, loc, from, fromShape, {}, indices,
+                                    {}, arrTy);
+  auto toAddr =
+      genElementAddress(builder, loc, to, toShape, {}, indices, {}, arrTy);
+  auto value = builder.create<fir::LoadOp>(loc, fromAddr);
+  builder.create<fir::StoreOp>(loc, value, toAddr);
+  builder.restoreInsertionPoint(insPt);
+}
+
+/// Allocate a temporary with the shape and contents of the array loaded by
+/// `load`.
+static Temporary genTemporary(mlir::OpBuilder &builder, fir::ArrayLoadOp load) {
+  auto loc = load.getLoc();
+  builder.setInsertionPointAfter(load);
+  Temporary temp;
+  temp.extents = getExtents(builder, loc, load);
+  auto seqTy = getMemrefType(load);
+  llvm::SmallVector<mlir::Value> dynamicExtents;
+  for (auto dim : llvm::enumerate(seqTy.getShape()))
+    if (dim.value() == fir::SequenceType::getUnknownExtent())
+      dynamicExtents.push_back(temp.extents[dim.index()]);
+  temp.memref = builder.create<fir::AllocMemOp>(loc, seqTy, llvm::None,
+                                                dynamicExtents);
+  auto shape = load.shape();
+  auto rank = seqTy.getDimension();
+  if (shape && !shape.getDefiningOp<fir::ShiftOp>()) {
+    temp.shape = shape;
+  } else if (shape) {
+    // The temporary is not a descriptor, so it takes a shape and shift.
+    llvm::SmallVector<mlir::Value> pairs;
+    for (auto [origin, extent] :
+         llvm::zip(getOrigins(builder, loc, shape, rank), temp.extents)) {
+      pairs.push_back(origin);
+      pairs.push_back(extent);
+    }
+    temp.shape = builder.create<fir::ShapeShiftOp>(
+        loc, fir::ShapeShiftType::get(builder.getContext(), rank), pairs);
+  } else {
+    temp.shape = builder.create<fir::ShapeOp>(
+        loc, fir::ShapeType::get(builder.getContext(), rank), temp.extents);
+  }
+  genArrayCopy(builder, loc, temp.memref, temp.shape, load.memref(), shape,
+               temp.extents);
+  return temp;
+}
+
+/// Run the loop `loop` backward by replacing its induction variable in the
+/// body with `lb + last - iv`, where `last` is the value of the induction
+/// variable in the last iteration.
+static void reverseLoop(mlir::OpBuilder &builder, fir::DoLoopOp loop) {
+  auto loc = loop.getLoc();
+  builder.setInsertionPoint(loop);
+  mlir::Value lb = loop.lowerBound();
+  mlir::Value last = loop.upperBound();
+  if (fir::getIntIfConstant(loop.step()) != 1) {
+    auto span = builder.create<mlir::arith::SubIOp>(loc, last, lb);
+    auto trips = builder.create<mlir::arith::DivSIOp>(loc, span, loop.step());
+    auto stride = builder.create<mlir::arith::MulIOp>(loc, trips, loop.step());
+    last = builder.create<mlir::arith::AddIOp>(loc, lb, stride);
+  }
+  auto sum = builder.create<mlir::arith::AddIOp>(loc, lb, last);
+  builder.setInsertionPointToStart(loop.getBody());
+  auto iv = loop.getInductionVar();
+  auto reversed = builder.create<mlir::arith::SubIOp>(loc, sum, iv);
+  iv.replaceAllUsesExcept(reversed, reversed);
+}
+
+namespace {
+/// Lower fir.array_fetch to a load of the element from the array in memory.
+class ArrayFetchConversion : public mlir::OpRewritePattern<fir::ArrayFetchOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  mlir::LogicalResult
+  matchAndRewrite(fir::ArrayFetchOp fetch,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto load = fetch.sequence().getDefiningOp<fir::ArrayLoadOp>();
+    auto addr = genElementAddress(rewriter, fetch.getLoc(), load.memref(),
+                                  load.shape(), load.slice(), fetch.indices(),
+                                  load.typeparams(), load.getType());
+    // Elements of CHARACTER and derived types are fetched by reference.
+    if (fetch.getType().isa<fir::ReferenceType>())
+      rewriter.replaceOp(fetch, addr);
+    else
+      rewriter.replaceOpWithNewOp<fir::LoadOp>(fetch, addr);
+    return mlir::success();
+  }
+};
+
+/// Base for the lowering of the operations that update an array value.
+template <typename OP>
+class ArrayUpdateConversionBase : public mlir::OpRewritePattern<OP> {
+public:
+  ArrayUpdateConversionBase(
+      mlir::MLIRContext *ctx, const ArrayCopyAnalysis &analysis,
+      const llvm::DenseMap<mlir::Operation *, Temporary> &temps)
+      : mlir::OpRewritePattern<OP>(ctx), analysis{analysis}, temps{temps} {}
+
+protected:
+  /// The address of the element that `op` updates, in the destination array
+  /// or its temporary.
+  mlir::Value genUpdateAddress(mlir::PatternRewriter &rewriter, OP op) const {
+    auto dest = analysis.getDestination(op);
+    auto memref = dest.memref();
+    auto shape = dest.shape();
+    auto it = temps.find(dest);
+    if (it != temps.end()) {
+      memref = it->second.memref;
+      shape = it->second.shape;
+    }
+    return genElementAddress(rewriter, op.getLoc(), memref, shape,
+                             dest.slice(), op.indices(), dest.typeparams(),
+                             dest.getType());
+  }
+
+private:
+  const ArrayCopyAnalysis &analysis;
+  const llvm::DenseMap<mlir::Operation *, Temporary> &temps;
+};
+
+/// Lower fir.array_update to a store of the element to memory.
+class ArrayUpdateConversion
+    : public ArrayUpdateConversionBase<fir::ArrayUpdateOp> {
+public:
+  using ArrayUpdateConversionBase::ArrayUpdateConversionBase;
+
+  mlir::LogicalResult
+  matchAndRewrite(fir::ArrayUpdateOp update,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto loc = update.getLoc();
+    mlir::Value value = update.merge();
+    if (auto refTy = value.getType().dyn_cast<fir::ReferenceType>()) {
+      if (!update.typeparams().empty())
+        return rewriter.notifyMatchFailure(
+            update, "not yet implemented: element with length parameters");
+      value = rewriter.create<fir::LoadOp>(loc, value);
+    }
+    auto addr = genUpdateAddress(rewriter, update);
+    rewriter.create<fir::StoreOp>(loc, value, addr);
+    rewriter.replaceOp(update, update.sequence());
+    return mlir::success();
+  }
+};
+
+/// Lower fir.array_modify to the address of the element in memory.
+class ArrayModifyConversion
+    : public ArrayUpdateConversionBase<fir::ArrayModifyOp> {
+public:
+  using ArrayUpdateConversionBase::ArrayUpdateConversionBase;
+
+  mlir::LogicalResult
+  matchAndRewrite(fir::ArrayModifyOp modify,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto addr = genUpdateAddress(rewriter, modify);
+    rewriter.replaceOp(modify, {addr, modify.sequence()});
+    return mlir::success();
+  }
+};
+
+/// Lower fir.array_merge_store by copying a temporary back, if there is one.
+class ArrayMergeStoreConversion
+    : public mlir::OpRewritePattern<fir::ArrayMergeStoreOp> {
+public:
+  ArrayMergeStoreConversion(
+      mlir::MLIRContext *ctx,
+      const llvm::DenseMap<mlir::Operation *, Temporary> &temps)
+      : OpRewritePattern(ctx), temps{temps} {}
+
+  mlir::LogicalResult
+  matchAndRewrite(fir::ArrayMergeStoreOp store,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto dest = store.original().getDefiningOp<fir::ArrayLoadOp>();
+    auto it = temps.find(dest);
+    if (it != temps.end()) {
+      auto &temp = it->second;
+      genArrayCopy(rewriter, store.getLoc(), dest.memref(), dest.shape(),
+                   temp.memref, temp.shape, temp.extents);
+      rewriter.create<fir::FreeMemOp>(store.getLoc(), temp.memref);
+    }
+    rewriter.eraseOp(store);
+    return mlir::success();
+  }
+
+private:
+  const llvm::DenseMap<mlir::Operation *, Temporary> &temps;
+};
+
+/// Erase fir.array_load. The array values threaded through loops that remain
+/// are undefined and dead.
+class ArrayLoadConversion : public mlir::OpRewritePattern<fir::ArrayLoadOp> {
+public:
+  using OpRewritePattern::OpRewritePattern;
+
+  mlir::LogicalResult
+  matchAndRewrite(fir::ArrayLoadOp load,
+                  mlir::PatternRewriter &rewriter) const override {
+    rewriter.replaceOpWithNewOp<fir::UndefOp>(load, load.getType());
+    return mlir::success();
+  }
+};
+
+class ArrayValueCopyConverter
+    : public fir::ArrayValueCopyBase<ArrayValueCopyConverter> {
+public:
+  void runOnFunction() override {
+    auto func = getFunction();
+    auto *context = &getContext();
+    const auto &analysis = getAnalysis<ArrayCopyAnalysis>();
+    if (analysis.failed()) {
+      signalPassFailure();
+      return;
+    }
+
+    mlir::OpBuilder builder(context);
+    for (auto [op, backward] : analysis.getLoopDirections()) {
+      auto loop = mlir::cast<fir::DoLoopOp>(op);
+      if (backward)
+        reverseLoop(builder, loop);
+      loop->removeAttr(loop.unorderedAttrName());
+    }
+    llvm::DenseMap<mlir::Operation *, Temporary> temps;
+    for (auto load : analysis.getCopies())
+      temps[load] = genTemporary(builder, load);
+
+    // Lower the accesses first; they need the operands of the array_loads.
+    mlir::OwningRewritePatternList patterns(context);
+    patterns.insert<ArrayFetchConversion>(context);
+    patterns.insert<ArrayUpdateConversion, ArrayModifyConversion>(
+        context, analysis, temps);
+    mlir::ConversionTarget target(*context);
+    target.addLegalDialect<fir::FIROpsDialect, mlir::arith::ArithmeticDialect,
+                           mlir::StandardOpsDialect>();
+    target.addIllegalOp<fir::ArrayFetchOp, fir::ArrayUpdateOp,
+                        fir::ArrayModifyOp>();
+    if (mlir::failed(
+            mlir::applyPartialConversion(func, target, std::move(patterns)))) {
+      mlir::emitError(func.getLoc(),
+                      "failure in array-value-copy pass, phase 1");
+      signalPassFailure();
+      return;
+    }
+
+    mlir::OwningRewritePatternList patterns2(context);
+    patterns2.insert<ArrayLoadConversion>(context);
+    patterns2.insert<ArrayMergeStoreConversion>(context, temps);
+    target.addIllegalOp<fir::ArrayLoadOp, fir::ArrayMergeStoreOp>();
+    if (mlir::failed(
+            mlir::applyPartialConversion(func, target, std::move(patterns2)))) {
+      mlir::emitError(func.getLoc(),
+                      "failure in array-value-copy pass, phase 2");
+      signalPassFailure();
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<mlir::Pass> fir::createArrayValueCopyPass() {
+  return std::make_unique<ArrayValueCopyConverter>();
+}
@@ -0,0 +1,372 @@
+//===-- BoxSpecialization.cpp ---------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Specialize procedures with assumed-shape array arguments for contiguous
+// actual arguments.
+//
+// An assumed-shape dummy argument is passed as a `!fir.box` descriptor. The
+// caller has to build the descriptor, and the callee reads the extents and
+// the strides of the array from it on every access. As the strides are not
+// known to be one, the loops of the callee are not vectorizable.
+//
+// For each procedure called directly and taking such arguments, a clone named
+// `<name>.contiguous` is created in which each of these arguments becomes a
+// reference to the array, and its extents are appended to the arguments. A
+// `fir.box_dims` in the clone yields the extent argument, a `fir.box_addr`
+// yields the reference, and a `fir.array_coor`, `fir.array_load` or
+// `fir.array_merge_store` addresses the reference directly. Any other use of
+// the argument gets a descriptor built from the reference in the clone.
+//
+// A call whose actual arguments are built by a `fir.embox` of a whole array
+// calls the clone directly and the descriptors are no longer needed.
+// Otherwise, the byte strides in the descriptors are checked at runtime, and
+// the clone is called when the arrays are contiguous. Calls in the clones are
+// rewritten too, so that a chain of calls passing an array along only builds
+// its descriptor once, if at all.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "flang/Optimizer/Dialect/FIRDialect.h"
+#include "flang/Optimizer/Dialect/FIROps.h"
+#include "flang/Optimizer/Dialect/FIROpsSupport.h"
+#include "flang/Optimizer/Dialect/FIRType.h"
+#include "flang/Optimizer/Transforms/Passes.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "flang-box-specialization"
+
+static constexpr llvm::StringRef contiguousSuffix = ".contiguous";
+
+/// Returns the array type boxed by an argument of type `ty` if the argument
+/// can be passed as a reference to a contiguous array and its extents.
+/// Pointers, allocatables, assumed-rank arrays and arrays with length
+/// parameters are excluded, as are OPTIONAL arguments.
+static fir::SequenceType getSpecializableArrayType(mlir::Type ty) {
+  auto boxTy = ty.dyn_cast<fir::BoxType>();
+  if (!boxTy)
+    return {};
+  auto seqTy = boxTy.getEleTy().dyn_cast<fir::SequenceType>();
+  if (!seqTy || seqTy.hasUnknownShape())
+    return {};
+  auto eleTy = seqTy.getEleTy();
+  if (auto charTy = eleTy.dyn_cast<fir::CharacterType>())
+    if (charTy.hasDynamicLen())
+      return {};
+  if (auto recTy = eleTy.dyn_cast<fir::RecordType>())
+    if (recTy.getNumLenParams() != 0)
+      return {};
+  return seqTy;
+}
+
+namespace {
+/// A procedure and its contiguous clone.
+struct Specialization {
+  mlir::FuncOp clone;
+  /// Positions of the arguments that are passed by reference to the clone.
+  llvm::SmallVector<unsigned> args;
+};
+
+class BoxSpecialization
+    : public fir::BoxSpecializationBase<BoxSpecialization> {
+public:
+  void runOnOperation() override {
+    auto module = getOperation();
+    llvm::DenseSet<llvm::StringRef> callees;
+    module.walk([&](fir::CallOp call) {
+      if (auto callee = call.callee())
+        callees.insert(callee->getRootReference().getValue());
+    });
+
+    llvm::DenseMap<mlir::Operation *, Specialization> specializations;
+    for (auto func :
+         llvm::make_early_inc_range(module.getOps<mlir::FuncOp>())) {
+      if (func.isExternal() || func.sym_name().endswith(contiguousSuffix) ||
+          !callees.count(func.sym_name()))
+        continue;
+      Specialization spec;
+      for (auto ty : llvm::enumerate(func.getType().getInputs()))
+        // An absent OPTIONAL argument is passed as a null descriptor, whose
+        // strides cannot be read, and the clone would not be able to tell
+        // that it is absent.
+        if (getSpecializableArrayType(ty.value()) &&
+            !func.getArgAttr(ty.index(), fir::getOptionalAttrName()))
+          spec.args.push_back(ty.index());
+      if (spec.args.empty())
+        continue;
+      spec.clone = createClone(module, func, spec.args);
+      LLVM_DEBUG(llvm::dbgs() << "BoxSpecialization: created "
+                              << spec.clone.sym_name() << '\n';);
+      specializations.try_emplace(func, spec);
+    }
+    if (specializations.empty())
+      return;
+
+    // Collect the calls again to include those in the clones.
+    llvm::SmallVector<fir::CallOp> calls;
+    module.walk([&](fir::CallOp call) { calls.push_back(call); });
+    for (auto call : calls) {
+      auto callee = call.callee();
+      if (!callee)
+        continue;
+      auto func = module.lookupSymbol<mlir::FuncOp>(*callee);
+      if (!func)
+        continue;
+      auto iter = specializations.find(func);
+      if (iter != specializations.end())
+        rewriteCall(call, func, iter->second);
+    }
+  }
+
+private:
+  /// Clone `func`, passing the arguments at positions `args` by reference
+  /// followed by their extents.
+  mlir::FuncOp createClone(mlir::ModuleOp module, mlir::FuncOp func,
+                           llvm::ArrayRef<unsigned> args) {
+    auto clone = func.clone();
+    clone.setName((func.sym_name() + contiguousSuffix).str());
+    clone.setVisibility(mlir::SymbolTable::Visibility::Private);
+    module.insert(std::next(mlir::Block::iterator(func)), clone);
+
+    auto *ctx = &getContext();
+    auto &entry = clone.front();
+    auto idxTy = mlir::IndexType::get(ctx);
+    for (auto pos : args) {
+      auto arg = entry.getArgument(pos);
+      auto boxTy = arg.getType().cast<fir::BoxType>();
+      auto seqTy = getSpecializableArrayType(boxTy);
+      llvm::SmallVector<mlir::Value> extents;
+      for (unsigned i = 0, e = seqTy.getDimension(); i < e; ++i)
+        extents.push_back(entry.addArgument(idxTy));
+      auto loc = clone.getLoc();
+      arg.setType(fir::ReferenceType::get(seqTy));
+      // The uses of the descriptor that cannot be rewritten to use the
+      // reference use this descriptor built from it instead.
+      mlir::OpBuilder builder(ctx);
+      builder.setInsertionPointToStart(&entry);
+      auto shape = builder.create<fir::ShapeOp>(
+          loc, fir::ShapeType::get(ctx, extents.size()), extents);
+      auto box = builder.create<fir::EmboxOp>(loc, boxTy, arg, shape);
+      auto one = builder.create<mlir::arith::ConstantIndexOp>(loc, 1);
+
+      llvm::SetVector<mlir::Operation *> users;
+      for (auto *user : arg.getUsers())
+        if (user != box)
+          users.insert(user);
+      for (auto *user : users)
+        if (!rewriteUse(user, arg, shape, one, extents))
+          user->replaceUsesOfWith(arg, box);
+    }
+    clone.setType(mlir::FunctionType::get(ctx, entry.getArgumentTypes(),
+                                          clone.getType().getResults()));
+    return clone;
+  }
+
+  /// Rewrite `user` of the descriptor argument now passed as reference `ref`
+  /// to use the reference. Returns false if `user` needs the descriptor.
+  static bool rewriteUse(mlir::Operation *user, mlir::Value ref,
+                         fir::ShapeOp shape,
+                         mlir::Value one, llvm::ArrayRef<mlir::Value> extents) {
+    mlir::OpBuilder builder(user);
+    auto loc = user->getLoc();
+    // A fir.shift applied to the descriptor becomes a fir.shape_shift of the
+    // reference. No shape means the extents of the argument.
+    auto getShape = [&](mlir::Value shapeVal) -> mlir::Value {
+      if (!shapeVal)
+        return shape;
+      auto shift = shapeVal.getDefiningOp<fir::ShiftOp>();
+      if (!shift)
+        return shapeVal;
+      llvm::SmallVector<mlir::Value> pairs;
+      for (auto iter : llvm::zip(shift.getOrigins(), extents)) {
+        pairs.push_back(std::get<0>(iter));
+        pairs.push_back(std::get<1>(iter));
+      }
+      return builder.create<fir::ShapeShiftOp>(
+          loc, fir::ShapeShiftType::get(user->getContext(), extents.size()),
+          pairs);
+    };
+
+    if (auto dims = mlir::dyn_cast<fir::BoxDimsOp>(user)) {
+      auto cst = dims.dim().getDefiningOp<mlir::arith::ConstantOp>();
+      auto attr = cst ? cst.value().dyn_cast<mlir::IntegerAttr>()
+                      : mlir::IntegerAttr{};
+      if (!attr || attr.getInt() < 0 ||
+          attr.getInt() >= static_cast<int64_t>(extents.size()))
+        return false;
+      // The lower bounds of an assumed-shape dummy argument are given by its
+      // declaration, not by the descriptor of the actual argument, and are 1
+      // in the descriptor built by fir.embox.
+      dims.getResult(0).replaceAllUsesWith(one);
+      dims.getResult(1).replaceAllUsesWith(extents[attr.getInt()]);
+      if (!dims.getResult(2).use_empty())
+        return false;
+      dims.erase();
+      return true;
+    }
+    if (auto addr = mlir::dyn_cast<fir::BoxAddrOp>(user)) {
+      mlir::Value val = ref;
+      if (ref.getType() != addr.getType())
+        val = builder.create<fir::ConvertOp>(loc, addr.getType(), ref);
+      addr.replaceAllUsesWith(val);
+      addr.erase();
+      return true;
+    }
+    if (auto coor = mlir::dyn_cast<fir::ArrayCoorOp>(user)) {
+      if (coor.memref() != ref)
+        return false;
+      auto newCoor = builder.create<fir::ArrayCoorOp>(
+          loc, coor.getType(), ref, getShape(coor.shape()), coor.slice(),
+          coor.indices(), coor.typeparams());
+      coor.replaceAllUsesWith(newCoor.getResult());
+      coor.erase();
+      return true;
+    }
+    if (auto load = mlir::dyn_cast<fir::ArrayLoadOp>(user)) {
+      if (load.memref() != ref)
+        return false;
+      auto newLoad = builder.create<fir::ArrayLoadOp>(
+          loc, load.getType(), ref, getShape(load.shape()), load.slice(),
+          load.typeparams());
+      load.replaceAllUsesWith(newLoad.getResult());
+      load.erase();
+      return true;
+    }
+    if (auto store = mlir::dyn_cast<fir::ArrayMergeStoreOp>(user)) {
+      // The array value stored must have been loaded from the argument, in
+      // which case the load is rewritten to use the reference as well.
+      auto load = store.original().getDefiningOp<fir::ArrayLoadOp>();
+      return store.memref() == ref && load && load.memref() == ref;
+    }
+    return false;
+  }
+
+  /// Returns the reference to the contiguous array boxed by `actual` if it is
+  /// known statically, with the extents of the array in `extents`.
+  static mlir::Value
+  getContiguousArray(mlir::Value actual,
+                     llvm::SmallVectorImpl<mlir::Value> &extents) {
+    if (auto convert = actual.getDefiningOp<fir::ConvertOp>())
+      if (convert.value().getType().isa<fir::BoxType>())
+        actual = convert.value();
+    auto embox = actual.getDefiningOp<fir::EmboxOp>();
+    if (!embox || embox.slice() || !embox.shape())
+      return {};
+    auto eleTy = fir::dyn_cast_ptrEleTy(embox.memref().getType());
+    if (!eleTy || !eleTy.isa<fir::SequenceType>())
+      return {};
+    auto *shapeOp = embox.shape().getDefiningOp();
+    if (auto shape = mlir::dyn_cast_or_null<fir::ShapeOp>(shapeOp)) {
+      auto vals = shape.getExtents();
+      extents.assign(vals.begin(), vals.end());
+    } else if (auto shape =
+                   mlir::dyn_cast_or_null<fir::ShapeShiftOp>(shapeOp)) {
+      auto vals = shape.getExtents();
+      extents.assign(vals.begin(), vals.end());
+    } else {
+      return {};
+    }
+    return embox.memref();
+  }
+
+  /// Call the clone of `func` instead of `func`, or when the contiguity of
+  /// the actual arguments is not known statically, in the branch of a check
+  /// of their strides.
+  void rewriteCall(fir::CallOp call, mlir::FuncOp func,
+                   const Specialization &spec) {
+    auto loc = call.getLoc();
+    auto args = call.getArgOperands();
+    if (args.size() != func.getNumArguments())
+      return;
+    mlir::OpBuilder builder(call);
+    auto idxTy = builder.getIndexType();
+    llvm::SmallVector<mlir::Value> newArgs(args.begin(), args.end());
+    llvm::SmallVector<mlir::Value> extentArgs;
+    // The array in a descriptor is contiguous when the byte stride of each
+    // dimension is the size of an element times the extents of the previous
+    // dimensions.
+    mlir::Value isContiguous;
+    llvm::SmallVector<unsigned> checkedArgs;
+    for (auto pos : spec.args) {
+      auto refTy = spec.clone.getType().getInput(pos);
+      llvm::SmallVector<mlir::Value> extents;
+      if (auto ref = getContiguousArray(args[pos], extents)) {
+        if (ref.getType() != refTy)
+          ref = builder.create<fir::ConvertOp>(loc, refTy, ref);
+        newArgs[pos] = ref;
+        for (auto extent : extents)
+          extentArgs.push_back(
+              builder.createOrFold<fir::ConvertOp>(loc, idxTy, extent));
+        continue;
+      }
+      checkedArgs.push_back(pos);
+      auto box = args[pos];
+      auto rank = fir::dyn_cast_ptrEleTy(refTy)
+                      .cast<fir::SequenceType>()
+                      .getDimension();
+      mlir::Value stride = builder.create<fir::BoxEleSizeOp>(loc, idxTy, box);
+      for (unsigned i = 0; i < rank; ++i) {
+        auto dim = builder.create<mlir::arith::ConstantIndexOp>(loc, i);
+        auto dims =
+            builder.create<fir::BoxDimsOp>(loc, idxTy, idxTy, idxTy, box, dim);
+        mlir::Value cmp = builder.create<mlir::arith::CmpIOp>(
+            loc, mlir::arith::CmpIPredicate::eq, dims.getResult(2), stride);
+        isContiguous =
+            isContiguous
+                ? builder.create<mlir::arith::AndIOp>(loc, isContiguous, cmp)
+                : cmp;
+        extentArgs.push_back(dims.getResult(1));
+        stride = builder.create<mlir::arith::MulIOp>(loc, stride,
+                                                     dims.getResult(1));
+      }
+    }
+
+    if (checkedArgs.empty()) {
+      newArgs.append(extentArgs.begin(), extentArgs.end());
+      auto newCall = builder.create<fir::CallOp>(loc, spec.clone, newArgs);
+      call.replaceAllUsesWith(newCall.getResults());
+      call.erase();
+      return;
+    }
+
+    auto resultTypes = call.getResultTypes();
+    auto ifOp =
+        builder.create<fir::IfOp>(loc, resultTypes, isContiguous, true);
+    auto thenBuilder =
+        resultTypes.empty()
+            ? ifOp.getThenBodyBuilder()
+            : mlir::OpBuilder::atBlockEnd(&ifOp.thenRegion().front());
+    auto elseBuilder =
+        resultTypes.empty()
+            ? ifOp.getElseBodyBuilder()
+            : mlir::OpBuilder::atBlockEnd(&ifOp.elseRegion().front());
+    for (auto pos : checkedArgs)
+      newArgs[pos] = thenBuilder.create<fir::BoxAddrOp>(
+          loc, spec.clone.getType().getInput(pos), args[pos]);
+    newArgs.append(extentArgs.begin(), extentArgs.end());
+    auto newCall = thenBuilder.create<fir::CallOp>(loc, spec.clone, newArgs);
+    auto *oldCall = elseBuilder.clone(*call.getOperation());
+    if (!resultTypes.empty()) {
+      thenBuilder.create<fir::ResultOp>(loc, newCall.getResults());
+      elseBuilder.create<fir::ResultOp>(loc, oldCall->getResults());
+    }
+    call.replaceAllUsesWith(ifOp.getResults());
+    call.erase();
+  }
+};
+} // namespace
+
+std::unique_ptr<mlir::Pass> fir::createBoxSpecializationPass() {
+  return std::make_unique<BoxSpecialization>();
+}
@@ -5,20 +5,172 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 //
 //===----------------------------------------------------------------------===//
+//
+// Inline direct calls to functions defined in the module when a cost model
+// finds it profitable. The legality of inlining each operation is decided by
+// the inliner interface of its dialect.
+//
+// The cost of a callee is the number of operations in its body that are
+// likely to survive as code; constants, conversions and terminators are
+// free and nested calls are expensive. A call site is inlined when that
+// cost does not exceed its threshold. The threshold grows with each
+// fir.do_loop or fir.iterate_while that encloses the call, since those calls
+// execute often and inlining them may enable vectorization of the loop, and
+// with each argument descriptor built with fir.embox or fir.rebox at the
+// call site, since inlining exposes its fields to folding. Recursive
+// callees are never inlined.
+//
+// The calls in the bodies of inlined callees are not considered in turn.
+//
+//===----------------------------------------------------------------------===//
 
+#include "PassDetail.h"
 #include "flang/Optimizer/Dialect/FIRDialect.h"
 #include "flang/Optimizer/Dialect/FIROps.h"
 #include "flang/Optimizer/Transforms/Passes.h"
-#include "mlir/Transforms/Passes.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+#include "mlir/Transforms/InliningUtils.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/CommandLine.h"
+#include <algorithm>
 
 static llvm::cl::opt<bool>
     aggressivelyInline("inline-all",
                        llvm::cl::desc("aggressively inline everything"),
                        llvm::cl::init(false));
 
-/// Should we inline the callable `op` into region `reg`?
-bool fir::canLegallyInline(mlir::Operation *op, mlir::Region *reg,
-                           mlir::BlockAndValueMapping &map) {
-  return aggressivelyInline;
+static llvm::cl::opt<unsigned> inlineThreshold(
+    "fir-inline-threshold",
+    llvm::cl::desc("inline calls to functions whose cost does not exceed this "
+                   "threshold"),
+    llvm::cl::init(40));
+
+static llvm::cl::opt<unsigned> loopBonusPercent(
+    "fir-inline-loop-bonus",
+    llvm::cl::desc("percentage by which the inlining threshold grows for each "
+                   "loop that encloses a call"),
+    llvm::cl::init(100));
+
+static llvm::cl::opt<unsigned> boxArgumentBonus(
+    "fir-inline-box-bonus",
+    llvm::cl::desc("inlining threshold bonus for each argument descriptor "
+                   "constructed at a call site"),
+    llvm::cl::init(10));
+
+static llvm::cl::opt<bool>
+    inlineRemarks("fir-inline-remarks",
+                  llvm::cl::desc("emit a remark for each inlining decision"),
+                  llvm::cl::init(false));
+
+/// The cost of a call inside the callee; it will remain a call after
+/// inlining and its callee may in turn be inlined.
+static constexpr unsigned nestedCallCost = 5;
+
+/// Loops deeper than this do not raise the threshold any further.
+static constexpr unsigned maxBonusLoopDepth = 3;
+
+/// Does `callee` call the function named `name`?
+static bool callsFunction(mlir::Region &callee, llvm::StringRef name) {
+  bool result = false;
+  callee.walk([&](fir::CallOp call) {
+    if (auto sym = call.calleeAttr())
+      if (sym.getRootReference().getValue() == name)
+        result = true;
+  });
+  return result;
+}
+
+static unsigned calleeCost(mlir::Region &callee) {
+  unsigned cost = 0;
+  callee.walk([&](mlir::Operation *op) {
+    if (op->hasTrait<mlir::OpTrait::ConstantLike>() ||
+        op->hasTrait<mlir::OpTrait::IsTerminator>() ||
+        mlir::isa<fir::ConvertOp>(op))
+      return;
+    cost += mlir::isa<fir::CallOp, fir::DispatchOp>(op) ? nestedCallCost : 1;
+  });
+  return cost;
+}
+
+static unsigned callSiteThreshold(mlir::Operation *call) {
+  unsigned loopDepth = 0;
+  for (auto *op = call->getParentOp(); op && !mlir::isa<mlir::FuncOp>(op);
+       op = op->getParentOp())
+    if (mlir::isa<fir::DoLoopOp, fir::IterWhileOp>(op))
+      ++loopDepth;
+  unsigned threshold = inlineThreshold;
+  threshold += threshold * loopBonusPercent / 100 *
+               std::min(loopDepth, maxBonusLoopDepth);
+  for (auto arg : call->getOperands())
+    if (auto *def = arg.getDefiningOp())
+      if (mlir::isa<fir::EmboxOp, fir::ReboxOp>(def))
+        threshold += boxArgumentBonus;
+  return threshold;
+}
+
+/// Is it profitable to inline `callable` at the call site `call`?
+static bool shouldInline(mlir::Operation *call, mlir::Operation *callable) {
+  if (aggressivelyInline)
+    return true;
+  auto callableOp = mlir::dyn_cast<mlir::CallableOpInterface>(callable);
+  auto *body = callableOp ? callableOp.getCallableRegion() : nullptr;
+  if (!body)
+    return false;
+  llvm::StringRef name;
+  if (auto attr = callable->getAttrOfType<mlir::StringAttr>(
+          mlir::SymbolTable::getSymbolAttrName()))
+    name = attr.getValue();
+  llvm::StringRef caller;
+  if (auto func = call->getParentOfType<mlir::FuncOp>())
+    caller = mlir::SymbolTable::getSymbolName(func).getValue();
+  if (!name.empty() &&
+      (callsFunction(*body, name) ||
+       (!caller.empty() && callsFunction(*body, caller)))) {
+    if (inlineRemarks)
+      mlir::emitRemark(call->getLoc())
+          << "not inlining recursive function '" << name << "'";
+    return false;
+  }
+  unsigned cost = calleeCost(*body);
+  unsigned threshold = callSiteThreshold(call);
+  bool result = cost <= threshold;
+  if (inlineRemarks)
+    mlir::emitRemark(call->getLoc())
+        << (result ? "inlining" : "not inlining") << " call to '" << name
+        << "': cost " << cost << (result ? " <= " : " > ") << "threshold "
+        << threshold;
+  return result;
+}
+
+namespace {
+class CallInlining : public fir::CallInliningBase<CallInlining> {
+public:
+  void runOnOperation() override {
+    auto module = getOperation();
+    mlir::SymbolTable symbols(module);
+    mlir::InlinerInterface interface(&getContext());
+    llvm::SmallVector<fir::CallOp> calls;
+    module.walk([&](fir::CallOp call) { calls.push_back(call); });
+    for (auto call : calls) {
+      auto callee = call.calleeAttr();
+      if (!callee)
+        continue;
+      auto func = symbols.lookup<mlir::FuncOp>(callee.getRootReference());
+      if (!func || func.isExternal() || !shouldInline(call, func))
+        continue;
+      // The inliner interfaces may still refuse an operation of the callee,
+      // in which case the call is left alone.
+      if (mlir::succeeded(mlir::inlineCall(interface, call, func,
+                                           &func.getBody())))
+        call.erase();
+    }
+  }
+};
+} // namespace
+
+std::unique_ptr<mlir::Pass> fir::createCallInliningPass() {
+  return std::make_unique<CallInlining>();
 }
@@ -0,0 +1,379 @@
+//===-- LoopFusion.cpp ----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Fuse adjacent fir.do_loop operations that iterate over the same space and
+// contract the local arrays that fusion leaves written and read within a
+// single iteration into scalars.
+//
+// Consecutive array assignments, such as
+//
+//   a = b + c
+//   d = a * 2
+//
+// lower to one loop nest each, so every array streams through the cache once
+// per statement. Fusing the nests runs the second statement on an element
+// while it is still in cache, and, when `a` is a local temporary that is not
+// otherwise used, stores it only to reload it immediately; the element is then
+// forwarded in a register and the temporary removed.
+//
+// Two loops are fused when nothing but side-effect free operations separate
+// them, their bounds and steps are the same, and no element of an array is
+// accessed by the second loop before the first one is done with it. Array
+// elements are compared through their fir.array_coor or fir.coordinate_of
+// subscripts, which must be the loop induction variables plus constants.
+// The bodies of fused loop nests are fused in turn.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "flang/Optimizer/Dialect/FIRDialect.h"
+#include "flang/Optimizer/Dialect/FIROps.h"
+#include "flang/Optimizer/Dialect/FIROpsSupport.h"
+#include "flang/Optimizer/Dialect/FIRType.h"
+#include "flang/Optimizer/Support/Utils.h"
+#include "flang/Optimizer/Transforms/Passes.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "flang-loop-fusion"
+
+namespace {
+/// A load or store of memory. For an array element, the address is computed
+/// from `memref` by a fir.array_coor or fir.coordinate_of with `indices`.
+struct Access {
+  mlir::Value memref;
+  mlir::Value shape;
+  mlir::Value slice;
+  llvm::SmallVector<mlir::Value> indices;
+  bool isWrite;
+};
+} // namespace
+
+/// Split `value` into a root and a constant offset. The root is null when
+/// `value` is a constant.
+static std::pair<mlir::Value, std::int64_t> decompose(mlir::Value value) {
+  std::int64_t offset = 0;
+  while (true) {
+    if (auto c = fir::getIntIfConstant(value))
+      return {{}, offset + *c};
+    if (auto conv = value.getDefiningOp<fir::ConvertOp>()) {
+      if (conv.value().getType().isIntOrIndex()) {
+        value = conv.value();
+        continue;
+      }
+    } else if (auto add = value.getDefiningOp<mlir::arith::AddIOp>()) {
+      if (auto c = fir::getIntIfConstant(add.rhs())) {
+        offset += *c;
+        value = add.lhs();
+        continue;
+      }
+      if (auto c = fir::getIntIfConstant(add.lhs())) {
+        offset += *c;
+        value = add.rhs();
+        continue;
+      }
+    } else if (auto sub = value.getDefiningOp<mlir::arith::SubIOp>()) {
+      if (auto c = fir::getIntIfConstant(sub.rhs())) {
+        offset -= *c;
+        value = sub.lhs();
+        continue;
+      }
+    }
+    return {value, offset};
+  }
+}
+
+/// Are `a` and `b` the same value, or computed from the same values by the
+/// same side-effect free operations?
+static bool areEquivalent(mlir::Value a, mlir::Value b, unsigned depth = 4) {
+  if (a == b)
+    return true;
+  if (!a || !b)
+    return false;
+  auto *opA = a.getDefiningOp();
+  auto *opB = b.getDefiningOp();
+  if (!opA || !opB || depth == 0 || opA->getName() != opB->getName() ||
+      opA->getNumRegions() != 0 ||
+      !mlir::MemoryEffectOpInterface::hasNoEffect(opA) ||
+      opA->getAttrDictionary() != opB->getAttrDictionary() ||
+      opA->getNumOperands() != opB->getNumOperands() ||
+      a.cast<mlir::OpResult>().getResultNumber() !=
+          b.cast<mlir::OpResult>().getResultNumber() ||
+      a.getType() != b.getType())
+    return false;
+  for (auto [x, y] : llvm::zip(opA->getOperands(), opB->getOperands()))
+    if (!areEquivalent(x, y, depth - 1))
+      return false;
+  return true;
+}
+
+static Access getAccess(mlir::Value addr, bool isWrite) {
+  if (auto coor = addr.getDefiningOp<fir::ArrayCoorOp>())
+    return {coor.memref(), coor.shape(), coor.slice(),
+            {coor.indices().begin(), coor.indices().end()}, isWrite};
+  if (auto coor = addr.getDefiningOp<fir::CoordinateOp>())
+    return {coor.ref(), {}, {}, {coor.coor().begin(), coor.coor().end()},
+            isWrite};
+  return {addr, {}, {}, {}, isWrite};
+}
+
+/// Collect the memory accesses in the body of `loop`. Returns false if the
+/// body has side effects other than loads and stores.
+static bool collectAccesses(fir::DoLoopOp loop,
+                            llvm::SmallVectorImpl<Access> &accesses) {
+  auto result = loop.getBody()->walk([&](mlir::Operation *op) {
+    if (auto load = mlir::dyn_cast<fir::LoadOp>(op))
+      accesses.push_back(getAccess(load.memref(), /*isWrite=*/false));
+    else if (auto store = mlir::dyn_cast<fir::StoreOp>(op))
+      accesses.push_back(getAccess(store.memref(), /*isWrite=*/true));
+    else if (!mlir::isa<fir::DoLoopOp, fir::IfOp, fir::ResultOp>(op) &&
+             !mlir::MemoryEffectOpInterface::hasNoEffect(op))
+      return mlir::WalkResult::interrupt();
+    return mlir::WalkResult::advance();
+  });
+  return !result.wasInterrupted();
+}
+
+/// Might `a` and `b` refer to overlapping memory? Returns true in `same` if
+/// they are the same reference, whose accesses can be compared. Only
+/// references to distinct allocations are known not to overlap.
+static bool mayAlias(mlir::Value a, mlir::Value b, bool &same) {
+  same = a == b;
+  return same || !fir::isDistinctAllocation(a, b);
+}
+
+/// Does `value` vary between the iterations of `loop`?
+static bool isDefinedIn(mlir::Value value, fir::DoLoopOp loop) {
+  return loop->isAncestor(value.getParentRegion()->getParentOp());
+}
+
+/// Can the body of `second` run right after each iteration of `first`? Sets
+/// `independent` to false if an iteration of the fused loop would then
+/// depend on an earlier one.
+static bool canFuse(fir::DoLoopOp first, fir::DoLoopOp second,
+                    bool &independent) {
+  if (first.getNumResults() != 0 || second.getNumResults() != 0 ||
+      first.hasIterOperands() || second.hasIterOperands() ||
+      !areEquivalent(first.lowerBound(), second.lowerBound()) ||
+      !areEquivalent(first.upperBound(), second.upperBound()) ||
+      !areEquivalent(first.step(), second.step()))
+    return false;
+  llvm::SmallVector<Access> firstAccesses;
+  llvm::SmallVector<Access> secondAccesses;
+  if (!collectAccesses(first, firstAccesses) ||
+      !collectAccesses(second, secondAccesses))
+    return false;
+  auto step = fir::getIntIfConstant(first.step());
+  auto firstIv = first.getInductionVar();
+  auto secondIv = second.getInductionVar();
+  independent = true;
+  for (auto &a : firstAccesses)
+    for (auto &b : secondAccesses) {
+      if (!a.isWrite && !b.isWrite)
+        continue;
+      bool same = false;
+      if (!mayAlias(a.memref, b.memref, same))
+        continue;
+      if (!same || a.indices.empty() ||
+          a.indices.size() != b.indices.size() ||
+          !areEquivalent(a.shape, b.shape) || !areEquivalent(a.slice, b.slice))
+        return false;
+      // The element accessed by `a` in iteration `i` is accessed by `b` in
+      // iteration `i - distance`.
+      llvm::Optional<std::int64_t> distance;
+      bool disjoint = false;
+      for (auto [x, y] : llvm::zip(a.indices, b.indices)) {
+        auto [rootA, offsetA] = decompose(x);
+        auto [rootB, offsetB] = decompose(y);
+        if (rootA == firstIv && rootB == secondIv) {
+          auto d = offsetB - offsetA;
+          if (distance && *distance != d) {
+            disjoint = true;
+            break;
+          }
+          distance = d;
+        } else if (rootA == rootB &&
+                   (!rootA ||
+                    (!isDefinedIn(rootA, first) &&
+                     !isDefinedIn(rootA, second)))) {
+          if (offsetA != offsetB) {
+            disjoint = true;
+            break;
+          }
+        }
+      }
+      if (disjoint)
+        continue;
+      if (!distance)
+        return false;
+      if (*distance == 0)
+        continue;
+      if (!step || *step <= 0)
+        return false;
+      if (*distance % *step != 0)
+        continue;
+      // The second loop must not get to an element before the first.
+      if (*distance > 0)
+        return false;
+      independent = false;
+    }
+  return true;
+}
+
+/// Move the body of `second` to the end of the body of `first`.
+static void fuse(fir::DoLoopOp first, fir::DoLoopOp second,
+                 bool independent) {
+  LLVM_DEBUG(llvm::dbgs() << "loop-fusion: fusing " << first << "\nwith "
+                          << second << '\n');
+  second.getInductionVar().replaceAllUsesWith(first.getInductionVar());
+  auto &to = first.getBody()->getOperations();
+  auto &from = second.getBody()->getOperations();
+  to.splice(std::prev(to.end()), from, from.begin(), std::prev(from.end()));
+  if (!independent || !second.unordered())
+    first->removeAttr(first.unorderedAttrName());
+  second.erase();
+}
+
+/// Fuse the adjacent loops in `block`, then in the bodies of the operations
+/// in `block`.
+static void fuseLoops(mlir::Block &block) {
+  for (auto it = block.begin(); it != block.end(); ++it) {
+    auto first = mlir::dyn_cast<fir::DoLoopOp>(&*it);
+    if (!first)
+      continue;
+    while (true) {
+      // Look for the next loop past operations that may be hoisted.
+      llvm::SmallVector<mlir::Operation *> between;
+      fir::DoLoopOp second;
+      for (auto next = std::next(it); next != block.end(); ++next) {
+        if ((second = mlir::dyn_cast<fir::DoLoopOp>(&*next)))
+          break;
+        if (next->getNumRegions() != 0 ||
+            !mlir::MemoryEffectOpInterface::hasNoEffect(&*next))
+          break;
+        between.push_back(&*next);
+      }
+      bool independent = true;
+      if (!second || !canFuse(first, second, independent))
+        break;
+      for (auto *op : between)
+        op->moveBefore(first);
+      fuse(first, second, independent);
+    }
+  }
+  for (auto &op : block)
+    for (auto &region : op.getRegions())
+      for (auto &nested : region)
+        fuseLoops(nested);
+}
+
+/// Contract the local array `alloc` into scalars when
+///   - its only users are fir.freemem operations outside of the loop below
+///     and fir.array_coor or fir.coordinate_of operations whose addresses
+///     are only loaded from and stored to,
+///   - all of these loads and stores are directly in the body of one
+///     fir.do_loop, so that the array is not read after the loop, and
+///   - each load reads the element written by the last store to the array
+///     that precedes it in the body, so that every element read in an
+///     iteration was written earlier in that iteration.
+/// The stored values are then forwarded to the loads and the array removed.
+static void contractTemporary(mlir::Operation *alloc) {
+  llvm::SmallVector<mlir::Operation *> addrs;
+  llvm::SmallVector<mlir::Operation *> frees;
+  mlir::Block *body = nullptr;
+  for (auto *user : alloc->getResult(0).getUsers()) {
+    if (mlir::isa<fir::FreeMemOp>(user)) {
+      frees.push_back(user);
+      continue;
+    }
+    if (!mlir::isa<fir::ArrayCoorOp, fir::CoordinateOp>(user) ||
+        user->getOperand(0) != alloc->getResult(0))
+      return;
+    addrs.push_back(user);
+    for (auto &use : user->getResult(0).getUses()) {
+      auto *access = use.getOwner();
+      if (!mlir::isa<fir::LoadOp, fir::StoreOp>(access) ||
+          (mlir::isa<fir::StoreOp>(access) && use.getOperandNumber() != 1))
+        return;
+      if (body && access->getBlock() != body)
+        return;
+      body = access->getBlock();
+    }
+  }
+  if (!body)
+    return;
+  auto loop = mlir::dyn_cast<fir::DoLoopOp>(body->getParentOp());
+  if (!loop || llvm::any_of(frees, [&](mlir::Operation *free) {
+        return loop->isAncestor(free);
+      }))
+    return;
+
+  llvm::SmallVector<std::pair<mlir::Operation *, mlir::Value>> forwards;
+  llvm::SmallVector<mlir::Operation *> stores;
+  fir::StoreOp lastStore;
+  for (auto &op : *body) {
+    if (auto store = mlir::dyn_cast<fir::StoreOp>(op)) {
+      if (llvm::is_contained(addrs, store.memref().getDefiningOp())) {
+        lastStore = store;
+        stores.push_back(store);
+      }
+    } else if (auto load = mlir::dyn_cast<fir::LoadOp>(op)) {
+      if (llvm::is_contained(addrs, load.memref().getDefiningOp())) {
+        // An element read before any store in the iteration, or read from
+        // an address other than that of the last store, may hold a value
+        // from an earlier iteration or from before the loop.
+        if (!lastStore || !areEquivalent(lastStore.memref(), load.memref()))
+          return;
+        // The stored value may itself be a load that is forwarded.
+        auto value = lastStore.value();
+        for (auto [prior, priorValue] : forwards)
+          if (value.getDefiningOp() == prior)
+            value = priorValue;
+        forwards.emplace_back(load, value);
+      }
+    }
+  }
+  LLVM_DEBUG(llvm::dbgs() << "loop-fusion: contracting " << *alloc << '\n');
+  for (auto [load, value] : forwards) {
+    load->getResult(0).replaceAllUsesWith(value);
+    load->erase();
+  }
+  for (auto *op : stores)
+    op->erase();
+  for (auto *op : addrs)
+    op->erase();
+  for (auto *op : frees)
+    op->erase();
+  alloc->erase();
+}
+
+namespace {
+class LoopFusion : public fir::LoopFusionBase<LoopFusion> {
+public:
+  void runOnFunction() override {
+    auto func = getFunction();
+    for (auto &block : func.getBody())
+      fuseLoops(block);
+    llvm::SmallVector<mlir::Operation *> allocs;
+    func.walk([&](mlir::Operation *op) {
+      if (mlir::isa<fir::AllocaOp, fir::AllocMemOp>(op))
+        allocs.push_back(op);
+    });
+    for (auto *alloc : allocs)
+      contractTemporary(alloc);
+  }
+};
+} // namespace
+
+std::unique_ptr<mlir::Pass> fir::createLoopFusionPass() {
+  return std::make_unique<LoopFusion>();
+}
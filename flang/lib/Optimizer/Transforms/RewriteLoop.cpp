@@ -11,6 +11,7 @@
 #include "flang/Optimizer/Dialect/FIROps.h"
 #include "flang/Optimizer/Transforms/Passes.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
@@ -39,6 +40,17 @@ public:
                   mlir::PatternRewriter &rewriter) const override {
     auto loc = loop.getLoc();
 
+    // The memory accesses of the loop body join the access groups declared
+    // parallel by the loop metadata.
+    auto loopAttrName = mlir::LLVM::LLVMDialect::getLoopAttrName();
+    if (auto loopAttr = loop->getAttrOfType<mlir::DictionaryAttr>(loopAttrName))
+      if (auto parallelAccess = loopAttr.getAs<mlir::ArrayAttr>(
+              mlir::LLVM::LLVMDialect::getParallelAccessAttrName()))
+        loop.region().walk([&](mlir::Operation *op) {
+          if (mlir::isa<fir::LoadOp, fir::StoreOp>(op))
+            addAccessGroups(rewriter, op, parallelAccess);
+        });
+
     // Create the start and end blocks that will wrap the DoLoopOp with an
     // initalizer and an end point
     auto *initBlock = rewriter.getInsertionBlock();
@@ -105,9 +117,14 @@ public:
                                    : terminator->operand_begin();
     loopCarried.append(begin, terminator->operand_end());
     loopCarried.push_back(itersMinusOne);
-    rewriter.create<mlir::BranchOp>(loc, conditionalBlock, loopCarried);
+    auto backEdge =
+        rewriter.create<mlir::BranchOp>(loc, conditionalBlock, loopCarried);
     rewriter.eraseOp(terminator);
 
+    // The loop metadata annotates the latch of the loop.
+    if (auto loopAttr = loop->getAttr(loopAttrName))
+      backEdge->setAttr(loopAttrName, loopAttr);
+
     // Conditional block
     rewriter.setInsertionPointToEnd(conditionalBlock);
     auto zero = rewriter.create<mlir::arith::ConstantIndexOp>(loc, 0);
@@ -128,6 +145,19 @@ public:
   }
 
 private:
+  /// Add the access groups `groups` to those of the memory access `op`.
+  static void addAccessGroups(mlir::PatternRewriter &rewriter,
+                              mlir::Operation *op, mlir::ArrayAttr groups) {
+    auto attrName = mlir::LLVM::LLVMDialect::getAccessGroupsAttrName();
+    llvm::SmallVector<mlir::Attribute> accessGroups;
+    if (auto attr = op->getAttrOfType<mlir::ArrayAttr>(attrName))
+      accessGroups.append(attr.begin(), attr.end());
+    accessGroups.append(groups.begin(), groups.end());
+    rewriter.updateRootInPlace(op, [&]() {
+      op->setAttr(attrName, rewriter.getArrayAttr(accessGroups));
+    });
+  }
+
   bool forceLoopToExecuteOnce;
 };
 
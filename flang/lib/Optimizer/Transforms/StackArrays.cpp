@@ -0,0 +1,208 @@
+//===-- StackArrays.cpp ---------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Move small heap allocations that do not outlive their block to the stack.
+//
+// Lowering and the array-value-copy pass allocate array temporaries with
+// fir.allocmem and release them with fir.freemem, so that large temporaries do
+// not overflow the stack. Most of these temporaries are small and have a size
+// known at compile time, and when one is created in a loop body the loop calls
+// malloc and free on every iteration.
+//
+// A fir.allocmem is replaced by a fir.alloca in the entry block of the
+// function when
+//
+//   - its size is known at compile time, and it fits in what is left of a
+//     limit on the total size of the allocations moved to the stack in the
+//     function,
+//   - it is freed by a single fir.freemem in the same block, so that the
+//     lifetimes of the allocations of successive loop iterations are disjoint,
+//   - its address does not escape: it is only loaded from, stored to, or
+//     used to address elements that are in turn only loaded or stored, and
+//   - it is nested in the function through fir.do_loop, fir.iterate_while and
+//     fir.if operations only. Other regions, such as OpenMP parallel regions,
+//     may be executed concurrently and need an allocation of their own.
+//
+// The fir.freemem is removed.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "flang/Optimizer/Dialect/FIRDialect.h"
+#include "flang/Optimizer/Dialect/FIROps.h"
+#include "flang/Optimizer/Dialect/FIRType.h"
+#include "flang/Optimizer/Support/FIRContext.h"
+#include "flang/Optimizer/Support/KindMapping.h"
+#include "flang/Optimizer/Support/Utils.h"
+#include "flang/Optimizer/Transforms/Passes.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+
+#define DEBUG_TYPE "flang-stack-arrays"
+
+/// Size in bytes of a scalar of intrinsic type `type`, if it is known.
+static llvm::Optional<std::uint64_t>
+getIntrinsicTypeSize(mlir::Type type, const fir::KindMapping &kindMap) {
+  if (auto intTy = type.dyn_cast<mlir::IntegerType>())
+    return llvm::divideCeil(intTy.getWidth(), 8);
+  if (auto floatTy = type.dyn_cast<mlir::FloatType>())
+    return llvm::divideCeil(floatTy.getWidth(), 8);
+  if (auto cplxTy = type.dyn_cast<mlir::ComplexType>()) {
+    if (auto size = getIntrinsicTypeSize(cplxTy.getElementType(), kindMap))
+      return 2 * *size;
+    return llvm::None;
+  }
+  if (auto intTy = type.dyn_cast<fir::IntegerType>())
+    return llvm::divideCeil(kindMap.getIntegerBitsize(intTy.getFKind()), 8);
+  if (auto realTy = type.dyn_cast<fir::RealType>())
+    return llvm::divideCeil(kindMap.getRealBitsize(realTy.getFKind()), 8);
+  if (auto cplxTy = type.dyn_cast<fir::ComplexType>())
+    return 2 * llvm::divideCeil(kindMap.getRealBitsize(cplxTy.getFKind()), 8);
+  if (auto logTy = type.dyn_cast<fir::LogicalType>())
+    return llvm::divideCeil(kindMap.getLogicalBitsize(logTy.getFKind()), 8);
+  if (auto charTy = type.dyn_cast<fir::CharacterType>())
+    if (!charTy.hasDynamicLen())
+      return charTy.getLen() *
+             llvm::divideCeil(kindMap.getCharacterBitsize(charTy.getFKind()),
+                              8);
+  return llvm::None;
+}
+
+/// Size in bytes of the storage allocated by `alloc`, if it is known at
+/// compile time. The extents that are not in the type must be constants.
+static llvm::Optional<std::uint64_t>
+getAllocationSize(fir::AllocMemOp alloc, const fir::KindMapping &kindMap) {
+  if (alloc.hasLenParams())
+    return llvm::None;
+  auto type = alloc.getInType();
+  auto shapeOperands = alloc.getShapeOperands();
+  auto operand = shapeOperands.begin();
+  std::uint64_t count = 1;
+  if (auto seqTy = type.dyn_cast<fir::SequenceType>()) {
+    if (seqTy.hasUnknownShape())
+      return llvm::None;
+    for (auto extent : seqTy.getShape()) {
+      if (extent == fir::SequenceType::getUnknownExtent()) {
+        if (operand == shapeOperands.end())
+          return llvm::None;
+        auto cst = fir::getIntIfConstant(*operand++);
+        if (!cst || *cst < 0)
+          return llvm::None;
+        extent = *cst;
+      }
+      count = llvm::SaturatingMultiply(count,
+                                       static_cast<std::uint64_t>(extent));
+    }
+    type = seqTy.getEleTy();
+  }
+  if (operand != shapeOperands.end())
+    return llvm::None;
+  if (auto size = getIntrinsicTypeSize(type, kindMap))
+    return llvm::SaturatingMultiply(count, *size);
+  return llvm::None;
+}
+
+static bool escapes(mlir::Value addr);
+
+/// Does `user` let the memory address `addr` escape?
+static bool escapesThrough(mlir::Operation *user, mlir::Value addr) {
+  if (mlir::isa<fir::LoadOp, fir::ArrayLoadOp, fir::ArrayMergeStoreOp>(user))
+    return false;
+  if (auto store = mlir::dyn_cast<fir::StoreOp>(user))
+    return store.value() == addr;
+  if (mlir::isa<fir::CoordinateOp, fir::ArrayCoorOp>(user))
+    return escapes(user->getResult(0));
+  if (auto convert = mlir::dyn_cast<fir::ConvertOp>(user))
+    return !fir::isa_ref_type(convert.getType()) || escapes(convert);
+  return true;
+}
+
+static bool escapes(mlir::Value addr) {
+  return llvm::any_of(addr.getUsers(), [&](mlir::Operation *user) {
+    return escapesThrough(user, addr);
+  });
+}
+
+/// Is `op` nested in its function through sequential structured control flow
+/// only, so that it can use an allocation made in the entry block?
+static bool isInFunctionScope(mlir::Operation *op) {
+  auto *parent = op->getParentOp();
+  while (mlir::isa<fir::DoLoopOp, fir::IterWhileOp, fir::IfOp>(parent))
+    parent = parent->getParentOp();
+  return mlir::isa<mlir::FuncOp>(parent);
+}
+
+namespace {
+class StackArrays : public fir::StackArraysBase<StackArrays> {
+public:
+  void runOnFunction() override {
+    auto func = getFunction();
+    auto kindMap = fir::getKindMapping(func->getParentOfType<mlir::ModuleOp>());
+    llvm::SmallVector<fir::AllocMemOp> allocs;
+    func.walk([&](fir::AllocMemOp op) { allocs.push_back(op); });
+    // Every allocation moved to the stack adds to the frame of the function,
+    // so the limit bounds their total size, not the size of each of them.
+    std::uint64_t stackBytes = 0;
+    for (auto alloc : allocs)
+      if (auto size =
+              moveToStack(alloc, kindMap, maxStackArraySize - stackBytes))
+        stackBytes += *size;
+  }
+
+private:
+  /// Replace `alloc` by a stack allocation if it is at most `maxSize` bytes
+  /// and can be. Returns the size of the stack allocation.
+  llvm::Optional<std::uint64_t> moveToStack(fir::AllocMemOp alloc,
+                                            const fir::KindMapping &kindMap,
+                                            std::uint64_t maxSize) {
+    auto size = getAllocationSize(alloc, kindMap);
+    if (!size || *size > maxSize || !isInFunctionScope(alloc))
+      return llvm::None;
+    fir::FreeMemOp free;
+    for (auto *user : alloc->getUsers()) {
+      if (auto freeMem = mlir::dyn_cast<fir::FreeMemOp>(user)) {
+        if (free)
+          return llvm::None;
+        free = freeMem;
+      } else if (escapesThrough(user, alloc)) {
+        return llvm::None;
+      }
+    }
+    if (!free || free->getBlock() != alloc->getBlock())
+      return llvm::None;
+
+    auto loc = alloc.getLoc();
+    mlir::OpBuilder builder(&getContext());
+    builder.setInsertionPointToStart(&getFunction().front());
+    // The extents are constants, which are rematerialized in the entry block.
+    llvm::SmallVector<mlir::Value> shape;
+    for (auto extent : alloc.getShapeOperands())
+      shape.push_back(builder.clone(*extent.getDefiningOp())->getResult(0));
+    auto alloca = builder.create<fir::AllocaOp>(
+        loc, alloc.getInType(), alloc.uniq_name().getValueOr(""),
+        alloc.bindc_name().getValueOr(""), mlir::ValueRange{}, shape);
+    builder.setInsertionPoint(alloc);
+    auto addr = builder.create<fir::ConvertOp>(loc, alloc.getType(), alloca);
+    LLVM_DEBUG(llvm::dbgs() << "StackArrays: moved " << *size
+                            << " bytes to the stack\n";);
+    free.erase();
+    alloc.getResult().replaceAllUsesWith(addr.getResult());
+    alloc.erase();
+    return size;
+  }
+};
+} // namespace
+
+std::unique_ptr<mlir::Pass> fir::createStackArraysPass() {
+  return std::make_unique<StackArrays>();
+}
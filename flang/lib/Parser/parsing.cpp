@@ -13,7 +13,11 @@
 #include "flang/Parser/message.h"
 #include "flang/Parser/provenance.h"
 #include "flang/Parser/source.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <list>
+#include <vector>
 
 namespace Fortran::parser {
 
@@ -200,7 +204,327 @@ void Parsing::DumpParsingLog(llvm::raw_ostream &out) const {
   log_.Dump(out, allCooked_);
 }
 
+// Locates the ends of the top-level program units in a free form cooked
+// character stream, where each statement occupies one line, so that runs of
+// program units can be parsed independently.  Units are recognized from
+// their header and END statements only; nothing else in the statements is
+// examined.  A misplaced boundary is not fatal, since a failure to parse any
+// run of program units cleanly causes the whole stream to be parsed again
+// serially.
+class ProgramUnitScanner {
+public:
+  explicit ProgramUnitScanner(CharBlock cooked) : cooked_{cooked} {}
+
+  // Returns the position just past the final line of each top-level program
+  // unit, or nothing if the stream cannot be divided with confidence.
+  std::vector<const char *> FindUnitEnds() {
+    std::vector<const char *> result;
+    int depth{0}, interfaceDepth{0};
+    for (const char *line{cooked_.begin()}; line < cooked_.end();) {
+      const char *lineEnd{line};
+      while (lineEnd < cooked_.end() && *lineEnd != '\n') {
+        ++lineEnd;
+      }
+      switch (ClassifyLine(line, lineEnd)) {
+      case LineKind::Ignored:
+        break;
+      case LineKind::ModuleProcedure:
+        if (interfaceDepth > 0) {
+          break; // MODULE PROCEDURE statement in a generic interface
+        }
+        [[fallthrough]];
+      case LineKind::UnitHeader:
+        ++depth;
+        break;
+      case LineKind::UnitEnd:
+        if (depth > 0) {
+          --depth;
+        }
+        if (depth == 0 && interfaceDepth == 0) {
+          result.push_back(lineEnd < cooked_.end() ? lineEnd + 1 : lineEnd);
+        }
+        break;
+      case LineKind::InterfaceStart:
+        depth = std::max(depth, 1); // in a main program sans PROGRAM statement
+        ++interfaceDepth;
+        break;
+      case LineKind::InterfaceEnd:
+        if (--interfaceDepth < 0) {
+          return {};
+        }
+        break;
+      case LineKind::Other:
+        depth = std::max(depth, 1); // in a main program sans PROGRAM statement
+        break;
+      }
+      line = lineEnd + 1;
+    }
+    if (depth != 0 || interfaceDepth != 0) {
+      return {};
+    }
+    if (!result.empty()) {
+      result.back() = cooked_.end(); // absorb trailing compiler directives
+    }
+    return result;
+  }
+
+private:
+  enum class LineKind {
+    Ignored, // blank line or compiler directive
+    UnitHeader,
+    ModuleProcedure, // separate module procedure, or a generic's specific
+    UnitEnd,
+    InterfaceStart,
+    InterfaceEnd,
+    Other,
+  };
+
+  LineKind ClassifyLine(const char *line, const char *end) {
+    p_ = line;
+    end_ = end;
+    while (p_ < end_ && (*p_ == ' ' || IsDecimalDigit(*p_))) {
+      ++p_; // statement label
+    }
+    if (p_ == end_ || *p_ == '!') {
+      return LineKind::Ignored;
+    }
+    if (Keyword("end")) {
+      if (AtEnd()) {
+        return LineKind::UnitEnd;
+      } else if (Keyword("interface")) {
+        return LineKind::InterfaceEnd;
+      } else if (IsUnitKindKeyword()) {
+        return AtEndAfterOptionalName() ? LineKind::UnitEnd : LineKind::Other;
+      } else {
+        return LineKind::Other;
+      }
+    }
+    for (const char *combined : {"endprogram", "endsubroutine", "endfunction",
+             "endmodule", "endsubmodule", "endprocedure", "endblockdata"}) {
+      if (Keyword(combined)) {
+        return AtEndAfterOptionalName() ? LineKind::UnitEnd : LineKind::Other;
+      }
+    }
+    if (Keyword("endinterface")) {
+      return LineKind::InterfaceEnd;
+    }
+    if (Keyword("interface") || (Keyword("abstract") && Keyword("interface"))) {
+      return LineKind::InterfaceStart;
+    }
+    if (Keyword("program")) {
+      return Name() ? LineKind::UnitHeader : LineKind::Other;
+    }
+    if (Keyword("submodule")) {
+      return Next('(') ? LineKind::UnitHeader : LineKind::Other;
+    }
+    if (Keyword("blockdata") || (Keyword("block") && Keyword("data"))) {
+      return LineKind::UnitHeader;
+    }
+    if (Keyword("module")) {
+      if (Keyword("procedure")) {
+        return Name() ? LineKind::ModuleProcedure : LineKind::Other;
+      }
+      const char *afterModule{p_};
+      if (Name() && AtEnd()) {
+        return LineKind::UnitHeader;
+      }
+      p_ = afterModule; // MODULE prefix of a subprogram
+    }
+    // R1526 prefix -> prefix-spec [prefix-spec]...
+    while (true) {
+      if (Keyword("subroutine") || Keyword("function")) {
+        return Name() ? LineKind::UnitHeader : LineKind::Other;
+      } else if (Keyword("pure") || Keyword("impure") ||
+          Keyword("elemental") || Keyword("recursive") ||
+          Keyword("non_recursive") || Keyword("module")) {
+      } else if (Keyword("integer") || Keyword("real") ||
+          Keyword("complex") || Keyword("logical") ||
+          Keyword("character") || Keyword("doubleprecision") ||
+          Keyword("doublecomplex") ||
+          (Keyword("double") &&
+              (Keyword("precision") || Keyword("complex")))) {
+        if (Next('*')) {
+          if (!Parenthesized()) {
+            while (p_ < end_ && IsDecimalDigit(*p_)) {
+              ++p_;
+            }
+          }
+        } else {
+          Parenthesized();
+        }
+      } else if (Keyword("type") || Keyword("class")) {
+        if (!Parenthesized()) {
+          return LineKind::Other;
+        }
+      } else {
+        return LineKind::Other;
+      }
+    }
+  }
+
+  bool IsUnitKindKeyword() {
+    return Keyword("program") || Keyword("subroutine") ||
+        Keyword("function") || Keyword("module") || Keyword("submodule") ||
+        Keyword("procedure") || Keyword("blockdata") ||
+        (Keyword("block") && Keyword("data"));
+  }
+
+  // Matches a keyword that isn't the prefix of a longer name, and skips any
+  // following blank.
+  bool Keyword(const char *word) {
+    const char *p{p_};
+    for (; *word != '\0'; ++word, ++p) {
+      if (p >= end_ || *p != *word) {
+        return false;
+      }
+    }
+    if (p < end_ && IsLegalInIdentifier(*p)) {
+      return false;
+    }
+    p_ = p;
+    SkipBlank();
+    return true;
+  }
+
+  bool Name() {
+    if (p_ < end_ && IsLegalIdentifierStart(*p_)) {
+      while (p_ < end_ && IsLegalInIdentifier(*p_)) {
+        ++p_;
+      }
+      SkipBlank();
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  bool Next(char ch) {
+    if (p_ < end_ && *p_ == ch) {
+      ++p_;
+      SkipBlank();
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  // Skips a parenthesized kind or length selector.
+  bool Parenthesized() {
+    if (p_ >= end_ || *p_ != '(') {
+      return false;
+    }
+    int nesting{0};
+    char quote{'\0'};
+    for (; p_ < end_; ++p_) {
+      if (quote != '\0') {
+        if (*p_ == quote) {
+          quote = '\0';
+        }
+      } else if (*p_ == '\'' || *p_ == '"') {
+        quote = *p_;
+      } else if (*p_ == '(') {
+        ++nesting;
+      } else if (*p_ == ')' && --nesting == 0) {
+        ++p_;
+        SkipBlank();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool AtEnd() const { return p_ >= end_; }
+  bool AtEndAfterOptionalName() { return AtEnd() || (Name() && AtEnd()); }
+
+  void SkipBlank() {
+    if (p_ < end_ && *p_ == ' ') {
+      ++p_;
+    }
+  }
+
+  CharBlock cooked_;
+  const char *p_{nullptr}, *end_{nullptr};
+};
+
+// Parses runs of complete program units on a thread pool, and then
+// concatenates their parse trees and messages in source order.  Returns
+// false, having changed nothing, if the cooked character stream can't be
+// divided or any of the runs fails to parse without fatal errors; the
+// caller then parses the whole stream serially so that the diagnostics
+// are the same ones that a serial parse would produce.
+bool Parsing::ParseProgramUnitsConcurrently(llvm::raw_ostream &out) {
+  if (options_.isFixedForm || options_.instrumentedParse) {
+    return false;
+  }
+  llvm::ThreadPoolStrategy strategy{llvm::hardware_concurrency()};
+  unsigned threads{strategy.compute_thread_count()};
+  if (threads < 2) {
+    return false;
+  }
+  CharBlock whole{cooked().AsCharBlock()};
+  std::vector<const char *> unitEnds{ProgramUnitScanner{whole}.FindUnitEnds()};
+  if (unitEnds.size() < 2) {
+    return false;
+  }
+  // Group the program units into runs of comparable size, a few per thread,
+  // so that a single large unit doesn't leave the other threads idle.
+  std::size_t targetBytes{whole.size() / (4 * threads) + 1};
+  std::vector<CharBlock> runs;
+  const char *runStart{whole.begin()};
+  for (const char *unitEnd : unitEnds) {
+    if (static_cast<std::size_t>(unitEnd - runStart) >= targetBytes ||
+        unitEnd == unitEnds.back()) {
+      runs.emplace_back(runStart, unitEnd);
+      runStart = unitEnd;
+    }
+  }
+  if (runs.size() < 2) {
+    return false;
+  }
+  struct RunResult {
+    std::optional<Program> parseTree;
+    Messages messages;
+    bool ok{false};
+  };
+  std::vector<RunResult> results(runs.size());
+  {
+    llvm::ThreadPool pool{strategy};
+    for (std::size_t j{0}; j < runs.size(); ++j) {
+      pool.async([&, j]() {
+        UserState userState{allCooked_, options_.features};
+        userState.set_debugOutput(out);
+        ParseState parseState{runs[j]};
+        parseState.set_inFixedForm(options_.isFixedForm)
+            .set_userState(&userState);
+        RunResult &result{results[j]};
+        result.parseTree = program.Parse(parseState);
+        result.ok = result.parseTree && parseState.IsAtEnd() &&
+            !parseState.messages().AnyFatalError();
+        result.messages = std::move(parseState.messages());
+      });
+    }
+    pool.wait();
+  }
+  for (const RunResult &result : results) {
+    if (!result.ok) {
+      return false;
+    }
+  }
+  std::list<ProgramUnit> units;
+  for (RunResult &result : results) {
+    units.splice(units.end(), result.parseTree->v);
+    messages_.Annex(std::move(result.messages));
+  }
+  parseTree_.emplace(std::move(units));
+  consumedWholeFile_ = true;
+  finalRestingPlace_ = whole.end();
+  return true;
+}
+
 void Parsing::Parse(llvm::raw_ostream &out) {
+  if (options_.parallelParse && ParseProgramUnitsConcurrently(out)) {
+    return;
+  }
   UserState userState{allCooked_, options_.features};
   userState.set_debugOutput(out)
       .set_instrumentedParse(options_.instrumentedParse)
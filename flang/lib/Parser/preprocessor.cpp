@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstddef>
+#include <cstring>
 #include <ctime>
 #include <map>
 #include <memory>
@@ -628,7 +629,7 @@ void Preprocessor::Directive(const TokenSequence &dir, Prescanner &prescanner) {
     if (!included) {
       prescanner.Say(dir.GetTokenProvenanceRange(dirOffset),
           "#include: %s"_err_en_US, error.str());
-    } else if (included->bytes() > 0) {
+    } else if (included->bytes() > 0 && !IsRedundantInclusion(*included)) {
       ProvenanceRange fileRange{
           allSources_.AddIncludedFile(*included, dir.GetProvenanceRange())};
       Prescanner{prescanner}
@@ -650,6 +651,90 @@ bool Preprocessor::IsNameDefined(const CharBlock &token) {
   return definitions_.find(token) != definitions_.end();
 }
 
+// Scans the raw contents of a source file for an include guard: the first
+// significant line must be #ifndef NAME, the second #define NAME, and
+// the #endif that matches the first must be the last significant line.
+// Only blank lines and Fortran comments that can't be compiler directives
+// may appear outside the guard.  Returns the guard macro name, if any.
+static std::optional<std::string> FindIncludeGuard(const SourceFile &source) {
+  llvm::ArrayRef<char> content{source.content()};
+  const char *p{content.data()};
+  const char *limit{p + content.size()};
+  std::optional<std::string> guard;
+  int nesting{0};
+  bool sawDefine{false}, closed{false};
+  while (p < limit) {
+    const void *nl{std::memchr(p, '\n', limit - p)};
+    const char *eol{nl ? static_cast<const char *>(nl) : limit};
+    const char *start{p};
+    while (p < eol && (*p == ' ' || *p == '\t')) {
+      ++p;
+    }
+    bool inside{sawDefine && !closed};
+    if (p == eol) {
+      // blank line
+    } else if (*p != '#') {
+      if (!inside &&
+          (*p != '!' || std::memchr(p, '$', eol - p))) { // maybe !$omp &c.
+        return std::nullopt;
+      }
+    } else if (p == start + 5 || eol[-1] == '\\') {
+      return std::nullopt; // fixed form continuation, or continued directive
+    } else {
+      for (++p; p < eol && (*p == ' ' || *p == '\t'); ++p) {
+      }
+      const char *dir{p};
+      while (p < eol && IsLetter(*p)) {
+        ++p;
+      }
+      std::string dirName{dir, p};
+      while (p < eol && (*p == ' ' || *p == '\t')) {
+        ++p;
+      }
+      const char *name{p};
+      while (p < eol && IsLegalInIdentifier(*p)) {
+        ++p;
+      }
+      std::string nameText{name, p};
+      while (p < eol && (*p == ' ' || *p == '\t')) {
+        ++p;
+      }
+      if (inside) {
+        if (dirName == "ifdef" || dirName == "ifndef" || dirName == "if") {
+          ++nesting;
+        } else if (dirName == "endif") {
+          closed = nesting-- == 0;
+        } else if (nesting == 0 && (dirName == "else" || dirName == "elif")) {
+          return std::nullopt;
+        }
+      } else if (!guard && dirName == "ifndef" && !nameText.empty() &&
+          p == eol) {
+        guard = nameText;
+      } else if (guard && !sawDefine && dirName == "define" &&
+          nameText == *guard) {
+        sawDefine = true;
+      } else {
+        return std::nullopt;
+      }
+    }
+    p = eol + 1;
+  }
+  if (closed) {
+    return guard;
+  } else {
+    return std::nullopt;
+  }
+}
+
+bool Preprocessor::IsRedundantInclusion(const SourceFile &source) {
+  auto iter{includeGuards_.find(&source)};
+  if (iter == includeGuards_.end()) {
+    iter = includeGuards_.emplace(&source, FindIncludeGuard(source)).first;
+  }
+  const std::optional<std::string> &guard{iter->second};
+  return guard && IsNameDefined(CharBlock{*guard});
+}
+
 static std::string GetDirectiveName(
     const TokenSequence &line, std::size_t *rest) {
   std::size_t tokens{line.SizeInTokens()};
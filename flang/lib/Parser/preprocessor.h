@@ -20,6 +20,8 @@
 #include "flang/Parser/provenance.h"
 #include <cstddef>
 #include <list>
+#include <map>
+#include <optional>
 #include <stack>
 #include <string>
 #include <unordered_map>
@@ -74,6 +76,11 @@ public:
   void Undefine(std::string macro);
   bool IsNameDefined(const CharBlock &);
 
+  // True when a source file is wrapped in an include guard
+  // (#ifndef NAME / #define NAME / ... / #endif) whose macro is defined,
+  // so that including it again would have no effect.
+  bool IsRedundantInclusion(const SourceFile &);
+
   std::optional<TokenSequence> MacroReplacement(
       const TokenSequence &, Prescanner &);
 
@@ -95,6 +102,7 @@ private:
   std::list<std::string> names_;
   std::unordered_map<CharBlock, Definition> definitions_;
   std::stack<CanDeadElseAppear> ifStack_;
+  std::map<const SourceFile *, std::optional<std::string>> includeGuards_;
 };
 } // namespace Fortran::parser
 #endif // FORTRAN_PARSER_PREPROCESSOR_H_
@@ -361,8 +361,11 @@ void Prescanner::EnforceStupidEndStatementRules(const TokenSequence &tokens) {
 }
 
 void Prescanner::SkipToEndOfLine() {
-  while (*at_ != '\n') {
-    ++at_, ++column_;
+  if (*at_ != '\n') {
+    const void *nl{std::memchr(at_, '\n', limit_ - at_)};
+    const char *end{nl ? static_cast<const char *>(nl) : limit_};
+    column_ += end - at_;
+    at_ = end;
   }
 }
 
@@ -437,6 +440,12 @@ void Prescanner::SkipCComments() {
 }
 
 void Prescanner::SkipSpaces() {
+  if (!inFixedForm_) {
+    // Blanks followed by more blanks can't precede anything significant.
+    while (at_[0] == ' ' && at_[1] == ' ') {
+      ++at_, ++column_;
+    }
+  }
   while (*at_ == ' ' || *at_ == '\t') {
     NextChar();
   }
@@ -576,6 +585,21 @@ bool Prescanner::NextToken(TokenSequence &tokens) {
     }
     preventHollerith_ = false;
   } else if (IsLegalInIdentifier(*at_)) {
+    if (!inFixedForm_) {
+      // Free form names can't be split except by a continuation, which
+      // can't begin before the end of a run of identifier characters on
+      // the line, so all but the last character of the run are copied
+      // in bulk.
+      const char *p{at_ + 1};
+      while (IsLegalInIdentifier(*p)) {
+        ++p;
+      }
+      if (const char *last{p - 1}; last > at_) {
+        tokens.PutNextTokenChars(at_, last - at_, GetCurrentProvenance());
+        column_ += last - at_;
+        at_ = last;
+      }
+    }
     do {
     } while (IsLegalInIdentifier(EmitCharAndAdvance(tokens, *at_)));
     if ((*at_ == '\'' || *at_ == '"') &&
@@ -840,7 +864,8 @@ void Prescanner::FortranInclude(const char *firstQuote) {
       allSources_.Open(path, error, std::move(prependPath))};
   if (!included) {
     Say(provenance, "INCLUDE: %s"_err_en_US, error.str());
-  } else if (included->bytes() > 0) {
+  } else if (included->bytes() > 0 &&
+      !preprocessor_.IsRedundantInclusion(*included)) {
     ProvenanceRange includeLineRange{
         provenance, static_cast<std::size_t>(p - nextLine_)};
     ProvenanceRange fileRange{
@@ -8,6 +8,7 @@
 
 #include "flang/Parser/provenance.h"
 #include "flang/Common/idioms.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <utility>
@@ -180,8 +181,27 @@ const SourceFile *AllSources::Open(std::string path, llvm::raw_ostream &error,
   if (!found) {
     error << "Source file '" << path << "' was not found";
     return nullptr;
-  } else if (source->Open(*found, error)) {
-    return ownedSourceFiles_.emplace_back(std::move(source)).get();
+  }
+  llvm::sys::fs::file_status status;
+  bool haveStatus{!llvm::sys::fs::status(*found, status)};
+  std::int64_t modified{
+      status.getLastModificationTime().time_since_epoch().count()};
+  if (haveStatus) {
+    auto iter{openedSourceFiles_.find(*found)};
+    if (iter != openedSourceFiles_.end() &&
+        iter->second.size == status.getSize() &&
+        iter->second.modified == modified &&
+        iter->second.source->encoding() == encoding_) {
+      return iter->second.source;
+    }
+  }
+  if (source->Open(*found, error)) {
+    const SourceFile *result{
+        ownedSourceFiles_.emplace_back(std::move(source)).get()};
+    if (haveStatus) {
+      openedSourceFiles_[*found] = {result, status.getSize(), modified};
+    }
+    return result;
   } else {
     return nullptr;
   }
@@ -14,6 +14,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -35,8 +36,12 @@ static std::vector<std::size_t> FindLineStarts(llvm::StringRef source) {
   return result;
 }
 
-void SourceFile::RecordLineStarts() {
-  lineStart_ = FindLineStarts({content().data(), bytes()});
+const std::vector<std::size_t> &SourceFile::lineStarts() const {
+  CHECK(lineStart_);
+  std::call_once(lineStart_->found, [this]() {
+    lineStart_->offsets = FindLineStarts({content().data(), bytes()});
+  });
+  return lineStart_->offsets;
 }
 
 // Check for a Unicode byte order mark (BOM).
@@ -109,7 +114,8 @@ bool SourceFile::Open(std::string path, llvm::raw_ostream &error) {
   Close();
   path_ = path;
   std::string errorPath{"'"s + path_ + "'"};
-  auto bufOr{llvm::WritableMemoryBuffer::getFile(path)};
+  auto bufOr{llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+      /*RequiresNullTerminator=*/false)};
   if (!bufOr) {
     auto err = bufOr.getError();
     error << "Could not open " << errorPath << ": " << err.message();
@@ -129,42 +135,41 @@ bool SourceFile::ReadStandardInput(llvm::raw_ostream &error) {
     error << err.message();
     return false;
   }
-  auto inbuf = std::move(buf_or.get());
-  buf_ =
-      llvm::WritableMemoryBuffer::getNewUninitMemBuffer(inbuf->getBufferSize());
-  llvm::copy(inbuf->getBuffer(), buf_->getBufferStart());
+  buf_ = std::move(buf_or.get());
   ReadFile();
   return true;
 }
 
 void SourceFile::ReadFile() {
-  buf_end_ = RemoveCarriageReturns(buf_->getBuffer());
-  if (content().size() == 0 || content().back() != '\n') {
-    // Don't bother to copy if we have spare memory
-    if (content().size() >= buf_->getBufferSize()) {
-      auto tmp_buf{llvm::WritableMemoryBuffer::getNewUninitMemBuffer(
-          content().size() + 1)};
-      llvm::copy(content(), tmp_buf->getBufferStart());
-      buf_ = std::move(tmp_buf);
+  llvm::StringRef raw{buf_->getBuffer()};
+  buf_end_ = raw.size();
+  if (raw.empty() || raw.back() != '\n' ||
+      std::memchr(raw.data(), '\r', raw.size())) {
+    // Normalize a copy, leaving room for an ultimate newline
+    auto copy{llvm::WritableMemoryBuffer::getNewUninitMemBuffer(raw.size() + 1)};
+    llvm::copy(raw, copy->getBufferStart());
+    buf_end_ = RemoveCarriageReturns(copy->getBuffer().take_front(raw.size()));
+    if (buf_end_ == 0 || copy->getBufferStart()[buf_end_ - 1] != '\n') {
+      copy->getBufferStart()[buf_end_++] = '\n';
     }
-    buf_end_++;
-    buf_->getBuffer()[buf_end_ - 1] = '\n';
+    buf_ = std::move(copy);
   }
   IdentifyPayload();
-  RecordLineStarts();
+  lineStart_ = std::make_unique<LineStartTable>();
 }
 
 void SourceFile::Close() {
   path_.clear();
   buf_.reset();
+  lineStart_.reset();
 }
 
 SourcePosition SourceFile::FindOffsetLineAndColumn(std::size_t at) const {
   CHECK(at < bytes());
-
-  auto it = llvm::upper_bound(lineStart_, at);
-  auto low = std::distance(lineStart_.begin(), it - 1);
+  const std::vector<std::size_t> &lineStart{lineStarts()};
+  auto it = llvm::upper_bound(lineStart, at);
+  auto low = std::distance(lineStart.begin(), it - 1);
   return {*this, static_cast<int>(low + 1),
-      static_cast<int>(at - lineStart_[low] + 1)};
+      static_cast<int>(at - lineStart[low] + 1)};
 }
 } // namespace Fortran::parser
@@ -128,8 +128,8 @@ void TokenSequence::Put(
 
 void TokenSequence::Put(
     const char *s, std::size_t bytes, Provenance provenance) {
-  for (std::size_t j{0}; j < bytes; ++j) {
-    PutNextTokenChar(s[j], provenance + j);
+  if (bytes > 0) {
+    PutNextTokenChars(s, bytes, provenance);
   }
   CloseToken();
 }
@@ -82,6 +82,13 @@ public:
     provenances_.Put({provenance, 1});
   }
 
+  // Appends a run of characters with contiguous provenances to the
+  // currently open token.
+  void PutNextTokenChars(const char *s, std::size_t bytes, Provenance start) {
+    char_.insert(char_.end(), s, s + bytes);
+    provenances_.Put({start, bytes});
+  }
+
   void CloseToken() {
     start_.emplace_back(nextStart_);
     nextStart_ = char_.size();
@@ -45,6 +45,14 @@ public:
   bool IsAtEnd() const { return at_ == end_; }
   const SomeExpr *operator*() const { return GetExpr(GetConstant()); }
   parser::CharBlock LocateSource() const { return GetConstant().source; }
+  // The number of times that the current value will be used again
+  ConstantSubscript repetitionsRemaining() const {
+    return repetitionsRemaining_;
+  }
+  void SkipRepetitions(ConstantSubscript n) {
+    CHECK(n >= 0 && n <= repetitionsRemaining_);
+    repetitionsRemaining_ -= n;
+  }
   ValueListIterator &operator++() {
     if (repetitionsRemaining_ > 0) {
       --repetitionsRemaining_;
@@ -106,6 +114,11 @@ private:
   bool InitDesignator(const SomeExpr &);
   // Initializes a single object.
   bool InitElement(const evaluate::OffsetSymbol &, const SomeExpr &designator);
+  // Replicates the value just used to initialize an element of a whole
+  // array into as many of the following elements as the value's repeat
+  // count allows; returns the number of elements so initialized.
+  ConstantSubscript InitRepeatedElements(const evaluate::OffsetSymbol &,
+      const SomeExpr &designator, ConstantSubscript remainingElements);
   // If the returned flag is true, emit a warning about CHARACTER misusage.
   std::optional<std::pair<SomeExpr, bool>> ConvertElement(
       const SomeExpr &, const evaluate::DynamicType &);
@@ -113,6 +126,11 @@ private:
   DataInitializations &inits_;
   evaluate::ExpressionAnalyzer &exprAnalyzer_;
   ValueListIterator values_;
+  // The last value converted and folded without a warning, for reuse
+  // when it is repeated for elements of the same type
+  const SomeExpr *lastValue_{nullptr};
+  std::optional<evaluate::DynamicType> lastValueType_;
+  std::optional<SomeExpr> lastFolded_;
 };
 
 bool DataInitializationCompiler::Scan(const parser::DataStmtObject &object) {
@@ -207,6 +225,16 @@ bool DataInitializationCompiler::Scan(const parser::DataIDoObject &object) {
 bool DataInitializationCompiler::InitDesignator(const SomeExpr &designator) {
   evaluate::FoldingContext &context{exprAnalyzer_.GetFoldingContext()};
   evaluate::DesignatorFolder folder{context};
+  // The elements of a whole array are visited in storage order, so
+  // repeated values can be applied to them in bulk.
+  std::optional<ConstantSubscript> remainingElements;
+  if (const Symbol * whole{evaluate::UnwrapWholeSymbolDataRef(designator)}) {
+    if (whole->Rank() > 0 && !IsPointer(*whole) && !IsAllocatable(*whole)) {
+      if (auto extents{evaluate::GetConstantExtents(context, *whole)}) {
+        remainingElements = evaluate::GetSize(*extents);
+      }
+    }
+  }
   while (auto offsetSymbol{folder.FoldDesignator(designator)}) {
     if (folder.isOutOfRange()) {
       if (auto bad{evaluate::OffsetToDesignator(context, *offsetSymbol)}) {
@@ -222,12 +250,44 @@ bool DataInitializationCompiler::InitDesignator(const SomeExpr &designator) {
     } else if (!InitElement(*offsetSymbol, designator)) {
       return false;
     } else {
+      if (remainingElements) {
+        --*remainingElements;
+        if (auto copies{InitRepeatedElements(
+                *offsetSymbol, designator, *remainingElements)}) {
+          folder.Skip(copies);
+          values_.SkipRepetitions(copies);
+          *remainingElements -= copies;
+        }
+      }
       ++values_;
     }
   }
   return folder.isEmpty();
 }
 
+ConstantSubscript DataInitializationCompiler::InitRepeatedElements(
+    const evaluate::OffsetSymbol &offsetSymbol, const SomeExpr &designator,
+    ConstantSubscript remainingElements) {
+  auto copies{std::min(values_.repetitionsRemaining(), remainingElements)};
+  // Only a value that was just placed into the image without a warning
+  // is known to produce the same bytes and no messages for each element.
+  if (copies <= 0 || !lastValue_ || lastValue_ != *values_ ||
+      lastValueType_ != designator.GetType()) {
+    return 0;
+  }
+  const Symbol &symbol{offsetSymbol.symbol()};
+  auto &symbolInit{inits_.find(&symbol)->second};
+  if (symbolInit.image.Replicate(offsetSymbol.offset(), offsetSymbol.size(),
+          copies) != evaluate::InitialImage::Ok) {
+    return 0;
+  }
+  symbolInit.initializedRanges.back().Annex(
+      {offsetSymbol.offset() +
+              static_cast<ConstantSubscript>(offsetSymbol.size()),
+          offsetSymbol.size() * static_cast<std::size_t>(copies)});
+  return copies;
+}
+
 std::optional<std::pair<SomeExpr, bool>>
 DataInitializationCompiler::ConvertElement(
     const SomeExpr &expr, const evaluate::DynamicType &type) {
@@ -281,8 +341,13 @@ bool DataInitializationCompiler::InitElement(
   const auto GetImage{[&]() -> evaluate::InitialImage & {
     auto iter{inits_.emplace(&symbol, symbol.size())};
     auto &symbolInit{iter.first->second};
-    symbolInit.initializedRanges.emplace_back(
-        offsetSymbol.offset(), offsetSymbol.size());
+    // Consecutive elements (e.g., from an implied DO loop) share a range
+    SymbolDataInitialization::Range range{
+        offsetSymbol.offset(), offsetSymbol.size()};
+    auto &ranges{symbolInit.initializedRanges};
+    if (ranges.empty() || !ranges.back().AnnexIfPredecessor(range)) {
+      ranges.emplace_back(std::move(range));
+    }
     return symbolInit.image;
   }};
   const auto OutOfRangeError{[&]() {
@@ -292,6 +357,25 @@ bool DataInitializationCompiler::InitElement(
             DescribeElement(), symbol.name()),
         symbol);
   }};
+  const auto AddToImage{[&](const SomeExpr &folded) {
+    switch (GetImage().Add(
+        offsetSymbol.offset(), offsetSymbol.size(), folded, context)) {
+    case evaluate::InitialImage::Ok:
+      return true;
+    case evaluate::InitialImage::NotAConstant:
+      exprAnalyzer_.Say(
+          "DATA statement value '%s' for '%s' is not a constant"_err_en_US,
+          folded.AsFortran(), DescribeElement());
+      break;
+    case evaluate::InitialImage::OutOfRange:
+      OutOfRangeError();
+      break;
+    default:
+      CHECK(exprAnalyzer_.context().AnyFatalError());
+      break;
+    }
+    return false;
+  }};
 
   if (values_.hasFatalError()) {
     return false;
@@ -342,7 +426,10 @@ bool DataInitializationCompiler::InitElement(
     exprAnalyzer_.Say("Initializer for '%s' must not be a procedure"_err_en_US,
         DescribeElement());
   } else if (auto designatorType{designator.GetType()}) {
-    if (expr->Rank() > 0) {
+    if (expr == lastValue_ && designatorType == lastValueType_) {
+      // A repeated value; it has already been checked and converted.
+      return AddToImage(*lastFolded_);
+    } else if (expr->Rank() > 0) {
       // Because initial-data-target is ambiguous with scalar-constant and
       // scalar-constant-subobject at parse time, enforcement of scalar-*
       // must be deferred to here.
@@ -360,24 +447,17 @@ bool DataInitializationCompiler::InitElement(
         exprAnalyzer_.context().Say(
             "DATA statement value initializes '%s' of type '%s' with CHARACTER"_en_US,
             DescribeElement(), designatorType->AsFortran());
+      } else {
+        lastFolded_ = evaluate::Fold(context, std::move(converted->first));
+        if (AddToImage(*lastFolded_)) {
+          lastValue_ = expr;
+          lastValueType_ = designatorType;
+          return true;
+        }
+        lastValue_ = nullptr;
+        return false;
       }
-      auto folded{evaluate::Fold(context, std::move(converted->first))};
-      switch (GetImage().Add(
-          offsetSymbol.offset(), offsetSymbol.size(), folded, context)) {
-      case evaluate::InitialImage::Ok:
-        return true;
-      case evaluate::InitialImage::NotAConstant:
-        exprAnalyzer_.Say(
-            "DATA statement value '%s' for '%s' is not a constant"_err_en_US,
-            folded.AsFortran(), DescribeElement());
-        break;
-      case evaluate::InitialImage::OutOfRange:
-        OutOfRangeError();
-        break;
-      default:
-        CHECK(exprAnalyzer_.context().AnyFatalError());
-        break;
-      }
+      return AddToImage(evaluate::Fold(context, std::move(converted->first)));
     } else {
       exprAnalyzer_.context().Say(
           "DATA statement value could not be converted to the type '%s' of the object '%s'"_err_en_US,
@@ -531,8 +611,21 @@ static bool CheckForOverlappingInitialization(
             static_cast<ConstantSubscript>(
                 symbol.offset() - symbols.front()->offset())};
         if (offset >= 0) {
+          // A range can span consecutive array elements; its first
+          // element is the one that overlaps.
+          std::size_t size{range.size()};
+          if (symbol.Rank() > 0) {
+            if (auto type{evaluate::DynamicType::From(symbol)}) {
+              if (auto bytes{evaluate::ToInt64(
+                      type->MeasureSizeInBytes(context, true))}) {
+                if (*bytes > 0 && size > static_cast<std::size_t>(*bytes)) {
+                  size = *bytes;
+                }
+              }
+            }
+          }
           if (auto badDesignator{evaluate::OffsetToDesignator(
-                  context, symbol, offset, range.size())}) {
+                  context, symbol, offset, size)}) {
             hit = true;
             exprAnalyzer.Say(symbol.name(),
                 "%s affect '%s' more than once"_err_en_US, what,
@@ -542,7 +635,10 @@ static bool CheckForOverlappingInitialization(
       }
       CHECK(hit);
     }
-    next = range.start() + range.size();
+    // A range can span many elements, so a later range that starts past
+    // the end of its predecessor may still overlap an earlier one.
+    next = std::max(next,
+        range.start() + static_cast<ConstantSubscript>(range.size()));
     CHECK(next <= static_cast<ConstantSubscript>(initialization.image.size()));
   }
   return result;
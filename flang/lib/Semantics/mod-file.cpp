@@ -103,6 +103,8 @@ bool ModFileWriter::WriteAll() {
   // this flag affects character literals: force it to be consistent
   auto restorer{
       common::ScopedSet(parser::useHexadecimalEscapeSequences, false)};
+  common::PhaseTimer timer{context_.phaseTimers(),
+      common::PhaseGroup::ModuleFiles, "write", "Module file writing"};
   WriteAll(context_.globalScope());
   return !context_.AnyFatalError();
 }
@@ -819,6 +821,8 @@ Scope *ModFileReader::Read(
       return it->second->scope();
     }
   }
+  common::PhaseTimer timer{context_.phaseTimers(),
+      common::PhaseGroup::ModuleFiles, "read", "Module file reading"};
   parser::Parsing parsing{context_.allCookedSources()};
   parser::Options options;
   options.isModuleFile = true;
@@ -72,18 +72,36 @@ SymbolVector Scope::GetSymbols() const {
   return GetSortedSymbols<const Symbol>(symbols_);
 }
 
+static llvm::StringRef IndexKey(const SourceName &name) {
+  return {name.begin(), name.size()};
+}
+
 Scope::iterator Scope::find(const SourceName &name) {
-  return symbols_.find(name);
+  auto it{symbolIndex_.find(IndexKey(name))};
+  return it != symbolIndex_.end() ? it->second : end();
+}
+Scope::const_iterator Scope::find(const SourceName &name) const {
+  auto it{symbolIndex_.find(IndexKey(name))};
+  return it != symbolIndex_.end() ? const_iterator{it->second} : end();
 }
 Scope::size_type Scope::erase(const SourceName &name) {
-  auto it{symbols_.find(name)};
+  auto it{find(name)};
   if (it != end()) {
+    symbolIndex_.erase(IndexKey(name));
     symbols_.erase(it);
     return 1;
   } else {
     return 0;
   }
 }
+std::pair<Scope::iterator, bool> Scope::Insert(
+    const SourceName &name, Symbol &symbol) {
+  auto result{symbols_.emplace(name, symbol)};
+  if (result.second) {
+    symbolIndex_.try_emplace(IndexKey(result.first->first), result.first);
+  }
+  return result;
+}
 Symbol *Scope::FindSymbol(const SourceName &name) const {
   auto it{find(name)};
   if (it != end()) {
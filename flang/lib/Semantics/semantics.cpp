@@ -163,16 +163,42 @@ using StatementSemanticsPass2 = SemanticsVisitor<AccStructureChecker,
     OmpStructureChecker, PurityChecker, ReturnStmtChecker,
     SelectRankConstructChecker, SelectTypeChecker, StopChecker>;
 
+// Times a phase of semantics for -ftime-report
+static common::PhaseTimer TimePhase(SemanticsContext &context,
+    const char *name, const char *description) {
+  return {context.phaseTimers(), common::PhaseGroup::Semantics, name,
+      description};
+}
+
 static bool PerformStatementSemantics(
     SemanticsContext &context, parser::Program &program) {
-  ResolveNames(context, program);
-  RewriteParseTree(context, program);
-  ComputeOffsets(context, context.globalScope());
-  CheckDeclarations(context);
-  StatementSemanticsPass1{context}.Walk(program);
+  {
+    auto timer{TimePhase(context, "resolve-names", "Name resolution")};
+    ResolveNames(context, program);
+  }
+  {
+    auto timer{TimePhase(context, "rewrite", "Parse tree rewriting")};
+    RewriteParseTree(context, program);
+  }
+  {
+    auto timer{TimePhase(context, "offsets", "Storage layout")};
+    ComputeOffsets(context, context.globalScope());
+  }
+  {
+    auto timer{TimePhase(context, "declarations", "Declaration checks")};
+    CheckDeclarations(context);
+  }
+  {
+    auto timer{TimePhase(context, "expressions", "Expression analysis")};
+    StatementSemanticsPass1{context}.Walk(program);
+  }
   StatementSemanticsPass2 pass2{context};
-  pass2.Walk(program);
+  {
+    auto timer{TimePhase(context, "statements", "Statement checks")};
+    pass2.Walk(program);
+  }
   if (!context.AnyFatalError()) {
+    auto timer{TimePhase(context, "data", "DATA statement initializers")};
     pass2.CompileDataInitializationsIntoInitializers();
   }
   return !context.AnyFatalError();
@@ -371,11 +397,17 @@ bool Semantics::Perform() {
       context_.UseFortranBuiltinsModule();
     }
   }
-  return ValidateLabels(context_, program_) &&
-      parser::CanonicalizeDo(program_) && // force line break
-      CanonicalizeAcc(context_.messages(), program_) &&
-      CanonicalizeOmp(context_.messages(), program_) &&
-      PerformStatementSemantics(context_, program_) &&
+  {
+    auto timer{TimePhase(context_, "canonicalize",
+        "Label validation and canonicalization")};
+    if (!(ValidateLabels(context_, program_) &&
+            parser::CanonicalizeDo(program_) && // force line break
+            CanonicalizeAcc(context_.messages(), program_) &&
+            CanonicalizeOmp(context_.messages(), program_))) {
+      return false;
+    }
+  }
+  return PerformStatementSemantics(context_, program_) &&
       ModFileWriter{context_}.WriteAll();
 }
 
@@ -11,13 +11,35 @@
 #include "terminator.h"
 #include "type-info.h"
 #include "flang/Runtime/descriptor.h"
+#include <algorithm>
+#include <cstring>
 
 namespace Fortran::runtime {
 
-int Initialize(const Descriptor &instance, const typeInfo::DerivedType &derived,
+// The default initialization of the elements of an instance is the same
+// unless a component must be allocated separately for each element.
+static bool HasAutomaticComponent(const typeInfo::DerivedType &derived) {
+  const Descriptor &componentDesc{derived.component()};
+  std::size_t myComponents{componentDesc.Elements()};
+  for (std::size_t k{0}; k < myComponents; ++k) {
+    const auto &comp{
+        *componentDesc.ZeroBasedIndexedElement<typeInfo::Component>(k)};
+    if (comp.genre() == typeInfo::Component::Genre::Automatic) {
+      return true;
+    } else if (comp.genre() == typeInfo::Component::Genre::Data &&
+        comp.derivedType() && !comp.derivedType()->noInitializationNeeded() &&
+        HasAutomaticComponent(*comp.derivedType())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Initializes the first `elements` elements of an instance.
+static int InitializeElements(const Descriptor &instance,
+    const typeInfo::DerivedType &derived, std::size_t elements,
     Terminator &terminator, bool hasStat, const Descriptor *errMsg) {
   const Descriptor &componentDesc{derived.component()};
-  std::size_t elements{instance.Elements()};
   std::size_t byteStride{instance.ElementBytes()};
   int stat{StatOk};
   // Initialize data components in each element; the per-element iteration
@@ -93,6 +115,32 @@ int Initialize(const Descriptor &instance, const typeInfo::DerivedType &derived,
   return stat;
 }
 
+int Initialize(const Descriptor &instance, const typeInfo::DerivedType &derived,
+    Terminator &terminator, bool hasStat, const Descriptor *errMsg) {
+  std::size_t elements{instance.Elements()};
+  if (elements <= 1 || !instance.IsContiguous() ||
+      HasAutomaticComponent(derived)) {
+    return InitializeElements(
+        instance, derived, elements, terminator, hasStat, errMsg);
+  }
+  // Initialize the first element component by component, then use it as
+  // the image of an initialized element and replicate it with copies of
+  // doubling size.  The descriptors of allocatable components are
+  // unallocated and so hold no address specific to their element.
+  int stat{
+      InitializeElements(instance, derived, 1, terminator, hasStat, errMsg)};
+  if (stat == StatOk) {
+    char *image{instance.OffsetElement<char>()};
+    std::size_t elementBytes{instance.ElementBytes()};
+    for (std::size_t done{1}; done < elements;) {
+      std::size_t copies{std::min(done, elements - done)};
+      std::memcpy(image + done * elementBytes, image, copies * elementBytes);
+      done += copies;
+    }
+  }
+  return stat;
+}
+
 static const typeInfo::SpecialBinding *FindFinal(
     const typeInfo::DerivedType &derived, int rank) {
   if (const auto *ranked{derived.FindSpecialBinding(
@@ -207,6 +255,66 @@ void Finalize(
   }
 }
 
+// A destruction plan lists the descriptors of the allocatable and automatic
+// components of an element, at any depth of nested data components, so that
+// the elements of an array are destroyed by one tight loop over the elements
+// rather than by walking the component tree for each element.  Subtrees
+// whose types need no destruction are skipped while the plan is built.
+class DestructionPlan {
+public:
+  // Adds the components of an element of type `derived` at `offset` within
+  // the elements of `instance`.  Returns false if the plan would be too
+  // large, or depends on LEN type parameters of nested data components.
+  bool Add(const Descriptor &instance, const typeInfo::DerivedType &derived,
+      std::size_t offset) {
+    const Descriptor &componentDesc{derived.component()};
+    std::size_t myComponents{componentDesc.Elements()};
+    for (std::size_t k{0}; k < myComponents; ++k) {
+      const auto &comp{
+          *componentDesc.ZeroBasedIndexedElement<typeInfo::Component>(k)};
+      if (comp.genre() == typeInfo::Component::Genre::Allocatable ||
+          comp.genre() == typeInfo::Component::Genre::Automatic) {
+        if (entries_ == maxEntries) {
+          return false;
+        }
+        entry_[entries_++] = offset + comp.offset();
+      } else if (comp.genre() == typeInfo::Component::Genre::Data &&
+          comp.derivedType() && !comp.derivedType()->noDestructionNeeded()) {
+        const typeInfo::DerivedType &compType{*comp.derivedType()};
+        if (compType.LenParameters() > 0) {
+          return false;
+        }
+        std::size_t elements{comp.GetElements(instance)};
+        for (std::size_t j{0}; j < elements; ++j) {
+          if (!Add(instance, compType,
+                  offset + comp.offset() + j * compType.sizeInBytes())) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  void Execute(const Descriptor &instance) const {
+    std::size_t elements{instance.Elements()};
+    std::size_t byteStride{instance.ElementBytes()};
+    for (std::size_t j{0}; j < elements; ++j) {
+      for (int k{0}; k < entries_; ++k) {
+        // The dynamic type of a polymorphic component may need destruction
+        // even when its declared type does not; Destroy() checks.
+        instance.OffsetElement<Descriptor>(j * byteStride + entry_[k])
+            ->Destroy(false);
+      }
+    }
+  }
+
+private:
+  static constexpr int maxEntries{64};
+  std::size_t entry_[maxEntries]; // offsets of descriptors within an element
+  int entries_{0};
+};
+
 // The order of finalization follows Fortran 2018 7.5.6.2, with
 // elementwise finalization of non-parent components taking place
 // before parent component finalization, and with all finalization
@@ -219,6 +327,11 @@ void Destroy(const Descriptor &descriptor, bool finalize,
   if (finalize && !derived.noFinalizationNeeded()) {
     Finalize(descriptor, derived);
   }
+  DestructionPlan plan;
+  if (plan.Add(descriptor, derived, 0)) {
+    plan.Execute(descriptor);
+    return;
+  }
   const Descriptor &componentDesc{derived.component()};
   std::size_t myComponents{componentDesc.Elements()};
   std::size_t elements{descriptor.Elements()};
@@ -230,7 +343,27 @@ void Destroy(const Descriptor &descriptor, bool finalize,
         comp.genre() == typeInfo::Component::Genre::Automatic) {
       for (std::size_t j{0}; j < elements; ++j) {
         descriptor.OffsetElement<Descriptor>(j * byteStride + comp.offset())
-            ->Deallocate();
+            ->Destroy(false);
+      }
+    } else if (comp.genre() == typeInfo::Component::Genre::Data &&
+        comp.derivedType() && !comp.derivedType()->noDestructionNeeded()) {
+      SubscriptValue extent[maxRank];
+      const typeInfo::Value *bounds{comp.bounds()};
+      for (int dim{0}; dim < comp.rank(); ++dim) {
+        typeInfo::TypeParameterValue lb{
+            bounds[2 * dim].GetValue(&descriptor).value_or(0)};
+        typeInfo::TypeParameterValue ub{
+            bounds[2 * dim + 1].GetValue(&descriptor).value_or(0)};
+        extent[dim] = ub >= lb ? ub - lb + 1 : 0;
+      }
+      StaticDescriptor<maxRank, true, 0> staticDescriptor;
+      Descriptor &compDesc{staticDescriptor.descriptor()};
+      const typeInfo::DerivedType &compType{*comp.derivedType()};
+      for (std::size_t j{0}; j < elements; ++j) {
+        compDesc.Establish(compType,
+            descriptor.OffsetElement<char>(j * byteStride + comp.offset()),
+            comp.rank(), extent);
+        Destroy(compDesc, false, compType);
       }
     }
   }
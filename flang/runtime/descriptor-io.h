@@ -23,6 +23,7 @@
 #include "flang/Common/uint128.h"
 #include "flang/Runtime/cpp-type.h"
 #include "flang/Runtime/descriptor.h"
+#include <limits>
 
 namespace Fortran::runtime::io::descr {
 template <typename A>
@@ -38,6 +39,27 @@ inline A &ExtractElement(IoStatementState &io, const Descriptor &descriptor,
 
 // Per-category descriptor-based I/O templates
 
+// On output, the format is asked for the data edit descriptor of a run of as
+// many elements as remain, and the elements of the run are edited together
+// into staged output (see StagedOutput in io-stmt.h) that is emitted at once.
+// List-directed output positions each item in the record, so it is not
+// staged.
+template <Direction DIR>
+inline int MaxDataEditRepeat(std::size_t remainingElements) {
+  if constexpr (DIR == Direction::Output) {
+    return static_cast<int>(std::min<std::size_t>(
+        remainingElements, std::numeric_limits<int>::max()));
+  } else {
+    return 1;
+  }
+}
+
+template <Direction DIR>
+inline bool IsStagedOutput(const DataEdit &edit) {
+  return DIR == Direction::Output && edit.repeat > 1 &&
+      !edit.IsListDirected();
+}
+
 // TODO (perhaps as a nontrivial but small starter project): implement
 // automatic repetition counts, like "10*3.14159", for list-directed and
 // NAMELIST array output.
@@ -49,21 +71,33 @@ inline bool FormattedIntegerIO(
   SubscriptValue subscripts[maxRank];
   descriptor.GetLowerBounds(subscripts);
   using IntType = CppTypeFor<TypeCategory::Integer, KIND>;
-  for (std::size_t j{0}; j < numElements; ++j) {
-    if (auto edit{io.GetNextDataEdit()}) {
-      IntType &x{ExtractElement<IntType>(io, descriptor, subscripts)};
-      if constexpr (DIR == Direction::Output) {
-        if (!EditIntegerOutput<KIND>(io, *edit, x)) {
-          return false;
+  for (std::size_t j{0}; j < numElements;) {
+    if (auto edit{io.GetNextDataEdit(
+            MaxDataEditRepeat<DIR>(numElements - j))}) {
+      std::optional<StagedOutput> staged;
+      if (IsStagedOutput<DIR>(*edit)) {
+        staged.emplace(io);
+      }
+      for (int k{0}; k < std::max(edit->repeat, 1); ++k, ++j) {
+        IntType &x{ExtractElement<IntType>(io, descriptor, subscripts)};
+        if constexpr (DIR == Direction::Output) {
+          if (!EditIntegerOutput<KIND>(io, *edit, x)) {
+            return false;
+          }
+        } else if (edit->descriptor != DataEdit::ListDirectedNullValue) {
+          if (!EditIntegerInput(
+                  io, *edit, reinterpret_cast<void *>(&x), KIND)) {
+            return false;
+          }
         }
-      } else if (edit->descriptor != DataEdit::ListDirectedNullValue) {
-        if (!EditIntegerInput(io, *edit, reinterpret_cast<void *>(&x), KIND)) {
-          return false;
+        if (!descriptor.IncrementSubscripts(subscripts) &&
+            j + 1 < numElements) {
+          io.GetIoErrorHandler().Crash(
+              "FormattedIntegerIO: subscripts out of bounds");
         }
       }
-      if (!descriptor.IncrementSubscripts(subscripts) && j + 1 < numElements) {
-        io.GetIoErrorHandler().Crash(
-            "FormattedIntegerIO: subscripts out of bounds");
+      if (staged && !staged->Finish()) {
+        return false;
       }
     } else {
       return false;
@@ -79,21 +113,32 @@ inline bool FormattedRealIO(
   SubscriptValue subscripts[maxRank];
   descriptor.GetLowerBounds(subscripts);
   using RawType = typename RealOutputEditing<KIND>::BinaryFloatingPoint;
-  for (std::size_t j{0}; j < numElements; ++j) {
-    if (auto edit{io.GetNextDataEdit()}) {
-      RawType &x{ExtractElement<RawType>(io, descriptor, subscripts)};
-      if constexpr (DIR == Direction::Output) {
-        if (!RealOutputEditing<KIND>{io, x}.Edit(*edit)) {
-          return false;
+  for (std::size_t j{0}; j < numElements;) {
+    if (auto edit{io.GetNextDataEdit(
+            MaxDataEditRepeat<DIR>(numElements - j))}) {
+      std::optional<StagedOutput> staged;
+      if (IsStagedOutput<DIR>(*edit)) {
+        staged.emplace(io);
+      }
+      for (int k{0}; k < std::max(edit->repeat, 1); ++k, ++j) {
+        RawType &x{ExtractElement<RawType>(io, descriptor, subscripts)};
+        if constexpr (DIR == Direction::Output) {
+          if (!RealOutputEditing<KIND>{io, x}.Edit(*edit)) {
+            return false;
+          }
+        } else if (edit->descriptor != DataEdit::ListDirectedNullValue) {
+          if (!EditRealInput<KIND>(io, *edit, reinterpret_cast<void *>(&x))) {
+            return false;
+          }
         }
-      } else if (edit->descriptor != DataEdit::ListDirectedNullValue) {
-        if (!EditRealInput<KIND>(io, *edit, reinterpret_cast<void *>(&x))) {
-          return false;
+        if (!descriptor.IncrementSubscripts(subscripts) &&
+            j + 1 < numElements) {
+          io.GetIoErrorHandler().Crash(
+              "FormattedRealIO: subscripts out of bounds");
         }
       }
-      if (!descriptor.IncrementSubscripts(subscripts) && j + 1 < numElements) {
-        io.GetIoErrorHandler().Crash(
-            "FormattedRealIO: subscripts out of bounds");
+      if (staged && !staged->Finish()) {
+        return false;
       }
     } else {
       return false;
@@ -47,6 +47,141 @@ static bool EditBOZInput(IoStatementState &io, const DataEdit &edit, void *n,
   return true;
 }
 
+// A list-directed numeric input value that lies in the contiguous characters
+// of the current record is scanned in a single pass, without a call per
+// character.  These scanners consume nothing and return false or 0 when the
+// value must be scanned by the general code below instead.
+
+// Does this character end a list-directed input value (see NextInField)?
+static bool IsListDirectedSeparator(char ch) {
+  switch (ch) {
+  case ' ':
+  case '\t':
+  case ',':
+  case ';':
+  case '/':
+  case '(':
+  case ')':
+  case '\'':
+  case '"':
+  case '*':
+  case '\n':
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool ScanListDirectedIntegerInput(
+    IoStatementState &io, void *n, int kind) {
+  io.GetNextNonBlank();
+  const char *p{nullptr};
+  std::size_t length{io.GetNextInputBytes(p)};
+  std::size_t j{0};
+  bool negate{false};
+  if (j < length && (p[j] == '-' || p[j] == '+')) {
+    negate = p[j++] == '-';
+  }
+  // Up to 19 digits accumulate without overflow.
+  auto start{j};
+  std::uint64_t magnitude{0};
+  for (; j < length && p[j] >= '0' && p[j] <= '9'; ++j) {
+    if (j - start >= 19) {
+      return false;
+    }
+    magnitude = 10 * magnitude + (p[j] - '0');
+  }
+  if (j == start || (j < length && !IsListDirectedSeparator(p[j]))) {
+    return false;
+  }
+  io.HandleRelativePosition(j);
+  common::UnsignedInt128 value{magnitude};
+  if (negate) {
+    value = -value;
+  }
+  std::memcpy(n, &value, kind);
+  return true;
+}
+
+// Scans a list-directed REAL input value into the same normalized form
+// as ScanRealInput below.
+static int ScanListDirectedRealInput(char *buffer, int bufferSize,
+    IoStatementState &io, const DataEdit &edit, int &exponent) {
+  if (edit.modes.editingFlags & decimalComma) {
+    return 0;
+  }
+  io.GetNextNonBlank();
+  const char *p{nullptr};
+  std::size_t length{io.GetNextInputBytes(p)};
+  std::size_t j{0};
+  int got{0};
+  auto Put{[&](char ch) -> void {
+    if (got < bufferSize) {
+      buffer[got] = ch;
+    }
+    ++got;
+  }};
+  if (j < length && (p[j] == '-' || p[j] == '+')) {
+    if (p[j++] == '-') {
+      Put('-');
+    }
+  }
+  Put('.'); // input field is normalized to a fraction
+  auto start{got};
+  std::optional<int> decimalPoint;
+  bool anyDigit{false};
+  for (; j < length; ++j) {
+    char ch{p[j]};
+    if (ch >= '0' && ch <= '9') {
+      anyDigit = true;
+      if (ch != '0' || got != start || decimalPoint) {
+        Put(ch); // leading zeroes before the decimal point are omitted
+      }
+    } else if (ch == '.' && !decimalPoint) {
+      decimalPoint = got - start; // # of digits before the decimal point
+    } else {
+      break;
+    }
+  }
+  if (!anyDigit) {
+    return 0;
+  }
+  if (got == start) {
+    Put('0'); // emit at least one digit
+  }
+  exponent = -edit.modes.scale;
+  if (j < length &&
+      (p[j] == 'e' || p[j] == 'E' || p[j] == 'd' || p[j] == 'D' ||
+          p[j] == 'q' || p[j] == 'Q')) {
+    ++j;
+    bool negExpo{false};
+    if (j < length && (p[j] == '-' || p[j] == '+')) {
+      negExpo = p[j++] == '-';
+    }
+    auto expoStart{j};
+    int expo{0};
+    for (; j < length && p[j] >= '0' && p[j] <= '9'; ++j) {
+      if (expo < 100000) {
+        expo = 10 * expo + (p[j] - '0');
+      }
+    }
+    if (j == expoStart) {
+      return 0;
+    }
+    exponent = negExpo ? -expo : expo;
+  }
+  if (j < length && !IsListDirectedSeparator(p[j])) {
+    return 0;
+  }
+  if (decimalPoint) {
+    exponent += *decimalPoint;
+  } else {
+    exponent += got - start - edit.digits.value_or(0);
+  }
+  io.HandleRelativePosition(j);
+  return got;
+}
+
 // Prepares input from a field, and consumes the sign, if any.
 // Returns true if there's a '-' sign.
 static bool ScanNumericPrefix(IoStatementState &io, const DataEdit &edit,
@@ -84,6 +219,10 @@ bool EditIntegerInput(
         edit.descriptor);
     return false;
   }
+  if (edit.descriptor == DataEdit::ListDirected &&
+      ScanListDirectedIntegerInput(io, n, kind)) {
+    return true;
+  }
   std::optional<int> remaining;
   std::optional<char32_t> next;
   bool negate{ScanNumericPrefix(io, edit, next, remaining)};
@@ -124,6 +263,12 @@ bool EditIntegerInput(
 // blanks with zeroes if appropriate.
 static int ScanRealInput(char *buffer, int bufferSize, IoStatementState &io,
     const DataEdit &edit, int &exponent) {
+  if (edit.descriptor == DataEdit::ListDirected) {
+    if (int got{ScanListDirectedRealInput(
+            buffer, bufferSize, io, edit, exponent)}) {
+      return got;
+    }
+  }
   std::optional<int> remaining;
   std::optional<char32_t> next;
   int got{0};
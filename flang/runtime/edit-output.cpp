@@ -12,6 +12,14 @@
 
 namespace Fortran::runtime::io {
 
+// Decimal digits are converted two at a time.
+static const char decimalDigitPairs[]{
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899"};
+
 template <int KIND>
 bool EditIntegerOutput(IoStatementState &io, const DataEdit &edit,
     common::HostSignedIntType<8 * KIND> n) {
@@ -30,11 +38,20 @@ bool EditIntegerOutput(IoStatementState &io, const DataEdit &edit,
     if (isNegative || (edit.modes.editingFlags & signPlus)) {
       signChars = 1; // '-' or '+'
     }
-    while (un > 0) {
-      auto quotient{un / 10u};
-      *--p = '0' + static_cast<int>(un - Unsigned{10} * quotient);
+    while (un >= Unsigned{100}) {
+      auto quotient{un / 100u};
+      int pair{2 * static_cast<int>(un - Unsigned{100} * quotient)};
+      *--p = decimalDigitPairs[pair + 1];
+      *--p = decimalDigitPairs[pair];
       un = quotient;
     }
+    if (un >= Unsigned{10}) {
+      int pair{2 * static_cast<int>(un)};
+      *--p = decimalDigitPairs[pair + 1];
+      *--p = decimalDigitPairs[pair];
+    } else if (un > 0) {
+      *--p = '0' + static_cast<int>(un);
+    }
     break;
   case 'B':
     for (; un > 0; un >>= 1) {
@@ -463,7 +463,7 @@ DataEdit FormatControl<CONTEXT>::GetNextDataEdit(
     stack_[height_].remaining = repeat; // full count
     ++height_;
   }
-  edit.repeat = std::min(1, maxRepeat); // 0 if maxRepeat==0
+  edit.repeat = std::min(repeat, maxRepeat); // 0 if maxRepeat==0
   if (height_ > 1) { // Subtle: stack_[0].start doesn't necessarily point to '('
     int start{stack_[height_ - 1].start};
     if (format_[start] != '(') {
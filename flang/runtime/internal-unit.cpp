@@ -109,6 +109,24 @@ std::optional<char32_t> InternalDescriptorUnit<DIR>::GetCurrentChar(
   return record[positionInRecord];
 }
 
+template <Direction DIR>
+std::size_t InternalDescriptorUnit<DIR>::GetNextInputBytes(
+    const char *&p, IoErrorHandler &handler) {
+  p = nullptr;
+  if constexpr (DIR == Direction::Output) {
+    handler.Crash("InternalDescriptorUnit<Direction::Output>::"
+                  "GetNextInputBytes() called");
+    return 0;
+  }
+  const char *record{CurrentRecord()};
+  if (!record || isUTF8 || !recordLength ||
+      positionInRecord >= *recordLength) {
+    return 0;
+  }
+  p = record + positionInRecord;
+  return static_cast<std::size_t>(*recordLength - positionInRecord);
+}
+
 template <Direction DIR>
 bool InternalDescriptorUnit<DIR>::AdvanceRecord(IoErrorHandler &handler) {
   if (currentRecordNumber >= endfileRecordNumber.value_or(0)) {
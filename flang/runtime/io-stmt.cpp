@@ -41,6 +41,11 @@ std::optional<char32_t> IoStatementBase::GetCurrentChar() {
   return std::nullopt;
 }
 
+std::size_t IoStatementBase::GetNextInputBytes(const char *&p) {
+  p = nullptr;
+  return 0;
+}
+
 bool IoStatementBase::AdvanceRecord(int) { return false; }
 
 void IoStatementBase::BackspaceRecord() {}
@@ -119,6 +124,17 @@ std::optional<char32_t> InternalIoStatementState<DIR, CHAR>::GetCurrentChar() {
   return unit_.GetCurrentChar(*this);
 }
 
+template <Direction DIR, typename CHAR>
+std::size_t InternalIoStatementState<DIR, CHAR>::GetNextInputBytes(
+    const char *&p) {
+  if constexpr (DIR == Direction::Input && std::is_same_v<CHAR, char>) {
+    return unit_.GetNextInputBytes(p, *this);
+  } else {
+    p = nullptr;
+    return 0;
+  }
+}
+
 template <Direction DIR, typename CHAR>
 bool InternalIoStatementState<DIR, CHAR>::AdvanceRecord(int n) {
   while (n-- > 0) {
@@ -334,6 +350,16 @@ std::optional<char32_t> ExternalIoStatementState<DIR>::GetCurrentChar() {
   return unit().GetCurrentChar(*this);
 }
 
+template <Direction DIR>
+std::size_t ExternalIoStatementState<DIR>::GetNextInputBytes(const char *&p) {
+  if constexpr (DIR == Direction::Input) {
+    return unit().GetNextInputBytes(p, *this);
+  } else {
+    p = nullptr;
+    return 0;
+  }
+}
+
 template <Direction DIR>
 bool ExternalIoStatementState<DIR>::AdvanceRecord(int n) {
   while (n-- > 0) {
@@ -399,34 +425,110 @@ std::optional<DataEdit> IoStatementState::GetNextDataEdit(int n) {
 
 bool IoStatementState::Emit(
     const char *data, std::size_t n, std::size_t elementBytes) {
+  if (!FlushStagedOutput()) {
+    return false;
+  } else if (externalOutput_) {
+    return externalOutput_->Emit(data, n, elementBytes);
+  }
   return std::visit(
       [=](auto &x) { return x.get().Emit(data, n, elementBytes); }, u_);
 }
 
 bool IoStatementState::Emit(const char *data, std::size_t n) {
+  if (stagingBuffer_) {
+    return StageOutput(data, n);
+  }
+  return EmitUnstaged(data, n);
+}
+
+bool IoStatementState::EmitUnstaged(const char *data, std::size_t n) {
+  if (externalOutput_) {
+    return externalOutput_->Emit(data, n);
+  } else if (internalOutput_) {
+    return internalOutput_->Emit(data, n);
+  }
   return std::visit([=](auto &x) { return x.get().Emit(data, n); }, u_);
 }
 
 bool IoStatementState::Emit(const char16_t *data, std::size_t chars) {
-  return std::visit([=](auto &x) { return x.get().Emit(data, chars); }, u_);
+  return FlushStagedOutput() &&
+      std::visit([=](auto &x) { return x.get().Emit(data, chars); }, u_);
 }
 
 bool IoStatementState::Emit(const char32_t *data, std::size_t chars) {
-  return std::visit([=](auto &x) { return x.get().Emit(data, chars); }, u_);
+  return FlushStagedOutput() &&
+      std::visit([=](auto &x) { return x.get().Emit(data, chars); }, u_);
+}
+
+void IoStatementState::BeginStagingOutput(
+    char *buffer, std::size_t capacity) {
+  FlushStagedOutput();
+  stagingBuffer_ = buffer;
+  stagingCapacity_ = capacity;
+  staged_ = 0;
+}
+
+bool IoStatementState::FinishStagingOutput(bool flush) {
+  bool ok{!flush || FlushStagedOutput()};
+  staged_ = 0;
+  stagingBuffer_ = nullptr;
+  return ok;
+}
+
+bool IoStatementState::FlushStagedOutput() {
+  if (staged_ == 0) {
+    return true;
+  }
+  const char *data{stagingBuffer_};
+  std::size_t n{staged_};
+  staged_ = 0;
+  return EmitUnstaged(data, n);
+}
+
+bool IoStatementState::StageOutput(const char *data, std::size_t n) {
+  if (staged_ + n > stagingCapacity_) {
+    if (!FlushStagedOutput()) {
+      return false;
+    }
+    if (n > stagingCapacity_) {
+      return EmitUnstaged(data, n);
+    }
+  }
+  std::memcpy(stagingBuffer_ + staged_, data, n);
+  staged_ += n;
+  return true;
 }
 
 bool IoStatementState::Receive(
     char *data, std::size_t n, std::size_t elementBytes) {
+  if (unformattedInput_) {
+    return unformattedInput_->Receive(data, n, elementBytes);
+  }
   return std::visit(
       [=](auto &x) { return x.get().Receive(data, n, elementBytes); }, u_);
 }
 
 std::optional<char32_t> IoStatementState::GetCurrentChar() {
+  if (externalInput_) {
+    return externalInput_->GetCurrentChar();
+  } else if (internalInput_) {
+    return internalInput_->GetCurrentChar();
+  }
   return std::visit([&](auto &x) { return x.get().GetCurrentChar(); }, u_);
 }
 
+std::size_t IoStatementState::GetNextInputBytes(const char *&p) {
+  if (externalInput_) {
+    return externalInput_->GetNextInputBytes(p);
+  } else if (internalInput_) {
+    return internalInput_->GetNextInputBytes(p);
+  }
+  return std::visit([&](auto &x) { return x.get().GetNextInputBytes(p); }, u_);
+}
+
 bool IoStatementState::AdvanceRecord(int n) {
-  return std::visit([=](auto &x) { return x.get().AdvanceRecord(n); }, u_);
+  return FlushStagedOutput() &&
+      std::visit([=](auto &x) { return x.get().AdvanceRecord(n); }, u_);
 }
 
 void IoStatementState::BackspaceRecord() {
@@ -434,10 +536,18 @@ void IoStatementState::BackspaceRecord() {
 }
 
 void IoStatementState::HandleRelativePosition(std::int64_t n) {
-  std::visit([=](auto &x) { x.get().HandleRelativePosition(n); }, u_);
+  if (externalInput_) {
+    externalInput_->HandleRelativePosition(n);
+  } else if (internalInput_) {
+    internalInput_->HandleRelativePosition(n);
+  } else {
+    FlushStagedOutput();
+    std::visit([=](auto &x) { x.get().HandleRelativePosition(n); }, u_);
+  }
 }
 
 void IoStatementState::HandleAbsolutePosition(std::int64_t n) {
+  FlushStagedOutput();
   std::visit([=](auto &x) { x.get().HandleAbsolutePosition(n); }, u_);
 }
 
@@ -446,12 +556,30 @@ int IoStatementState::EndIoStatement() {
 }
 
 ConnectionState &IoStatementState::GetConnectionState() {
+  if (externalOutput_) {
+    return externalOutput_->GetConnectionState();
+  } else if (externalInput_) {
+    return externalInput_->GetConnectionState();
+  } else if (internalOutput_) {
+    return internalOutput_->GetConnectionState();
+  } else if (internalInput_) {
+    return internalInput_->GetConnectionState();
+  }
   return std::visit(
       [](auto &x) -> ConnectionState & { return x.get().GetConnectionState(); },
       u_);
 }
 
 MutableModes &IoStatementState::mutableModes() {
+  if (externalOutput_) {
+    return externalOutput_->mutableModes();
+  } else if (externalInput_) {
+    return externalInput_->mutableModes();
+  } else if (internalOutput_) {
+    return internalOutput_->mutableModes();
+  } else if (internalInput_) {
+    return internalInput_->mutableModes();
+  }
   return std::visit(
       [](auto &x) -> MutableModes & { return x.get().mutableModes(); }, u_);
 }
@@ -461,11 +589,7 @@ bool IoStatementState::BeginReadingRecord() {
 }
 
 IoErrorHandler &IoStatementState::GetIoErrorHandler() const {
-  return std::visit(
-      [](auto &x) -> IoErrorHandler & {
-        return static_cast<IoErrorHandler &>(x.get());
-      },
-      u_);
+  return *handler_;
 }
 
 ExternalFileUnit *IoStatementState::GetExternalFileUnit() const {
@@ -473,16 +597,14 @@ ExternalFileUnit *IoStatementState::GetExternalFileUnit() const {
 }
 
 bool IoStatementState::EmitRepeated(char ch, std::size_t n) {
-  return std::visit(
-      [=](auto &x) {
-        for (std::size_t j{0}; j < n; ++j) {
-          if (!x.get().Emit(&ch, 1)) {
-            return false;
-          }
-        }
-        return true;
-      },
-      u_);
+  char chunk[32];
+  std::memset(chunk, ch, std::min(n, sizeof chunk));
+  for (std::size_t j{0}; j < n; j += sizeof chunk) {
+    if (!Emit(chunk, std::min(n - j, sizeof chunk))) {
+      return false;
+    }
+  }
+  return true;
 }
 
 bool IoStatementState::EmitField(
@@ -579,8 +701,22 @@ std::optional<char32_t> IoStatementState::NextInField(
 }
 
 std::optional<char32_t> IoStatementState::GetNextNonBlank() {
-  auto ch{GetCurrentChar()};
   bool inNamelist{GetConnectionState().modes.inNamelist};
+  // Skip blanks in the rest of the current record at once, if possible.
+  const char *p{nullptr};
+  if (std::size_t length{GetNextInputBytes(p)}; length > 0) {
+    std::size_t j{0};
+    while (j < length && (p[j] == ' ' || p[j] == '\t')) {
+      ++j;
+    }
+    if (j > 0) {
+      HandleRelativePosition(j);
+    }
+    if (j < length && !(inNamelist && p[j] == '!')) {
+      return p[j];
+    }
+  }
+  auto ch{GetCurrentChar()};
   while (!ch || *ch == ' ' || *ch == '\t' || (inNamelist && *ch == '!')) {
     if (ch && (*ch == ' ' || *ch == '\t')) {
       HandleRelativePosition(1);
@@ -659,6 +795,21 @@ ListDirectedStatementState<Direction::Output>::GetNextDataEdit(
   return edit;
 }
 
+// Can the digits at the current position be a "r*" repetition count?  When
+// the rest of the record is at hand, this is decided without consuming them.
+static bool MayBeRepeatCount(IoStatementState &io) {
+  const char *p{nullptr};
+  std::size_t length{io.GetNextInputBytes(p)};
+  if (length == 0) {
+    return true;
+  }
+  std::size_t j{0};
+  while (j < length && p[j] >= '0' && p[j] <= '9') {
+    ++j;
+  }
+  return j < length && p[j] == '*';
+}
+
 std::optional<DataEdit>
 ListDirectedStatementState<Direction::Input>::GetNextDataEdit(
     IoStatementState &io, int maxRepeat) {
@@ -731,7 +882,8 @@ ListDirectedStatementState<Direction::Input>::GetNextDataEdit(
   if (imaginaryPart_) { // can't repeat components
     return edit;
   }
-  if (*ch >= '0' && *ch <= '9') { // look for "r*" repetition count
+  if (*ch >= '0' && *ch <= '9' &&
+      MayBeRepeatCount(io)) { // look for "r*" repetition count
     auto start{connection.positionInRecord};
     int r{0};
     do {
@@ -36,11 +36,13 @@ class ExternalMiscIoStatementState;
 class CloseStatementState;
 class NoopCloseStatementState;
 
+template <Direction, typename CHAR = char> class InternalIoStatementState;
 template <Direction, typename CHAR = char>
 class InternalFormattedIoStatementState;
 template <Direction, typename CHAR = char> class InternalListIoStatementState;
 template <Direction, typename CHAR = char>
 class ExternalFormattedIoStatementState;
+template <Direction> class ExternalIoStatementState;
 template <Direction> class ExternalListIoStatementState;
 template <Direction> class ExternalUnformattedIoStatementState;
 template <Direction, typename CHAR = char> class ChildFormattedIoStatementState;
@@ -69,13 +71,35 @@ private:
 // The Cookie type in the I/O API is a pointer (for C) to this class.
 class IoStatementState {
 public:
-  template <typename A> explicit IoStatementState(A &x) : u_{x} {}
+  template <typename A>
+  explicit IoStatementState(A &x) : u_{x}, handler_{&x} {
+    if constexpr (std::is_convertible_v<A *,
+                      ExternalIoStatementState<Direction::Output> *>) {
+      externalOutput_ = &x;
+    } else if constexpr (std::is_convertible_v<A *,
+                             ExternalIoStatementState<Direction::Input> *>) {
+      externalInput_ = &x;
+    } else if constexpr (std::is_convertible_v<A *,
+                             InternalIoStatementState<Direction::Output> *>) {
+      internalOutput_ = &x;
+    } else if constexpr (std::is_convertible_v<A *,
+                             InternalIoStatementState<Direction::Input> *>) {
+      internalInput_ = &x;
+    }
+    if constexpr (std::is_same_v<A,
+                      ExternalUnformattedIoStatementState<Direction::Input>>) {
+      unformattedInput_ = &x;
+    }
+  }
 
   // These member functions each project themselves into the active alternative.
   // They're used by per-data-item routines in the I/O API (e.g., OutputReal64)
   // to interact with the state of the I/O statement in progress.
   // This design avoids virtual member functions and function pointers,
   // which may not have good support in some runtime environments.
+  // The per-character operations of data transfers on external and internal
+  // units, which are by far the most frequent, call the common base of the
+  // alternative directly instead; see the pointers below.
   int EndIoStatement();
   bool Emit(const char *, std::size_t, std::size_t elementBytes);
   bool Emit(const char *, std::size_t);
@@ -83,6 +107,10 @@ public:
   bool Emit(const char32_t *, std::size_t chars);
   bool Receive(char *, std::size_t, std::size_t elementBytes = 0);
   std::optional<char32_t> GetCurrentChar(); // vacant after end of record
+  // The characters that remain in the current input record, when they are
+  // single bytes in contiguous memory; returns their count, or 0 if the
+  // caller must use GetCurrentChar() instead.
+  std::size_t GetNextInputBytes(const char *&);
   bool AdvanceRecord(int = 1);
   void BackspaceRecord();
   void HandleRelativePosition(std::int64_t);
@@ -116,6 +144,14 @@ public:
   bool EmitRepeated(char, std::size_t);
   bool EmitField(const char *, std::size_t length, std::size_t width);
 
+  // While output is staged, the characters emitted through Emit(const char *,
+  // std::size_t) and EmitRepeated() are accumulated in a caller's buffer and
+  // passed on when it fills up or when staging finishes with a flush.  It is
+  // meant for runs of data items edited alike with no record positioning
+  // between them; see StagedOutput below.
+  void BeginStagingOutput(char *buffer, std::size_t capacity);
+  bool FinishStagingOutput(bool flush = true);
+
   // For fixed-width fields, initialize the number of remaining characters.
   // Skip over leading blanks, then return the first non-blank character (if
   // any).
@@ -169,6 +205,43 @@ private:
       std::reference_wrapper<InquireIOLengthState>,
       std::reference_wrapper<ExternalMiscIoStatementState>>
       u_;
+  bool FlushStagedOutput();
+  bool StageOutput(const char *, std::size_t);
+  bool EmitUnstaged(const char *, std::size_t);
+
+  // Resolved from the type of the statement when it begins.  At most one of
+  // the unit pointers is set; they're null for the other kinds of statements
+  // and for child I/O, whose operations are projected through u_.
+  // GetNextDataEdit() is not bound here: each formatted statement type
+  // has its own FormatControl, so there is no common base to point at.
+  IoErrorHandler *handler_;
+  ExternalIoStatementState<Direction::Output> *externalOutput_{nullptr};
+  ExternalIoStatementState<Direction::Input> *externalInput_{nullptr};
+  InternalIoStatementState<Direction::Output> *internalOutput_{nullptr};
+  InternalIoStatementState<Direction::Input> *internalInput_{nullptr};
+  // Also set, with externalInput_, for an unformatted READ, for Receive().
+  ExternalUnformattedIoStatementState<Direction::Input> *unformattedInput_{
+      nullptr};
+
+  char *stagingBuffer_{nullptr};
+  std::size_t stagingCapacity_{0}, staged_{0};
+};
+
+// Stages the output of a run of data items for the duration of its scope.
+class StagedOutput {
+public:
+  explicit StagedOutput(IoStatementState &io) : io_{io} {
+    io_.BeginStagingOutput(buffer_, sizeof buffer_);
+  }
+  // A run that ends early because of an error drops the output it staged.
+  ~StagedOutput() {
+    io_.FinishStagingOutput(!io_.GetIoErrorHandler().InError());
+  }
+  bool Finish() { return io_.FinishStagingOutput(); }
+
+private:
+  IoStatementState &io_;
+  char buffer_[1024];
 };
 
 // Base class for all per-I/O statement state classes.
@@ -183,6 +256,7 @@ struct IoStatementBase : public IoErrorHandler {
   bool Emit(const char32_t *, std::size_t chars);
   bool Receive(char *, std::size_t, std::size_t elementBytes = 0);
   std::optional<char32_t> GetCurrentChar();
+  std::size_t GetNextInputBytes(const char *&);
   bool AdvanceRecord(int);
   void BackspaceRecord();
   void HandleRelativePosition(std::int64_t);
@@ -248,7 +322,7 @@ private:
   bool imaginaryPart_{false};
 };
 
-template <Direction DIR, typename CHAR = char>
+template <Direction DIR, typename CHAR>
 class InternalIoStatementState : public IoStatementBase,
                                  public IoDirectionState<DIR> {
 public:
@@ -266,6 +340,7 @@ public:
       const CharType *data, std::size_t chars /* not necessarily bytes */);
 
   std::optional<char32_t> GetCurrentChar();
+  std::size_t GetNextInputBytes(const char *&);
   bool AdvanceRecord(int = 1);
   void BackspaceRecord();
   ConnectionState &GetConnectionState() { return unit_; }
@@ -350,6 +425,7 @@ public:
   bool Emit(const char16_t *, std::size_t chars /* not bytes */);
   bool Emit(const char32_t *, std::size_t chars /* not bytes */);
   std::optional<char32_t> GetCurrentChar();
+  std::size_t GetNextInputBytes(const char *&);
   bool AdvanceRecord(int = 1);
   void BackspaceRecord();
   void HandleRelativePosition(std::int64_t);
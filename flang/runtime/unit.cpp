@@ -327,6 +327,19 @@ std::optional<char32_t> ExternalFileUnit::GetCurrentChar(
   return std::nullopt;
 }
 
+// The rest of the current record is in the frame once its length is known.
+std::size_t ExternalFileUnit::GetNextInputBytes(
+    const char *&p, IoErrorHandler &handler) {
+  RUNTIME_CHECK(handler, direction_ == Direction::Input);
+  p = nullptr;
+  if (!recordLength || positionInRecord >= *recordLength) {
+    return 0;
+  }
+  auto length{static_cast<std::size_t>(*recordLength - positionInRecord)};
+  p = FrameNextInput(handler, length);
+  return p ? length : 0;
+}
+
 const char *ExternalFileUnit::FrameNextInput(
     IoErrorHandler &handler, std::size_t bytes) {
   RUNTIME_CHECK(handler, isUnformatted.has_value() && !*isUnformatted);
@@ -0,0 +1,15 @@
+! RUN: %python %S/test_errors.py %s %flang_fc1
+! Overlapping initializations of elements that were initialized by a
+! repeated DATA statement value
+subroutine s1
+  integer :: a(4)
+  !ERROR: DATA statement initializations affect 'a(2_8)' more than once
+  !ERROR: DATA statement initializations affect 'a(4_8)' more than once
+  data a /4*1/, a(2) /2/, a(4) /3/
+end subroutine
+
+subroutine s2
+  real :: b(3, 2)
+  !ERROR: DATA statement initializations affect 'b(3_8,1_8)' more than once
+  data b(:, 2) /3*0./, b(1:2, 1) /2*1./, b(3, 1) /2./, b(3, 1) /3./
+end subroutine
@@ -0,0 +1,16 @@
+! RUN: %flang_fc1 -fdebug-dump-symbols %s 2>&1 | FileCheck %s
+! A repeated DATA statement value that is a structure constructor with a
+! pointer component initializes the pointer in every element
+module m
+  type :: t
+    integer :: n
+    integer, pointer :: p
+  end type
+  integer, target, save :: tgt
+  type(t) :: x(3)
+  data x /3*t(1, tgt)/
+  type(t) :: y(4)
+  data y(1:2) /2*t(2, tgt)/, y(3:4) /2*t(3, null())/
+end module
+!CHECK: x (InDataStmt) size={{[0-9]+}} offset={{[0-9]+}}: ObjectEntityDetails: TYPE(t) shape: 1_8:3_8 init:[t::t(n=1_4,p=tgt),t(n=1_4,p=tgt),t(n=1_4,p=tgt)]
+!CHECK: y (InDataStmt) size={{[0-9]+}} offset={{[0-9]+}}: ObjectEntityDetails: TYPE(t) shape: 1_8:4_8 init:[t::t(n=2_4,p=tgt),t(n=2_4,p=tgt),t(n=3_4,p=NULL()),t(n=3_4,p=NULL())]
@@ -13,6 +13,7 @@
 
 #include "flang/Optimizer/Support/InitFIR.h"
 #include "flang/Optimizer/Support/KindMapping.h"
+#include "flang/Optimizer/Transforms/Passes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Parser.h"
@@ -42,6 +43,23 @@ static cl::opt<bool> emitFir("emit-fir",
                              cl::desc("Parse and pretty-print the input"),
                              cl::init(false));
 
+static cl::opt<bool>
+    enableAffineLoopOpt("enable-affine-loop-opt",
+                        cl::desc("Optimize loop nests over arrays in the "
+                                 "affine dialect"),
+                        cl::init(false));
+
+static cl::opt<bool> enableBoxSpecialization(
+    "enable-box-specialization",
+    cl::desc("Specialize procedures for contiguous assumed-shape arrays"),
+    cl::init(false));
+
+static cl::opt<bool>
+    enableStackArrays("enable-stack-arrays",
+                      cl::desc("Move small local heap allocations to the "
+                               "stack"),
+                      cl::init(false));
+
 static void printModuleBody(mlir::ModuleOp mod, raw_ostream &output) {
   for (auto &op : mod.getBody()->without_terminator())
     output << op << '\n';
@@ -89,6 +107,12 @@ compileFIR(const mlir::PassPipelineCLParser &passPipeline) {
     // TODO: Actually add passes when added to FIR code base
     // add all the passes
     // the user can disable them individually
+    if (enableBoxSpecialization)
+      pm.addPass(fir::createBoxSpecializationPass());
+    if (enableStackArrays)
+      pm.addNestedPass<mlir::FuncOp>(fir::createStackArraysPass());
+    if (enableAffineLoopOpt)
+      fir::addAffineLoopOptPipeline(pm);
   }
 
   // run the pass manager
@@ -31,5 +31,26 @@ int main() {
   a = b;
   MATCH("2_4", a.AsFortran());
   MATCH("2_4", b.AsFortran());
+
+  // Copies of array constants share their values until one is modified
+  using Int4 = Type<TypeCategory::Integer, 4>;
+  std::vector<Scalar<Int4>> elements;
+  for (int j{1}; j <= 4; ++j) {
+    elements.emplace_back(j);
+  }
+  Constant<Int4> c1{std::move(elements), ConstantSubscripts{4}};
+  Constant<Int4> c2{c1};
+  Constant<Int4> c3{c1.Reshape(ConstantSubscripts{2, 2})};
+  TEST(&c1.values() == &c2.values());
+  TEST(&c1.values() == &c3.values());
+  MATCH(2, c3.Rank());
+  Constant<Int4> nine{std::vector<Scalar<Int4>>{Scalar<Int4>{9}},
+      ConstantSubscripts{1}};
+  ConstantSubscripts at{2};
+  MATCH(1, c2.CopyFrom(nine, 1, at, nullptr));
+  TEST(&c1.values() != &c2.values());
+  MATCH(9, c2.At(ConstantSubscripts{2}).ToInt64());
+  MATCH(2, c1.At(ConstantSubscripts{2}).ToInt64());
+  MATCH(2, c3.At(ConstantSubscripts{2, 1}).ToInt64());
   return testing::Complete();
 }
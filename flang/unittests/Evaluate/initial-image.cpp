@@ -0,0 +1,40 @@
+#include "testing.h"
+#include "flang/Evaluate/initial-image.h"
+#include "flang/Evaluate/intrinsics.h"
+#include "flang/Evaluate/tools.h"
+#include "flang/Parser/message.h"
+
+using namespace Fortran::evaluate;
+
+using Int4 = Type<TypeCategory::Integer, 4>;
+
+int main() {
+  Fortran::parser::CharBlock src;
+  Fortran::parser::ContextualMessages messages{src, nullptr};
+  Fortran::common::IntrinsicTypeDefaultKinds defaults;
+  auto intrinsics{IntrinsicProcTable::Configure(defaults)};
+  FoldingContext context{messages, defaults, intrinsics};
+
+  // Four 8-byte elements of a derived type with an INTEGER(4) component
+  // at offset 0 and a pointer component at offset 4; the first element
+  // is initialized and then replicated, as a repeated DATA value is.
+  InitialImage image{32};
+  Expr<SomeType> value{AsGenericExpr(Constant<Int4>{7})};
+  Expr<SomeType> target{AsGenericExpr(Constant<Int4>{42})};
+  MATCH(InitialImage::Ok, image.Add(0, 4, value, context));
+  image.AddPointer(4, target);
+  MATCH(InitialImage::Ok, image.Replicate(0, 8, 3));
+  DynamicType int4{TypeCategory::Integer, 4};
+  for (ConstantSubscript j{0}; j < 4; ++j) {
+    auto replicated{image.AsConstant(context, int4, {}, 8 * j)};
+    TEST(replicated && *replicated == value)("element %d", static_cast<int>(j));
+    auto pointer{image.AsConstantPointer(8 * j + 4)};
+    TEST(pointer && *pointer == target)("pointer %d", static_cast<int>(j));
+    TEST(!image.AsConstantPointer(8 * j));
+  }
+
+  MATCH(InitialImage::OutOfRange, image.Replicate(8, 8, 3));
+  MATCH(InitialImage::OutOfRange, image.Replicate(-8, 8, 1));
+
+  return testing::Complete();
+}
@@ -1,5 +1,6 @@
 #include "fp-testing.h"
 #include "testing.h"
+#include "../../lib/Evaluate/host.h"
 #include "flang/Evaluate/type.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cmath>
@@ -343,6 +344,44 @@ FLT TimesIntPowerOfTen(FLT x, int power) {
   return x * ToIntPower<FLT>(10.0, power);
 }
 
+// Folding computes with host arithmetic instead of the emulation when it
+// can; whenever it does, the result and flags must be the emulated ones.
+template <typename REAL>
+void hostArithmeticTest(int pass, Rounding rounding, const REAL &x,
+    const REAL &y, std::uint64_t rj, std::uint64_t rk) {
+  using T = Type<TypeCategory::Real, REAL::bits / 8>;
+  static constexpr char opChar[]{"+-*/"};
+  for (std::size_t j{0}; j < host::RealOperation_enumSize; ++j) {
+    auto op{static_cast<host::RealOperation>(j)};
+    auto fast{host::FoldWithHostArithmetic<T>(op, rounding, x, y)};
+    if (!fast) {
+      continue;
+    }
+    ValueWithRealFlags<REAL> emulated;
+    switch (op) {
+    case host::RealOperation::Add:
+      emulated = x.Add(y, rounding);
+      break;
+    case host::RealOperation::Subtract:
+      emulated = x.Subtract(y, rounding);
+      break;
+    case host::RealOperation::Multiply:
+      emulated = x.Multiply(y, rounding);
+      break;
+    case host::RealOperation::Divide:
+      emulated = x.Divide(y, rounding);
+      break;
+    }
+    MATCH(emulated.value.RawBits().ToUInt64(),
+        fast->value.RawBits().ToUInt64())
+    ("%d host 0x%jx %c 0x%jx", pass, static_cast<std::intmax_t>(rj), opChar[j],
+        static_cast<std::intmax_t>(rk));
+    MATCH(FlagsToBits(emulated.flags), FlagsToBits(fast->flags))
+    ("%d host 0x%jx %c 0x%jx", pass, static_cast<std::intmax_t>(rj), opChar[j],
+        static_cast<std::intmax_t>(rk));
+  }
+}
+
 template <typename UINT = std::uint32_t, typename FLT = float,
     typename REAL = Real4>
 void subsetTests(int pass, Rounding rounding, std::uint32_t opds) {
@@ -506,6 +545,7 @@ void subsetTests(int pass, Rounding rounding, std::uint32_t opds) {
         ("%d 0x%jx / 0x%jx", pass, static_cast<std::intmax_t>(rj),
             static_cast<std::intmax_t>(rk));
       }
+      hostArithmeticTest(pass, rounding, x, y, rj, rk);
     }
   }
 }
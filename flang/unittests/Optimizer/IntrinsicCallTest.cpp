@@ -0,0 +1,127 @@
+//===- IntrinsicCallTest.cpp -- Intrinsic call lowering unit tests --------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "flang/Lower/IntrinsicCall.h"
+#include "gtest/gtest.h"
+#include "flang/Optimizer/Support/InitFIR.h"
+#include "flang/Optimizer/Support/KindMapping.h"
+
+struct IntrinsicCallTest : public testing::Test {
+public:
+  void SetUp() override {
+    fir::support::loadDialects(context);
+    module = mlir::ModuleOp::create(mlir::UnknownLoc::get(&context));
+    auto func = mlir::FuncOp::create(mlir::UnknownLoc::get(&context), "test",
+                                     mlir::FunctionType::get(&context, {}, {}));
+    module->push_back(func);
+    func.addEntryBlock();
+    kindMap = std::make_unique<fir::KindMapping>(&context);
+    firBuilder =
+        std::make_unique<Fortran::lower::FirOpBuilder>(func, *kindMap);
+    firBuilder->setInsertionPointToStart(&func.front());
+  }
+
+  Fortran::lower::FirOpBuilder &getBuilder() { return *firBuilder; }
+
+  /// A local REAL(4) array of extents \p extents.
+  fir::ArrayBoxValue createArray(llvm::ArrayRef<mlir::Value> extents) {
+    auto &builder = getBuilder();
+    auto loc = builder.getUnknownLoc();
+    fir::SequenceType::Shape shape;
+    for (auto extent : extents) {
+      auto cst = extent.getDefiningOp<mlir::arith::ConstantOp>();
+      shape.push_back(cst ? cst.value().cast<mlir::IntegerAttr>().getInt()
+                          : fir::SequenceType::getUnknownExtent());
+    }
+    auto seqTy = fir::SequenceType::get(shape, builder.getF32Type());
+    llvm::SmallVector<mlir::Value> dynamicExtents;
+    for (auto extent : extents)
+      if (!extent.getDefiningOp<mlir::arith::ConstantOp>())
+        dynamicExtents.push_back(extent);
+    auto addr = builder.create<fir::AllocaOp>(loc, seqTy, llvm::StringRef{},
+                                              llvm::None, dynamicExtents);
+    return {addr, extents};
+  }
+
+  mlir::Value createIndex(std::int64_t value) {
+    auto &builder = getBuilder();
+    return builder.createIntegerConstant(builder.getUnknownLoc(),
+                                         builder.getIndexType(), value);
+  }
+
+  /// Number of operations of kind OP in the test function.
+  template <typename OP> unsigned countOps() {
+    unsigned count = 0;
+    module->walk([&](OP) { ++count; });
+    return count;
+  }
+
+  unsigned countAllOps() {
+    unsigned count = 0;
+    module->walk([&](mlir::Operation *) { ++count; });
+    return count;
+  }
+
+  mlir::MLIRContext context;
+  mlir::OwningModuleRef module;
+  std::unique_ptr<fir::KindMapping> kindMap;
+  std::unique_ptr<Fortran::lower::FirOpBuilder> firBuilder;
+};
+
+static const fir::ExtendedValue absent{mlir::Value{}};
+
+TEST_F(IntrinsicCallTest, SumIsExpandedInline) {
+  auto &builder = getBuilder();
+  auto array = createArray({createIndex(10), createIndex(20)});
+  auto result = Fortran::lower::genIntrinsicCall(
+      builder, builder.getUnknownLoc(), "sum", builder.getF32Type(),
+      {array, absent, absent});
+  EXPECT_TRUE(fir::getBase(result));
+  EXPECT_EQ(countOps<fir::DoLoopOp>(), 2u);
+  EXPECT_EQ(countOps<mlir::CallOp>(), 0u);
+}
+
+TEST_F(IntrinsicCallTest, SumWithDimIsLeftToTheRuntime) {
+  auto &builder = getBuilder();
+  auto array = createArray({createIndex(10), createIndex(20)});
+  auto dim = builder.createIntegerConstant(builder.getUnknownLoc(),
+                                           builder.getI32Type(), 1);
+  auto before = countAllOps();
+  auto result = Fortran::lower::genIntrinsicCall(
+      builder, builder.getUnknownLoc(), "sum", builder.getF32Type(),
+      {array, dim, absent});
+  EXPECT_FALSE(fir::getBase(result));
+  EXPECT_EQ(countAllOps(), before);
+}
+
+TEST_F(IntrinsicCallTest, SmallMatmulIsExpandedInline) {
+  auto &builder = getBuilder();
+  auto a = createArray({createIndex(4), createIndex(3)});
+  auto b = createArray({createIndex(3), createIndex(5)});
+  auto resultType = fir::SequenceType::get({4, 5}, builder.getF32Type());
+  auto result = Fortran::lower::genIntrinsicCall(
+      builder, builder.getUnknownLoc(), "matmul", resultType, {a, b});
+  ASSERT_TRUE(result.getArrayBox());
+  EXPECT_EQ(countOps<fir::AllocaOp>(), 3u);
+  EXPECT_EQ(countOps<fir::AllocMemOp>(), 0u);
+}
+
+TEST_F(IntrinsicCallTest, DynamicMatmulIsLeftToTheRuntime) {
+  auto &builder = getBuilder();
+  auto n = builder.create<fir::UndefOp>(builder.getUnknownLoc(),
+                                        builder.getIndexType());
+  auto a = createArray({n, createIndex(3)});
+  auto b = createArray({createIndex(3), createIndex(5)});
+  auto resultType = fir::SequenceType::get(
+      {fir::SequenceType::getUnknownExtent(), 5}, builder.getF32Type());
+  auto before = countAllOps();
+  auto result = Fortran::lower::genIntrinsicCall(
+      builder, builder.getUnknownLoc(), "matmul", resultType, {a, b});
+  EXPECT_FALSE(fir::getBase(result));
+  EXPECT_EQ(countAllOps(), before);
+}
@@ -537,3 +537,74 @@ TEST(ExternalIOTests, TestNonAvancingInput) {
     j++;
   }
 }
+
+TEST(ExternalIOTests, TestSequentialListDirected) {
+  // OPEN(NEWUNIT=unit,ACCESS='SEQUENTIAL',ACTION='READWRITE',&
+  //   FORM='FORMATTED',STATUS='SCRATCH')
+  auto *io{IONAME(BeginOpenNewUnit)(__FILE__, __LINE__)};
+  ASSERT_TRUE(IONAME(SetAccess)(io, "SEQUENTIAL", 10))
+      << "SetAccess(SEQUENTIAL)";
+  ASSERT_TRUE(IONAME(SetAction)(io, "READWRITE", 9)) << "SetAction(READWRITE)";
+  ASSERT_TRUE(IONAME(SetForm)(io, "FORMATTED", 9)) << "SetForm(FORMATTED)";
+  ASSERT_TRUE(IONAME(SetStatus)(io, "SCRATCH", 7)) << "SetStatus(SCRATCH)";
+
+  int unit{-1};
+  ASSERT_TRUE(IONAME(GetNewUnit)(io, unit)) << "GetNewUnit()";
+  ASSERT_EQ(IONAME(EndIoStatement)(io), IostatOk)
+      << "EndIoStatement() for OpenNewUnit";
+
+  static const int records{4};
+  for (int j{0}; j < records; ++j) {
+    // WRITE(UNIT=unit,FMT=*) j, 0.5*j, j>1, 'abc'
+    io = IONAME(BeginExternalListOutput)(unit, __FILE__, __LINE__);
+    ASSERT_TRUE(IONAME(OutputInteger64)(io, j)) << "OutputInteger64()";
+    ASSERT_TRUE(IONAME(OutputReal64)(io, 0.5 * j)) << "OutputReal64()";
+    ASSERT_TRUE(IONAME(OutputLogical)(io, j > 1)) << "OutputLogical()";
+    ASSERT_TRUE(IONAME(OutputAscii)(io, "abc", 3)) << "OutputAscii()";
+    ASSERT_EQ(IONAME(EndIoStatement)(io), IostatOk)
+        << "EndIoStatement() for list-directed output";
+  }
+
+  // REWIND(UNIT=unit)
+  io = IONAME(BeginRewind)(unit, __FILE__, __LINE__);
+  ASSERT_EQ(IONAME(EndIoStatement)(io), IostatOk)
+      << "EndIoStatement() for Rewind";
+
+  for (int j{0}; j < records; ++j) {
+    // READ(UNIT=unit,FMT=*) n, x, l
+    io = IONAME(BeginExternalListInput)(unit, __FILE__, __LINE__);
+    std::int64_t n{-1};
+    double x{-1.0};
+    bool l{j <= 1};
+    ASSERT_TRUE(IONAME(InputInteger)(io, n)) << "InputInteger()";
+    ASSERT_TRUE(IONAME(InputReal64)(io, x)) << "InputReal64()";
+    ASSERT_TRUE(IONAME(InputLogical)(io, l)) << "InputLogical()";
+    ASSERT_EQ(IONAME(EndIoStatement)(io), IostatOk)
+        << "EndIoStatement() for list-directed input";
+    ASSERT_EQ(n, j) << "Read back integer " << n << " from record " << j;
+    ASSERT_EQ(x, 0.5 * j) << "Read back real " << x << " from record " << j;
+    ASSERT_EQ(l, j > 1) << "Read back logical " << l << " from record " << j;
+  }
+
+  // REWIND(UNIT=unit)
+  io = IONAME(BeginRewind)(unit, __FILE__, __LINE__);
+  ASSERT_EQ(IONAME(EndIoStatement)(io), IostatOk)
+      << "EndIoStatement() for Rewind";
+
+  // READ(UNIT=unit,FMT='(A)') line
+  // List-directed output begins each record with a blank.
+  char line[8];
+  io = IONAME(BeginExternalFormattedInput)("(A)", 3, unit, __FILE__, __LINE__);
+  ASSERT_TRUE(IONAME(InputAscii)(io, line, sizeof line)) << "InputAscii()";
+  ASSERT_EQ(IONAME(EndIoStatement)(io), IostatOk)
+      << "EndIoStatement() for formatted input";
+  ASSERT_EQ(std::string_view(line, 3), " 0 ")
+      << "Read back '" << std::string_view(line, sizeof line)
+      << "' from list-directed record 0";
+
+  // CLOSE(UNIT=unit,STATUS='DELETE')
+  io = IONAME(BeginClose)(unit, __FILE__, __LINE__);
+  ASSERT_TRUE(IONAME(SetStatus)(io, "DELETE", 6)) << "SetStatus(DELETE)";
+  ASSERT_EQ(IONAME(EndIoStatement)(io), IostatOk)
+      << "EndIoStatement() for Close";
+}
@@ -110,6 +110,9 @@ TEST(FormatTests, FormatStringTraversal) {
       {2, "(*('PI=',F9.7,:),'tooFar')",
           ResultsTy{"'PI='", "F9.7", "'PI='", "F9.7"}, 1},
       {1, "(3F9.7)", ResultsTy{"2*F9.7"}, 2},
+      {1, "(3I5)", ResultsTy{"3*I5"}, 5},
+      {3, "(3I5)", ResultsTy{"2*I5", "I5", "/", "2*I5"}, 2},
+      {2, "(3I5,'x')", ResultsTy{"3*I5", "'x'", "/", "3*I5", "'x'"}, 7},
   };
 
   for (const auto &[n, format, expect, repeat] : params) {
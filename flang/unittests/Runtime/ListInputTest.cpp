@@ -10,6 +10,7 @@
 #include "../../runtime/io-error.h"
 #include "flang/Runtime/descriptor.h"
 #include "flang/Runtime/io-api.h"
+#include <cmath>
 
 using namespace Fortran::runtime;
 using namespace Fortran::runtime::io;
@@ -151,6 +152,75 @@ TEST(InputTest, TestListInputInvalidFormat) {
       "Bad character 'g' in INTEGER input field");
 }
 
+TEST(InputTest, TestListInputSeparators) {
+  // Values end at blanks, tabs, commas and slashes; a slash ends the input
+  // and leaves the remaining items unchanged.
+  std::string formatBuffer{"1,2\t3  ,-4 +5/6"};
+  auto *cookie{IONAME(BeginInternalListInput)(
+      formatBuffer.data(), formatBuffer.size())};
+  constexpr int listInputLength{6};
+  std::int64_t actualOutput[listInputLength]{0, 0, 0, 0, 0, -6};
+  const std::int64_t expectedOutput[listInputLength]{1, 2, 3, -4, 5, -6};
+  for (int j{0}; j < listInputLength; ++j) {
+    IONAME(InputInteger)(cookie, actualOutput[j]);
+  }
+  const auto status{IONAME(EndIoStatement)(cookie)};
+  ASSERT_EQ(status, 0) << "list-directed input failed, status "
+                       << static_cast<int>(status) << '\n';
+  for (int j{0}; j < listInputLength; ++j) {
+    EXPECT_EQ(actualOutput[j], expectedOutput[j])
+        << "wanted actualOutput[" << j << "]==" << expectedOutput[j] << ", got "
+        << actualOutput[j] << '\n';
+  }
+}
+
+TEST(InputTest, TestListInputRealRepeatAndNull) {
+  // Repeat counts, null values, and values that the single-pass scan of the
+  // record scans along with the values it leaves to the general scanner,
+  // such as NaN and Inf.
+  std::string formatBuffer{"3*1.5,,2*,-.25D1 NaN,-Inf, "
+                           "1234567890.1234567890123456789e-10 5E-1"};
+  auto *cookie{IONAME(BeginInternalListInput)(
+      formatBuffer.data(), formatBuffer.size())};
+  constexpr int listInputLength{11};
+  double actualOutput[listInputLength];
+  for (int j{0}; j < listInputLength; ++j) {
+    actualOutput[j] = -j;
+  }
+  for (int j{0}; j < listInputLength; ++j) {
+    IONAME(InputReal64)(cookie, actualOutput[j]);
+  }
+  const auto status{IONAME(EndIoStatement)(cookie)};
+  ASSERT_EQ(status, 0) << "list-directed input failed, status "
+                       << static_cast<int>(status) << '\n';
+  const double expectedOutput[]{1.5, 1.5, 1.5, -3, -4, -5, -2.5};
+  for (int j{0}; j < 7; ++j) {
+    EXPECT_EQ(actualOutput[j], expectedOutput[j])
+        << "wanted actualOutput[" << j << "]==" << expectedOutput[j] << ", got "
+        << actualOutput[j] << '\n';
+  }
+  EXPECT_TRUE(std::isnan(actualOutput[7]));
+  EXPECT_TRUE(std::isinf(actualOutput[8]) && actualOutput[8] < 0);
+  EXPECT_DOUBLE_EQ(actualOutput[9], 0.12345678901234567890123456789);
+  EXPECT_EQ(actualOutput[10], 0.5);
+}
+
+TEST(InputTest, TestListInputIntegerFallback) {
+  // An INTEGER value with more than 19 digits is scanned by the general
+  // scanner, as are values followed by an unexpected character.
+  std::string formatBuffer{"00000000000000000000000042 -9223372036854775807"};
+  auto *cookie{IONAME(BeginInternalListInput)(
+      formatBuffer.data(), formatBuffer.size())};
+  std::int64_t first{0}, second{0};
+  IONAME(InputInteger)(cookie, first);
+  IONAME(InputInteger)(cookie, second);
+  const auto status{IONAME(EndIoStatement)(cookie)};
+  ASSERT_EQ(status, 0) << "list-directed input failed, status "
+                       << static_cast<int>(status) << '\n';
+  EXPECT_EQ(first, 42);
+  EXPECT_EQ(second, -9223372036854775807);
+}
+
 using ParamTy = std::tuple<std::string, std::vector<int>>;
 
 struct SimpleListInputTest : testing::TestWithParam<ParamTy> {};
@@ -190,4 +260,5 @@ INSTANTIATE_TEST_SUITE_P(SimpleListInputTestInstantiation, SimpleListInputTest,
         std::make_tuple("0", std::vector<int>{}),
         std::make_tuple("1", std::vector<int>{1}),
         std::make_tuple("1, 2", std::vector<int>{1, 2}),
-        std::make_tuple("3*2", std::vector<int>{2, 2, 2})));
+        std::make_tuple("3*2", std::vector<int>{2, 2, 2}),
+        std::make_tuple("2*7 , 3", std::vector<int>{7, 7, 3})));
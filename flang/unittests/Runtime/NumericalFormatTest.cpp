@@ -188,6 +188,53 @@ TEST(IOApiTests, ListInputTest) {
       << "', but got '" << output << "'";
 }
 
+TEST(IOApiTests, InternalRoundTripTest) {
+  // Values written to an internal unit with a format and list-directed are
+  // read back from it the same way.
+  static constexpr int numValues{3};
+  const std::int64_t ints[numValues]{-12, 0, 345};
+  const double reals[numValues]{-1.5, 0.25, 8.0};
+  static const char *formats[]{"(3I6,3F8.3)", nullptr}; // null: list I/O
+  char buffer[48];
+
+  for (const char *format : formats) {
+    auto cookie{format
+            ? IONAME(BeginInternalFormattedOutput)(
+                  buffer, sizeof buffer, format, std::strlen(format))
+            : IONAME(BeginInternalListOutput)(buffer, sizeof buffer)};
+    for (auto n : ints) {
+      ASSERT_TRUE(IONAME(OutputInteger64)(cookie, n)) << "OutputInteger64()";
+    }
+    for (auto x : reals) {
+      ASSERT_TRUE(IONAME(OutputReal64)(cookie, x)) << "OutputReal64()";
+    }
+    ASSERT_EQ(IONAME(EndIoStatement)(cookie), IostatOk)
+        << "EndIoStatement() for output with format "
+        << (format ? format : "*");
+
+    cookie = format ? IONAME(BeginInternalFormattedInput)(
+                          buffer, sizeof buffer, format, std::strlen(format))
+                    : IONAME(BeginInternalListInput)(buffer, sizeof buffer);
+    std::int64_t n[numValues];
+    double x[numValues];
+    for (auto &v : n) {
+      ASSERT_TRUE(IONAME(InputInteger)(cookie, v)) << "InputInteger()";
+    }
+    for (auto &v : x) {
+      ASSERT_TRUE(IONAME(InputReal64)(cookie, v)) << "InputReal64()";
+    }
+    ASSERT_EQ(IONAME(EndIoStatement)(cookie), IostatOk)
+        << "EndIoStatement() for input with format "
+        << (format ? format : "*");
+    for (int j{0}; j < numValues; ++j) {
+      ASSERT_EQ(n[j], ints[j]) << "Read back integer " << n[j] << " from '"
+                               << std::string{buffer, sizeof buffer} << "'";
+      ASSERT_EQ(x[j], reals[j]) << "Read back real " << x[j] << " from '"
+                                << std::string{buffer, sizeof buffer} << "'";
+    }
+  }
+}
+
 TEST(IOApiTests, DescriptorOutputTest) {
   static constexpr int bufferSize{10};
   char buffer[bufferSize];
@@ -242,6 +289,61 @@ TEST(IOApiTests, DescriptorOutputTest) {
       << std::string{buffer, sizeof buffer} << "'";
 }
 
+TEST(IOApiTests, StagedArrayOutputTest) {
+  // A repeated edit descriptor covers several elements of an array, and
+  // format reversion moves the rest of the array to the next records.
+  static constexpr int numLines{3};
+  static constexpr int lineLength{15};
+  char buffer[numLines][lineLength];
+  StaticDescriptor<1> wholeStaticDescriptor;
+  Descriptor &whole{wholeStaticDescriptor.descriptor()};
+  static const SubscriptValue lines[]{numLines};
+  whole.Establish(TypeCode{CFI_type_char}, /*elementBytes=*/lineLength,
+      &buffer, 1, lines, CFI_attribute_pointer);
+  const char *format{"(3I5)"};
+  auto cookie{IONAME(BeginInternalArrayFormattedOutput)(
+      whole, format, std::strlen(format))};
+
+  static constexpr int numElements{7};
+  std::int32_t data[numElements]{1, 22, 333, 4444, -5, 66, 7};
+  StaticDescriptor<1> staticDescriptor;
+  Descriptor &desc{staticDescriptor.descriptor()};
+  static const SubscriptValue extent[]{numElements};
+  desc.Establish(TypeCode{CFI_type_int32_t}, sizeof data[0], &data, 1, extent);
+  ASSERT_TRUE(IONAME(OutputDescriptor)(cookie, desc));
+  auto status{IONAME(EndIoStatement)(cookie)};
+  ASSERT_EQ(status, 0) << "staged array output failed, status "
+                       << static_cast<int>(status);
+
+  static const std::string expect{"    1   22  333"
+                                  " 4444   -5   66"
+                                  "    7          "};
+  EXPECT_TRUE(
+      CompareFormattedStrings(expect, std::string{buffer[0], sizeof buffer}))
+      << "Expected '" << expect << "' but got '"
+      << std::string{buffer[0], sizeof buffer} << "'";
+}
+
+TEST(IOApiTests, StagedArrayOutputOverrunTest) {
+  // The edits of a run that does not fit in the record are staged; the
+  // overrun is reported when they are emitted and the statement fails.
+  char buffer[12];
+  const char *format{"(4I5)"};
+  auto cookie{IONAME(BeginInternalFormattedOutput)(
+      buffer, sizeof buffer, format, std::strlen(format))};
+  IONAME(EnableHandlers)(cookie, /*hasIoStat=*/true);
+
+  std::int32_t data[4]{1, 2, 3, 4};
+  StaticDescriptor<1> staticDescriptor;
+  Descriptor &desc{staticDescriptor.descriptor()};
+  static const SubscriptValue extent[]{4};
+  desc.Establish(TypeCode{CFI_type_int32_t}, sizeof data[0], &data, 1, extent);
+  EXPECT_FALSE(IONAME(OutputDescriptor)(cookie, desc));
+  auto status{IONAME(EndIoStatement)(cookie)};
+  EXPECT_EQ(status, IostatRecordWriteOverrun)
+      << "staged array output overrun, status " << static_cast<int>(status);
+}
+
 //------------------------------------------------------------------------------
 /// Tests for output formatting real values
 //------------------------------------------------------------------------------
@@ -119,6 +119,14 @@ public:
   LoopOptionsAttrBuilder &
   setPipelineInitiationInterval(Optional<uint64_t> count);
 
+  /// Set the `vectorize_enable` option to the provided value. If no value
+  /// is provided the option is deleted.
+  LoopOptionsAttrBuilder &setVectorizeEnable(Optional<bool> value);
+
+  /// Set the `vectorize_width` option to the provided value. If no value
+  /// is provided the option is deleted.
+  LoopOptionsAttrBuilder &setVectorizeWidth(Optional<uint64_t> width);
+
   /// Returns true if any option has been set.
   bool empty() { return options.empty(); }
 
@@ -2477,6 +2477,20 @@ LoopOptionsAttrBuilder &LoopOptionsAttrBuilder::setPipelineInitiationInterval(
   return setOption(LoopOptionCase::pipeline_initiation_interval, count);
 }
 
+/// Set the `vectorize_enable` option to the provided value. If no value
+/// is provided the option is deleted.
+LoopOptionsAttrBuilder &
+LoopOptionsAttrBuilder::setVectorizeEnable(Optional<bool> value) {
+  return setOption(LoopOptionCase::vectorize_enable, value);
+}
+
+/// Set the `vectorize_width` option to the provided value. If no value
+/// is provided the option is deleted.
+LoopOptionsAttrBuilder &
+LoopOptionsAttrBuilder::setVectorizeWidth(Optional<uint64_t> width) {
+  return setOption(LoopOptionCase::vectorize_width, width);
+}
+
 template <typename T>
 static Optional<T>
 getOption(ArrayRef<std::pair<LoopOptionCase, int64_t>> options,
@@ -2526,10 +2540,12 @@ void LoopOptionsAttr::print(DialectAsmPrinter &printer) const {
     case LoopOptionCase::disable_licm:
     case LoopOptionCase::disable_unroll:
     case LoopOptionCase::disable_pipeline:
+    case LoopOptionCase::vectorize_enable:
       printer << (option.second ? "true" : "false");
       break;
     case LoopOptionCase::interleave_count:
     case LoopOptionCase::pipeline_initiation_interval:
+    case LoopOptionCase::vectorize_width:
       printer << option.second;
       break;
     }
@@ -2566,6 +2582,7 @@ Attribute LoopOptionsAttr::parse(DialectAsmParser &parser, Type type) {
     case LoopOptionCase::disable_licm:
     case LoopOptionCase::disable_unroll:
     case LoopOptionCase::disable_pipeline:
+    case LoopOptionCase::vectorize_enable:
       if (succeeded(parser.parseOptionalKeyword("true")))
         value = 1;
       else if (succeeded(parser.parseOptionalKeyword("false")))
@@ -2578,6 +2595,7 @@ Attribute LoopOptionsAttr::parse(DialectAsmParser &parser, Type type) {
       break;
     case LoopOptionCase::interleave_count:
     case LoopOptionCase::pipeline_initiation_interval:
+    case LoopOptionCase::vectorize_width:
       if (failed(parser.parseInteger(value))) {
         parser.emitError(parser.getNameLoc(), "expected integer value");
         return {};
@@ -880,8 +880,10 @@ void WsLoopOp::build(OpBuilder &builder, OperationState &result,
   result.addOperands(steps);
   result.addOperands(privateVars);
   result.addOperands(firstprivateVars);
+  result.addOperands(lastprivateVars);
   result.addOperands(linearVars);
   result.addOperands(linearStepVars);
+  result.addOperands(reductionVars);
   if (scheduleChunkVar)
     result.addOperands(scheduleChunkVar);
 
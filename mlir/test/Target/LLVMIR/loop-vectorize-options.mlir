@@ -0,0 +1,52 @@
+// RUN: mlir-opt %s | mlir-opt | FileCheck %s --check-prefix=ROUNDTRIP
+// RUN: mlir-translate -mlir-to-llvmir %s | FileCheck %s
+
+// ROUNDTRIP-LABEL: llvm.func @simdLoop
+// CHECK-LABEL: define void @simdLoop
+llvm.func @simdLoop(%arg0: !llvm.ptr<f32>, %arg1: i64) {
+  %0 = llvm.mlir.constant(0 : i64) : i64
+  %1 = llvm.mlir.constant(1 : i64) : i64
+  llvm.br ^bb1(%0 : i64)
+^bb1(%2: i64):
+  %3 = llvm.icmp "slt" %2, %arg1 : i64
+  llvm.cond_br %3, ^bb2, ^bb3
+^bb2:
+  %4 = llvm.getelementptr %arg0[%2] : (!llvm.ptr<f32>, i64) -> !llvm.ptr<f32>
+  // ROUNDTRIP: llvm.load %{{.*}} {access_groups = [@metadata::@group1]}
+  // CHECK: load float, float* %{{.*}}, align 4, !llvm.access.group ![[GROUP:[0-9]+]]
+  %5 = llvm.load %4 {access_groups = [@metadata::@group1]} : !llvm.ptr<f32>
+  %6 = llvm.fadd %5, %5 : f32
+  // ROUNDTRIP: llvm.store %{{.*}}, %{{.*}} {access_groups = [@metadata::@group1]}
+  // CHECK: store float %{{.*}}, float* %{{.*}}, align 4, !llvm.access.group ![[GROUP]]
+  llvm.store %6, %4 {access_groups = [@metadata::@group1]} : !llvm.ptr<f32>
+  %7 = llvm.add %2, %1 : i64
+  // ROUNDTRIP: llvm.br ^{{.*}}(%{{.*}} : i64) {llvm.loop = {options = #llvm.loopopts<vectorize_enable = true, vectorize_width = 8>, parallel_access = [@metadata::@group1]}}
+  // CHECK: br label %{{.*}}, !llvm.loop ![[LOOP:[0-9]+]]
+  llvm.br ^bb1(%7 : i64) {llvm.loop = {parallel_access = [@metadata::@group1], options = #llvm.loopopts<vectorize_width = 8, vectorize_enable = true>}}
+^bb3:
+  llvm.return
+}
+
+// The options are printed in a canonical order.
+// ROUNDTRIP-LABEL: llvm.func @disabledVectorization
+// ROUNDTRIP: llvm.br ^{{.*}} {llvm.loop = {options = #llvm.loopopts<disable_unroll = true, vectorize_enable = false>}}
+// CHECK-LABEL: define void @disabledVectorization
+// CHECK: br label %{{.*}}, !llvm.loop ![[DISABLED:[0-9]+]]
+llvm.func @disabledVectorization() {
+  llvm.br ^bb1
+^bb1:
+  llvm.br ^bb1 {llvm.loop = {options = #llvm.loopopts<vectorize_enable = false, disable_unroll = true>}}
+}
+
+llvm.metadata @metadata {
+  llvm.access_group @group1
+  llvm.return
+}
+
+// CHECK: ![[LOOP]] = distinct !{![[LOOP]], ![[PA:[0-9]+]], ![[ENABLE:[0-9]+]], ![[WIDTH:[0-9]+]]}
+// CHECK: ![[PA]] = !{!"llvm.loop.parallel_accesses", ![[GROUP]]}
+// CHECK: ![[ENABLE]] = !{!"llvm.loop.vectorize.enable", i1 true}
+// CHECK: ![[WIDTH]] = !{!"llvm.loop.vectorize.width", i32 8}
+// CHECK: ![[DISABLED]] = distinct !{![[DISABLED]], ![[UNROLL:[0-9]+]], ![[NOVEC:[0-9]+]]}
+// CHECK: ![[UNROLL]] = !{!"llvm.loop.unroll.disable", i1 true}
+// CHECK: ![[NOVEC]] = !{!"llvm.loop.vectorize.enable", i1 false}